@@ -11,8 +11,26 @@
 extern "C" {
 #endif
 
+/*
+ * Thread safety: everything a handle gets from parsing is immutable once orbisElfParse* returns, so getters, find functions
+ * and relocation queries may be called from any number of threads without locks. orbisElfImportModule and
+ * orbisElfSetImportSymbol only change the per-handle symbol bindings; one thread at a time may call them while other
+ * threads query, orbisElfGetSymbolBinding and relocation values always see a consistent binding.
+ * orbisElfLoad and orbisElfDestroy require exclusive access, orbisElfDestroy also to the modules the handle imports from.
+ * Stats are not synchronized.
+ */
 OrbisElfErrorCode_t orbisElfValidate(const void *image, size_t imageSize, OrbisElfType_t expectedType);
 OrbisElfErrorCode_t orbisElfParse(OrbisElfHandle_t *handle, OrbisElfReadCallback_t readImageCallback, size_t imageSize, void *readImageUserData);
+OrbisElfErrorCode_t orbisElfParseWithOptions(OrbisElfHandle_t *handle, OrbisElfReadCallback_t readImageCallback, size_t imageSize, void *readImageUserData, const OrbisElfParseOptions_t *options);
+/*
+ * Two-phase parsing: orbisElfQueryParseSize reports how many bytes orbisElfParseInPlace needs for the same image and options,
+ * an upper bound read from the headers and the dynamic table without parsing or allocating. orbisElfParseInPlace then places
+ * the handle and all parse storage into memory (16 byte aligned) without touching the heap.
+ * Storage allocated later (lazy indexes, clones) comes from options->allocator, or malloc without one, never from memory.
+ * orbisElfDestroy must still be called, memory can be reused once the handle is freed (see orbisElfSetUnloadCallback).
+ */
+OrbisElfErrorCode_t orbisElfQueryParseSize(OrbisElfReadCallback_t readImageCallback, size_t imageSize, void *readImageUserData, const OrbisElfParseOptions_t *options, uint64_t *size);
+OrbisElfErrorCode_t orbisElfParseInPlace(OrbisElfHandle_t *handle, void *memory, uint64_t memorySize, OrbisElfReadCallback_t readImageCallback, size_t imageSize, void *readImageUserData, const OrbisElfParseOptions_t *options);
 OrbisElfErrorCode_t orbisElfLoad(OrbisElfHandle_t elf, void *baseAddress, uint64_t virtualBaseAddress);
 
 OrbisElfErrorCode_t orbisElfImportModule(OrbisElfHandle_t elf, OrbisElfHandle_t importElf);
@@ -20,6 +38,32 @@ OrbisElfErrorCode_t orbisElfSetImportSymbol(OrbisElfHandle_t elf, const char *mo
 
 void orbisElfDestroy(OrbisElfHandle_t elf);
 
+/*
+ * New handle sharing everything parsed with elf by reference count, only bindings and dependency links are allocated, so
+ * several processes can load one parsed module. The clone starts unresolved and unloaded, it reads segments at orbisElfLoad
+ * through the original read callback (see orbisElfSetReadCallback) and keeps the parse options. Handles are destroyed
+ * independently, the image goes with the last one, memory of orbisElfParseInPlace must stay valid until then. Any thread may
+ * clone, the allocator must be thread safe.
+ */
+OrbisElfErrorCode_t orbisElfClone(OrbisElfHandle_t elf, OrbisElfHandle_t *clone);
+void orbisElfSetReadCallback(OrbisElfHandle_t elf, OrbisElfReadCallback_t readImageCallback, void *readImageUserData); /* source for later reads, same image content */
+
+/*
+ * Dependency tracking: orbisElfImportModule links the importer to the module its symbols were bound into, and a module stays
+ * allocated while any importer is linked to it, orbisElfDestroy only drops the caller's reference. orbisElfReplaceModule
+ * rebinds the importers' symbols bound into elf to the same named newElf, orbisElfUnloadModule resets them to unresolved
+ * and destroys elf, both patch only the relocation sites of those symbols. Both return orbisElfErrorCodeInvalidValue and change
+ * nothing when a loaded importer has TLS relocations against symbols of elf, their module index and offset are only written by
+ * orbisElfTlsApply. The unload callback is called right before the handle is freed, so the module memory can be released there.
+ * These functions require exclusive access to all linked handles.
+ */
+void orbisElfSetUnloadCallback(OrbisElfHandle_t elf, OrbisElfUnloadCallback_t unloadCallback, void *unloadUserData);
+OrbisElfErrorCode_t orbisElfReplaceModule(OrbisElfHandle_t elf, OrbisElfHandle_t newElf); /* orbisElfErrorCodeNotFound when newElf lacks some bound symbols */
+OrbisElfErrorCode_t orbisElfUnloadModule(OrbisElfHandle_t elf);
+uint64_t orbisElfGetImportersCount(OrbisElfHandle_t elf);
+OrbisElfHandle_t orbisElfGetImporter(OrbisElfHandle_t elf, uint64_t index);
+OrbisElfHandle_t orbisElfGetDependency(OrbisElfHandle_t elf, uint64_t importModuleIndex); /* NULL while nothing is imported from it */
+
 const OrbisElfHeader_t *orbisElfGetHeader(OrbisElfHandle_t elf);
 OrbisElfType_t orbisElfGetType(OrbisElfHandle_t elf);
 const OrbisElfModuleInfo_t *orbisElfGetModuleInfo(OrbisElfHandle_t elf);
@@ -36,6 +80,10 @@ uint64_t orbisElfGetVirtualBaseAddress(OrbisElfHandle_t elf);
 void *orbisElfGetBaseAddress(OrbisElfHandle_t elf);
 
 uint16_t orbisElfGetProgramsCount(OrbisElfHandle_t elf);
+/*
+ * Section headers and names are read on the first section query, by the querying thread through the read callback, which must then
+ * be reentrant and valid as long as the handle. orbisElfParseFlagEagerIndexes reads them while parsing instead.
+ */
 uint16_t orbisElfGetSectionsCount(OrbisElfHandle_t elf);
 uint64_t orbisElfGetImportModulesCount(OrbisElfHandle_t elf);
 uint64_t orbisElfGetImportLibrariesCount(OrbisElfHandle_t elf);
@@ -44,6 +92,9 @@ uint64_t orbisElfGetSymbolsCount(OrbisElfHandle_t elf);
 uint64_t orbisElfGetInitAddress(OrbisElfHandle_t elf);
 uint64_t orbisElfGetPreinitArray(OrbisElfHandle_t elf, uint64_t *count);
 uint64_t orbisElfGetInitArray(OrbisElfHandle_t elf, uint64_t *count);
+uint64_t orbisElfGetFiniAddress(OrbisElfHandle_t elf);
+uint64_t orbisElfGetFiniArray(OrbisElfHandle_t elf, uint64_t *count);
+const char **orbisElfGetNeeded(OrbisElfHandle_t elf, uint64_t *count);
 
 const OrbisElfProgramHeader_t *orbisElfGetProgram(OrbisElfHandle_t elf, uint16_t index);
 const OrbisElfSectionHeader_t *orbisElfGetSection(OrbisElfHandle_t elf, uint16_t index);
@@ -51,8 +102,11 @@ const OrbisElfModuleInfo_t *orbisElfGetImportModuleInfo(OrbisElfHandle_t elf, ui
 const OrbisElfLibraryInfo_t *orbisElfGetImportLibraryInfo(OrbisElfHandle_t elf, uint64_t index);
 const OrbisElfLibraryInfo_t *orbisElfGetExportLibraryInfo(OrbisElfHandle_t elf, uint64_t index);
 const OrbisElfSymbol_t *orbisElfGetSymbol(OrbisElfHandle_t elf, uint64_t index);
+OrbisElfErrorCode_t orbisElfGetSymbolBinding(OrbisElfHandle_t elf, uint64_t index, OrbisElfSymbolBinding_t *binding); /* resolved value, header.value is the parsed one */
 
 const OrbisElfSymbol_t *orbisElfFindSymbolByName(OrbisElfHandle_t elf, const char *name);
+/* defined symbol containing the virtual address, or the closest one below it when it has no size, the index is built on first call */
+const OrbisElfSymbol_t *orbisElfFindSymbolByAddress(OrbisElfHandle_t elf, uint64_t address, uint64_t *offset);
 const OrbisElfSectionHeader_t *orbisElfFindSectionByName(OrbisElfHandle_t elf, const char *name);
 const OrbisElfModuleInfo_t *orbisElfFindModuleById(OrbisElfHandle_t elf, uint16_t id);
 const OrbisElfLibraryInfo_t *orbisElfFindLibraryById(OrbisElfHandle_t elf, uint16_t id);
@@ -62,6 +116,22 @@ const char *orbisElfSectionGetName(const OrbisElfSectionHeader_t *section);
 uint64_t orbisElfGetRebaseRelocationsCount(OrbisElfHandle_t elf);
 OrbisElfRebaseRelocation_t *orbisElfGetRebaseRelocation(OrbisElfHandle_t elf, uint64_t index);
 
+/*
+ * Writes the image with every rebase site already holding its value at preferredBase, followed by the list of site offsets.
+ * orbisElfErrorCodeInvalidValue when a site isn't file data of a loadable segment. Handles parsed from such an image report the base
+ * through orbisElfGetPrelinkBase, orbisElfRelocateRebases then does nothing when loaded there and only adds the delta elsewhere.
+ */
+OrbisElfErrorCode_t orbisElfPrelink(OrbisElfHandle_t elf, uint64_t preferredBase, OrbisElfWriteCallback_t writeCallback, void *writeUserData);
+uint64_t orbisElfGetPrelinkBase(OrbisElfHandle_t elf, int *isPrelinked);
+OrbisElfErrorCode_t orbisElfRelocateRebases(OrbisElfHandle_t elf); /* after orbisElfLoad, at its virtual base address */
+
+/*
+ * Applies only the rebase and import relocations starting in one page of the loaded image, for hosts relocating pages on
+ * first touch (userfaultfd, mprotect and SIGSEGV). pageSize is a power of two, at least 4096. A relocation crossing the page
+ * end is written with the page it starts in, and add slots must see each page once. The page index is built on first call.
+ */
+OrbisElfErrorCode_t orbisElfRelocatePage(OrbisElfHandle_t elf, uint64_t pageSize, uint64_t pageIndex);
+
 uint64_t orbisElfGetImportRelocationsCount(OrbisElfHandle_t elf);
 OrbisElfRelocation_t *orbisElfGetImportRelocation(OrbisElfHandle_t elf, uint64_t index);
 
@@ -73,11 +143,191 @@ uint64_t orbisElfGetImportRelocationValue(OrbisElfHandle_t elf, OrbisElfRelocati
 uint64_t orbisElfGetRelocationOffset(OrbisElfRelocation_t *rel);
 uint64_t orbisElfGetTlsRelocationValue(OrbisElfHandle_t elf, OrbisElfRelocation_t *rel, uint64_t index, uint64_t offset);
 OrbisElfRelocationInjectType_t orbisElfGetRelocationInjectType(OrbisElfRelocation_t *rel);
+/* stores value into the slot at address (unaligned), add slots add it to what they hold */
+void orbisElfWriteRelocation(void *address, uint8_t size, OrbisElfRelocationInjectType_t injectType, uint64_t value);
+
+/* indexes into import or TLS relocations that reference the symbol, the index is built on first call */
+const uint32_t *orbisElfGetSymbolImportRelocations(OrbisElfHandle_t elf, uint64_t symbolIndex, uint64_t *count);
+const uint32_t *orbisElfGetSymbolTlsRelocations(OrbisElfHandle_t elf, uint64_t symbolIndex, uint64_t *count);
+
+/*
+ * Changes the symbol binding and patches every slot that references it in the loaded image. The symbol is then bound by
+ * address, orbisElfReplaceModule and orbisElfUnloadModule leave it alone. A symbol with TLS relocations in a loaded image that is
+ * bound into a module gives orbisElfErrorCodeInvalidValue, its slots hold the module index and offset of orbisElfTlsApply.
+ */
+OrbisElfErrorCode_t orbisElfRebindSymbol(OrbisElfHandle_t elf, uint64_t symbolIndex, uint64_t virtualBaseAddress, uint64_t value, uint64_t size);
+
+/*
+ * Unwind info of the function containing pc, a virtual address of the loaded module. The search table comes from the PT_GNU_EH_FRAME
+ * .eh_frame_hdr when it is sorted and in bounds and is built from .eh_frame otherwise, on the first call. orbisElfErrorCodeNotFound
+ * when pc isn't covered or the module has no PT_GNU_EH_FRAME, orbisElfErrorCodeInvalidValue before orbisElfLoad.
+ */
+OrbisElfErrorCode_t orbisElfFindFde(OrbisElfHandle_t elf, uint64_t pc, OrbisElfFde_t *fde);
 
 const OrbisElfDynamic_t *orbisElfGetDynamics(OrbisElfHandle_t elf, uint64_t *count);
 
 uint64_t orbisElfRead(OrbisElfHandle_t elf, uint64_t offset, void *destination, uint64_t size);
 
+/*
+ * Parse tables of a handle parsed with orbisElfParseFlagValidate, orbisElfErrorCodeInvalidValue otherwise. Validation bounds checks
+ * every table, string, symbol index and relocation target once, so the unchecked accessors below are safe on hot paths.
+ */
+OrbisElfErrorCode_t orbisElfGetTables(OrbisElfHandle_t elf, OrbisElfTables_t *tables);
+
+static inline const OrbisElfSymbol_t *orbisElfTablesGetSymbol(const OrbisElfTables_t *tables, uint64_t index)
+{
+	return tables->symbols + index;
+}
+
+static inline const OrbisElfRebaseRelocation_t *orbisElfTablesGetRebaseRelocation(const OrbisElfTables_t *tables, uint64_t index)
+{
+	return tables->rebaseRelocations + index;
+}
+
+static inline const OrbisElfRelocation_t *orbisElfTablesGetImportRelocation(const OrbisElfTables_t *tables, uint64_t index)
+{
+	return tables->importRelocations + index;
+}
+
+static inline const OrbisElfRelocation_t *orbisElfTablesGetTlsRelocation(const OrbisElfTables_t *tables, uint64_t index)
+{
+	return tables->tlsRelocations + index;
+}
+
+static inline const OrbisElfSymbol_t *orbisElfTablesGetRelocationSymbol(const OrbisElfTables_t *tables, const OrbisElfRelocation_t *rel)
+{
+	return tables->symbols + rel->symbolIndex;
+}
+
+/*
+ * x86-64 variant II static TLS: orbisElfTlsPlan places the TLS blocks of count handles below the thread pointer, elfs[0] (the
+ * executable) first, and returns the static TLS size and the thread pointer alignment. orbisElfTlsApply then writes every TLS
+ * relocation of the loaded handles with the index and offset of the handle the symbol is bound into (OrbisElfSymbolBinding_t
+ * module), once, after imports are resolved.
+ */
+OrbisElfErrorCode_t orbisElfTlsPlan(const OrbisElfHandle_t *elfs, uint64_t count, OrbisElfTlsModule_t *modules, uint64_t *staticSize, uint64_t *staticAlign);
+OrbisElfErrorCode_t orbisElfTlsApply(const OrbisElfTlsModule_t *modules, uint64_t count); /* orbisElfErrorCodeNotFound when a symbol is bound outside the plan or by address */
+
+/*
+ * Fills staticSize bytes of templateMemory with every planned module's TLS init data and zeroed tail, laid out as planned.
+ * A new thread's static TLS is then memcpy(threadPointer - staticSize, templateMemory, staticSize).
+ */
+OrbisElfErrorCode_t orbisElfTlsBuildTemplate(const OrbisElfTlsModule_t *modules, uint64_t count, void *templateMemory, uint64_t staticSize);
+
+/*
+ * One table of 16 byte x86-64 thunks for the unresolved function imports of the added modules that are called through jump
+ * slots, one per module, library and symbol name. Thunk i is "mov eax, i; jmp [slot i]", slots start as dispatcherAddress and
+ * can be pointed at HLE functions one by one. orbisElfStubTableBuild fills orbisElfStubTableGetSize bytes of page aligned
+ * memory, code pages first and slots after them, and rebinds the imports by address to the absolute thunk addresses. Add
+ * modules once their imports are resolved, the added handles must outlive the table.
+ */
+OrbisElfErrorCode_t orbisElfStubTableCreate(OrbisElfStubTableHandle_t *table);
+OrbisElfErrorCode_t orbisElfStubTableAddModule(OrbisElfStubTableHandle_t table, OrbisElfHandle_t elf);
+uint64_t orbisElfStubTableGetSize(OrbisElfStubTableHandle_t table); /* page aligned */
+OrbisElfErrorCode_t orbisElfStubTableBuild(OrbisElfStubTableHandle_t table, void *memory, uint64_t virtualAddress, uint64_t dispatcherAddress);
+uint64_t orbisElfStubTableGetStubsCount(OrbisElfStubTableHandle_t table);
+const OrbisElfStub_t *orbisElfStubTableGetStub(OrbisElfStubTableHandle_t table, uint64_t index);
+void orbisElfStubTableDestroy(OrbisElfStubTableHandle_t table);
+
+/*
+ * Writes perf map lines ("<start> <size> <name>", hex) for the executable segments, the defined functions and the imports bound
+ * to host stubs of a loaded handle, at its virtual base address. Lines are written from *offset on and *offset is moved past
+ * the last one written, also on errors, so several modules go into one /tmp/perf-<pid>.map by passing the same offset along.
+ */
+OrbisElfErrorCode_t orbisElfWritePerfMap(OrbisElfHandle_t elf, OrbisElfWriteCallback_t writeCallback, void *writeUserData, uint64_t *offset);
+
+/* returns orbisElfErrorCodeInvalidValue unless the handle was parsed with orbisElfParseFlagCollectStats */
+OrbisElfErrorCode_t orbisElfGetStats(OrbisElfHandle_t elf, OrbisElfStats_t *stats);
+uint64_t orbisElfGetTimestampNs(void); /* monotonic clock used for stats and trace callbacks */
+uint64_t orbisElfGetDiagnosticsCount(OrbisElfHandle_t elf, OrbisElfDiagnostic_t diagnostic); /* reported so far, see OrbisElfParseOptions_t */
+
+OrbisElfErrorCode_t orbisElfNidFromString(const char *string, uint64_t *nid);
+void orbisElfNidToString(uint64_t nid, char *string /* at least 12 bytes */);
+uint64_t orbisElfComputeNid(const char *name);
+void orbisElfComputeNids(const char *const *names, uint64_t count, uint64_t *nids);
+
+OrbisElfErrorCode_t orbisElfSymbolDbBuilderCreate(OrbisElfSymbolDbBuilderHandle_t *builder);
+OrbisElfErrorCode_t orbisElfSymbolDbBuilderAddModule(OrbisElfSymbolDbBuilderHandle_t builder, OrbisElfHandle_t elf);
+OrbisElfErrorCode_t orbisElfSymbolDbBuilderWrite(OrbisElfSymbolDbBuilderHandle_t builder, OrbisElfWriteCallback_t writeCallback, void *writeUserData);
+void orbisElfSymbolDbBuilderDestroy(OrbisElfSymbolDbBuilderHandle_t builder);
+
+/* data is usually a mapped database file, it must stay valid and 8 byte aligned until orbisElfSymbolDbClose */
+OrbisElfErrorCode_t orbisElfSymbolDbOpen(OrbisElfSymbolDbHandle_t *db, const void *data, size_t size);
+void orbisElfSymbolDbClose(OrbisElfSymbolDbHandle_t db);
+uint64_t orbisElfSymbolDbGetEntriesCount(OrbisElfSymbolDbHandle_t db);
+OrbisElfErrorCode_t orbisElfSymbolDbFind(OrbisElfSymbolDbHandle_t db, uint64_t nid, uint64_t *index, uint64_t *count);
+OrbisElfErrorCode_t orbisElfSymbolDbGetEntry(OrbisElfSymbolDbHandle_t db, uint64_t index, OrbisElfSymbolDbEntry_t *entry);
+
+/*
+ * Loads root and every module it needs (DT_SCE_NEEDED_MODULE) through the locator. Independent modules are located,
+ * mapped and loaded on up to threadsCount threads, so locator callbacks must be thread safe when threadsCount > 1.
+ * Imports are then resolved in topological order. Modules are listed dependencies first, root last, and
+ * initializers in call order: root preinit array, init functions, then finalizers. A root without a module name
+ * (DT_SCE_MODULE_INFO) gives orbisElfErrorCodeInvalidValue.
+ */
+OrbisElfErrorCode_t orbisElfLoaderCreate(OrbisElfLoaderHandle_t *loader, const OrbisElfModuleLocator_t *locator, uint32_t threadsCount);
+OrbisElfErrorCode_t orbisElfLoaderLoad(OrbisElfLoaderHandle_t loader, OrbisElfHandle_t root);
+uint64_t orbisElfLoaderGetModulesCount(OrbisElfLoaderHandle_t loader);
+OrbisElfHandle_t orbisElfLoaderGetModule(OrbisElfLoaderHandle_t loader, uint64_t index);
+uint64_t orbisElfLoaderGetMissingModulesCount(OrbisElfLoaderHandle_t loader);
+const char *orbisElfLoaderGetMissingModule(OrbisElfLoaderHandle_t loader, uint64_t index);
+uint64_t orbisElfLoaderGetInitializersCount(OrbisElfLoaderHandle_t loader);
+const OrbisElfInitializer_t *orbisElfLoaderGetInitializer(OrbisElfLoaderHandle_t loader, uint64_t index);
+void orbisElfLoaderDestroy(OrbisElfLoaderHandle_t loader);
+
+/*
+ * Process wide interned names. Handles parsed with OrbisElfParseOptions_t stringTable get every name (module, library, symbol,
+ * needed and so names) pointing into the table, module and library infos with nameId set, and keep no copy of the string
+ * table of the image. Names of handles sharing a table are compared by id or pointer. All functions are thread safe, the
+ * table must outlive the handles parsed with it. Ids start at 1, 0 is never a valid id.
+ */
+OrbisElfErrorCode_t orbisElfStringTableCreate(OrbisElfStringTableHandle_t *table);
+OrbisElfErrorCode_t orbisElfStringTableIntern(OrbisElfStringTableHandle_t table, const char *string, uint32_t *id, const char **internedString /* optional */);
+uint32_t orbisElfStringTableFind(OrbisElfStringTableHandle_t table, const char *string); /* 0 when not interned */
+const char *orbisElfStringTableGetString(OrbisElfStringTableHandle_t table, uint32_t id);
+uint64_t orbisElfStringTableGetCount(OrbisElfStringTableHandle_t table);
+void orbisElfStringTableDestroy(OrbisElfStringTableHandle_t table);
+
+/*
+ * Parsed modules shared by file identity. orbisElfCacheOpen parses on the first open of a key and hands out clones
+ * (see orbisElfClone) of that image, repeat opens are a hash lookup and read through their own callback. The first open of
+ * a key decides the parse options, its read callback is only used while parsing. A changed file gets a new key, stale
+ * entries stay until orbisElfCacheRemove. All functions are thread safe, opened handles may outlive the cache.
+ */
+OrbisElfErrorCode_t orbisElfCacheCreate(OrbisElfCacheHandle_t *cache);
+OrbisElfErrorCode_t orbisElfCacheOpen(OrbisElfCacheHandle_t cache, const OrbisElfCacheKey_t *key, OrbisElfHandle_t *handle, OrbisElfReadCallback_t readImageCallback, size_t imageSize, void *readImageUserData, const OrbisElfParseOptions_t *options);
+OrbisElfErrorCode_t orbisElfCacheRemove(OrbisElfCacheHandle_t cache, const OrbisElfCacheKey_t *key);
+uint64_t orbisElfCacheGetEntriesCount(OrbisElfCacheHandle_t cache);
+void orbisElfCacheGetStats(OrbisElfCacheHandle_t cache, uint64_t *hitsCount, uint64_t *missesCount);
+void orbisElfCacheDestroy(OrbisElfCacheHandle_t cache);
+
+/*
+ * Reads the ELF inside a fake signed SELF without unpacking it to disk. orbisElfSelfOpen reads the SELF header, segment
+ * table and program headers, then orbisElfSelfRead serves as the read callback of orbisElfParse and orbisElfLoad with
+ * readUserData set to the reader, passing orbisElfSelfGetImageSize as the image size. Compressed segments are decompressed
+ * block by block on first touch (needs zlib at build time), parts of the ELF not stored in any segment read as zeros.
+ * Opening fails with orbisElfErrorCodeInvalidImageFormat for files that aren't SELF and orbisElfErrorCodeInvalidValue
+ * for encrypted ones. The reader must outlive the handles reading through it. Reads from several threads are safe when
+ * readCallback is reentrant, the reader only serializes its shared decompression block.
+ */
+OrbisElfErrorCode_t orbisElfSelfOpen(OrbisElfSelfHandle_t *self, OrbisElfReadCallback_t readCallback, size_t fileSize, void *readUserData);
+uint64_t orbisElfSelfGetImageSize(OrbisElfSelfHandle_t self);
+uint64_t orbisElfSelfRead(uint64_t offset, void *destination, uint64_t size, void *readUserData);
+void orbisElfSelfDestroy(OrbisElfSelfHandle_t self);
+
+/*
+ * Loaded modules by address range, for symbolizing addresses of any module. Add and remove need exclusive access,
+ * lookups only shared access. Modules must stay alive until removed or the address space is destroyed.
+ */
+OrbisElfErrorCode_t orbisElfAddressSpaceCreate(OrbisElfAddressSpaceHandle_t *space);
+OrbisElfErrorCode_t orbisElfAddressSpaceAdd(OrbisElfAddressSpaceHandle_t space, OrbisElfHandle_t elf); /* orbisElfErrorCodeInvalidValue for unloaded or overlapping modules */
+OrbisElfErrorCode_t orbisElfAddressSpaceRemove(OrbisElfAddressSpaceHandle_t space, OrbisElfHandle_t elf);
+uint64_t orbisElfAddressSpaceGetModulesCount(OrbisElfAddressSpaceHandle_t space);
+OrbisElfHandle_t orbisElfAddressSpaceGetModule(OrbisElfAddressSpaceHandle_t space, uint64_t index); /* by address */
+OrbisElfHandle_t orbisElfAddressSpaceFindModule(OrbisElfAddressSpaceHandle_t space, uint64_t address);
+OrbisElfErrorCode_t orbisElfAddressSpaceSymbolize(OrbisElfAddressSpaceHandle_t space, uint64_t address, OrbisElfAddressInfo_t *info);
+void orbisElfAddressSpaceDestroy(OrbisElfAddressSpaceHandle_t space);
+
 #ifdef __cplusplus
 }
 #endif
@@ -185,4 +185,48 @@ typedef enum OrbisElfRelocationType_t
 	orbisElfRelocationTypeRelative64
 } OrbisElfRelocationType_t;
 
+#define ORBIS_ELF_RELOCATION_TYPES_COUNT (orbisElfRelocationTypeRelative64 + 1)
+
+typedef enum OrbisElfParseFlags_t
+{
+	orbisElfParseFlagNone = 0,
+	orbisElfParseFlagCollectStats = 1 << 0,
+	orbisElfParseFlagValidate = 1 << 1, /* bounds check every table once, see orbisElfGetTables */
+	orbisElfParseFlagEagerIndexes = 1 << 2 /* section table while parsing, FDE table at orbisElfLoad, otherwise built untimed on first query */
+} OrbisElfParseFlags_t;
+
+typedef enum OrbisElfPhase_t
+{
+	orbisElfPhaseParsePrograms,
+	orbisElfPhaseParseSections, /* orbisElfParseFlagEagerIndexes only */
+	orbisElfPhaseParseDynamicProgram,
+	orbisElfPhaseParseSymbols,
+	orbisElfPhaseParseRelocations,
+	orbisElfPhaseValidate,
+	orbisElfPhaseParseEhFrame, /* orbisElfParseFlagEagerIndexes only */
+	orbisElfPhaseLoad,
+	orbisElfPhaseResolve, /* orbisElfImportModule and orbisElfSetImportSymbol */
+	orbisElfPhaseCount
+} OrbisElfPhase_t;
+
+typedef enum OrbisElfDiagnostic_t
+{
+	orbisElfDiagnosticUnhandledDynamicType, /* value is the tag, offset the file offset of the entry */
+	orbisElfDiagnosticDebugDynamic, /* DT_DEBUG with a value */
+	orbisElfDiagnosticTextRelocations, /* DT_TEXTREL with a value */
+	orbisElfDiagnosticCopyRelocation, /* value is the relocation type, offset its target */
+	orbisElfDiagnosticUnsupportedImportRelocation,
+	orbisElfDiagnosticUnsupportedTlsRelocation,
+	orbisElfDiagnosticCount
+} OrbisElfDiagnostic_t;
+
+typedef enum OrbisElfInitializerType_t
+{
+	orbisElfInitializerTypePreinitArray,
+	orbisElfInitializerTypeInit,
+	orbisElfInitializerTypeInitArray,
+	orbisElfInitializerTypeFiniArray, /* entries are called in reverse order */
+	orbisElfInitializerTypeFini
+} OrbisElfInitializerType_t;
+
 #endif /* _ORBIS_ELF_ENUMS_H_ */
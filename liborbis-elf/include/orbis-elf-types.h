@@ -1,10 +1,28 @@
 #ifndef _ORBIS_ELF_TYPES_H_
 #define _ORBIS_ELF_TYPES_H_
 
+#include "orbis-elf-enums.h"
+
 #include <stdint.h>
 
 typedef struct OrbisElf_s *OrbisElfHandle_t;
+typedef struct OrbisElfSymbolDb_s *OrbisElfSymbolDbHandle_t;
+typedef struct OrbisElfSymbolDbBuilder_s *OrbisElfSymbolDbBuilderHandle_t;
+typedef struct OrbisElfLoader_s *OrbisElfLoaderHandle_t;
+typedef struct OrbisElfAddressSpace_s *OrbisElfAddressSpaceHandle_t;
+typedef struct OrbisElfStubTable_s *OrbisElfStubTableHandle_t;
+typedef struct OrbisElfStringTable_s *OrbisElfStringTableHandle_t;
+typedef struct OrbisElfCache_s *OrbisElfCacheHandle_t;
+typedef struct OrbisElfSelf_s *OrbisElfSelfHandle_t;
 typedef uint64_t (*OrbisElfReadCallback_t)(uint64_t offset, void *destination, uint64_t size, void *readUserDada);
+typedef uint64_t (*OrbisElfWriteCallback_t)(uint64_t offset, const void *source, uint64_t size, void *writeUserData);
+typedef void *(*OrbisElfAllocCallback_t)(uint64_t size, void *allocatorUserData); /* must return 16 byte aligned memory */
+typedef void (*OrbisElfFreeCallback_t)(void *pointer, void *allocatorUserData);
+typedef OrbisElfErrorCode_t (*OrbisElfLocateModuleCallback_t)(const char *moduleName, OrbisElfHandle_t *elf, void *locatorUserData);
+typedef OrbisElfErrorCode_t (*OrbisElfMapModuleCallback_t)(OrbisElfHandle_t elf, void **baseAddress, uint64_t *virtualBaseAddress, void *locatorUserData);
+typedef void (*OrbisElfReleaseModuleCallback_t)(OrbisElfHandle_t elf, void *locatorUserData);
+typedef void (*OrbisElfUnloadCallback_t)(OrbisElfHandle_t elf, void *unloadUserData);
+typedef void (*OrbisElfTraceCallback_t)(OrbisElfHandle_t elf, OrbisElfPhase_t phase, uint64_t beginNs, uint64_t endNs, void *traceUserData);
 
 typedef struct
 {
@@ -92,6 +110,7 @@ typedef struct OrbisElfLibraryInfo_s
 	uint16_t id;
 	const char *name;
 	uint32_t attr;
+	uint32_t nameId; /* interned name, 0 unless parsed with a string table */
 } OrbisElfLibraryInfo_t;
 
 typedef struct OrbisElfModuleInfo_s
@@ -100,6 +119,7 @@ typedef struct OrbisElfModuleInfo_s
 	uint16_t id;
 	const char *name;
 	uint64_t attr;
+	uint32_t nameId; /* interned name, 0 unless parsed with a string table */
 } OrbisElfModuleInfo_t;
 
 typedef struct OrbisElfSymbol_s
@@ -110,9 +130,16 @@ typedef struct OrbisElfSymbol_s
 	const OrbisElfLibraryInfo_t *library;
 	int bind; /* see OrbisElfSymbolBind_t*/
 	int type; /* see OrbisElfSymbolType_t */
-	uint64_t virtualBaseAddress;
 } OrbisElfSymbol_t;
 
+typedef struct OrbisElfSymbolBinding_s
+{
+	uint64_t virtualBaseAddress; /* of the module defining the symbol */
+	uint64_t value;
+	uint64_t size;
+	OrbisElfHandle_t module; /* handle the symbol is bound into, the module itself while unresolved, NULL when bound by address */
+} OrbisElfSymbolBinding_t;
+
 typedef struct OrbisElfRelocation_s
 {
 	uint64_t offset;
@@ -128,4 +155,126 @@ typedef struct OrbisElfRebase_s
 	uint32_t symbolIndex;
 } OrbisElfRebaseRelocation_t;
 
+typedef struct OrbisElfTables_s
+{
+	const OrbisElfProgramHeader_t *programs;
+	uint64_t programsCount;
+	const OrbisElfSymbol_t *symbols;
+	uint64_t symbolsCount;
+	const OrbisElfRebaseRelocation_t *rebaseRelocations;
+	uint64_t rebaseRelocationsCount;
+	const OrbisElfRelocation_t *importRelocations;
+	uint64_t importRelocationsCount;
+	const OrbisElfRelocation_t *tlsRelocations;
+	uint64_t tlsRelocationsCount;
+	uint64_t loadSize; /* every relocation target and symbol value is below it */
+} OrbisElfTables_t;
+
+typedef struct OrbisElfFde_s
+{
+	uint64_t pcBegin; /* virtual addresses */
+	uint64_t pcEnd;
+	uint64_t fde; /* of the FDE and its CIE in .eh_frame of the loaded image */
+	uint64_t cie;
+} OrbisElfFde_t;
+
+typedef struct OrbisElfTlsModule_s
+{
+	OrbisElfHandle_t elf;
+	uint64_t index; /* DTPMOD64 module id, position in the planned handles + 1 */
+	uint64_t offset; /* TLS block starts at thread pointer - offset, 0 without TLS */
+} OrbisElfTlsModule_t;
+
+typedef struct OrbisElfStub_s
+{
+	const char *moduleName; /* owned by the importing handle */
+	const char *libraryName;
+	const char *name;
+	uint64_t address; /* virtual address of the thunk, set by orbisElfStubTableBuild */
+	uint64_t *slot; /* jump target of the thunk, starts as the dispatcher address */
+} OrbisElfStub_t;
+
+typedef struct OrbisElfAddressInfo_s
+{
+	OrbisElfHandle_t elf; /* module containing the address */
+	const OrbisElfSymbol_t *symbol; /* NULL when no defined symbol covers the address */
+	uint64_t offset; /* from the symbol, or from the module base without one */
+} OrbisElfAddressInfo_t;
+
+typedef struct OrbisElfDiagnosticInfo_s
+{
+	OrbisElfDiagnostic_t diagnostic;
+	uint64_t offset;
+	uint64_t value;
+} OrbisElfDiagnosticInfo_t;
+
+typedef void (*OrbisElfDiagnosticCallback_t)(OrbisElfHandle_t elf, const OrbisElfDiagnosticInfo_t *info, void *diagnosticUserData);
+
+typedef struct OrbisElfAllocator_s
+{
+	OrbisElfAllocCallback_t alloc;
+	OrbisElfFreeCallback_t free;
+	void *userData;
+} OrbisElfAllocator_t;
+
+typedef struct OrbisElfParseOptions_s
+{
+	uint32_t flags; /* see OrbisElfParseFlags_t */
+	OrbisElfTraceCallback_t traceCallback; /* called for every finished phase, timestamps from orbisElfGetTimestampNs */
+	void *traceUserData;
+	const OrbisElfAllocator_t *allocator; /* NULL for malloc/free, copied into the handle, lazy indexes allocate from query threads */
+	OrbisElfDiagnosticCallback_t diagnosticCallback; /* optional, diagnostics are counted either way */
+	void *diagnosticUserData;
+	OrbisElfStringTableHandle_t stringTable; /* optional, all names are interned into it */
+} OrbisElfParseOptions_t;
+
+typedef struct OrbisElfCacheKey_s
+{
+	/* st_dev, st_ino, st_mtime and st_size of the file, images without one can put a content fingerprint into these */
+	uint64_t device;
+	uint64_t inode;
+	uint64_t modificationTime;
+	uint64_t size;
+} OrbisElfCacheKey_t;
+
+typedef struct OrbisElfStats_s
+{
+	uint64_t phaseNs[orbisElfPhaseCount];
+	uint64_t phaseCalls[orbisElfPhaseCount];
+	uint64_t bytesRead;
+	uint64_t readCalls;
+	uint64_t allocations;
+	uint64_t allocatedBytes;
+	uint64_t relocations[ORBIS_ELF_RELOCATION_TYPES_COUNT]; /* indexed by OrbisElfRelocationType_t */
+} OrbisElfStats_t;
+
+typedef struct OrbisElfSymbolDbEntry_s
+{
+	uint64_t nid;
+	const char *moduleName;
+	const char *libraryName;
+	uint16_t moduleVersion;
+	uint16_t libraryVersion;
+	int type; /* see OrbisElfSymbolType_t */
+	int bind; /* see OrbisElfSymbolBind_t */
+	uint64_t value;
+	uint64_t size;
+} OrbisElfSymbolDbEntry_t;
+
+typedef struct OrbisElfModuleLocator_s
+{
+	OrbisElfLocateModuleCallback_t locate; /* parses the module, orbisElfErrorCodeNotFound leaves its imports unresolved */
+	OrbisElfMapModuleCallback_t map; /* reserves orbisElfGetLoadSize bytes for the module */
+	OrbisElfReleaseModuleCallback_t release; /* optional, called for every located module by orbisElfLoaderDestroy */
+	void *userData;
+} OrbisElfModuleLocator_t;
+
+typedef struct OrbisElfInitializer_s
+{
+	OrbisElfHandle_t elf;
+	OrbisElfInitializerType_t type;
+	uint64_t address; /* virtual address of the function, or of the function pointers for arrays */
+	uint64_t count; /* array entries, 1 for init and fini */
+} OrbisElfInitializer_t;
+
 #endif /* _ORBIS_ELF_TYPES_H_ */
@@ -0,0 +1,160 @@
+#include "orbis-elf-types.h"
+#include "orbis-elf-enums.h"
+#include "orbis-elf-api.h"
+
+#include <malloc.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct
+{
+	uint64_t begin;
+	uint64_t end;
+	OrbisElfHandle_t elf;
+} OrbisElfAddressRange_t;
+
+typedef struct OrbisElfAddressSpace_s
+{
+	OrbisElfAddressRange_t *ranges; /* sorted by begin, never overlapping */
+	uint64_t rangesCount;
+	uint64_t rangesCapacity;
+} OrbisElfAddressSpace_t;
+
+/* first range that ends above the address */
+static uint64_t findRange(OrbisElfAddressSpaceHandle_t space, uint64_t address)
+{
+	uint64_t low = 0;
+	uint64_t high = space->rangesCount;
+
+	while (low < high)
+	{
+		uint64_t middle = low + (high - low) / 2;
+
+		if (space->ranges[middle].end <= address)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+
+	return low;
+}
+
+OrbisElfErrorCode_t orbisElfAddressSpaceCreate(OrbisElfAddressSpaceHandle_t *space)
+{
+	OrbisElfAddressSpaceHandle_t result = malloc(sizeof(OrbisElfAddressSpace_t));
+
+	if (!result)
+	{
+		return orbisElfErrorCodeNoMemory;
+	}
+
+	memset(result, 0, sizeof(OrbisElfAddressSpace_t));
+	*space = result;
+	return orbisElfErrorCodeOk;
+}
+
+void orbisElfAddressSpaceDestroy(OrbisElfAddressSpaceHandle_t space)
+{
+	free(space->ranges);
+	free(space);
+}
+
+OrbisElfErrorCode_t orbisElfAddressSpaceAdd(OrbisElfAddressSpaceHandle_t space, OrbisElfHandle_t elf)
+{
+	uint64_t begin = orbisElfGetVirtualBaseAddress(elf);
+	uint64_t size = orbisElfGetLoadSize(elf);
+
+	if (!orbisElfGetBaseAddress(elf) || !size || begin + size < begin)
+	{
+		return orbisElfErrorCodeInvalidValue;
+	}
+
+	uint64_t position = findRange(space, begin);
+
+	if (position < space->rangesCount && space->ranges[position].begin < begin + size)
+	{
+		return orbisElfErrorCodeInvalidValue;
+	}
+
+	if (space->rangesCount == space->rangesCapacity)
+	{
+		uint64_t capacity = space->rangesCapacity ? space->rangesCapacity * 2 : 16;
+		OrbisElfAddressRange_t *ranges = realloc(space->ranges, capacity * sizeof(OrbisElfAddressRange_t));
+
+		if (!ranges)
+		{
+			return orbisElfErrorCodeNoMemory;
+		}
+
+		space->ranges = ranges;
+		space->rangesCapacity = capacity;
+	}
+
+	memmove(space->ranges + position + 1, space->ranges + position, (space->rangesCount - position) * sizeof(OrbisElfAddressRange_t));
+	space->ranges[position].begin = begin;
+	space->ranges[position].end = begin + size;
+	space->ranges[position].elf = elf;
+	space->rangesCount++;
+	return orbisElfErrorCodeOk;
+}
+
+OrbisElfErrorCode_t orbisElfAddressSpaceRemove(OrbisElfAddressSpaceHandle_t space, OrbisElfHandle_t elf)
+{
+	for (uint64_t i = 0; i < space->rangesCount; ++i)
+	{
+		if (space->ranges[i].elf == elf)
+		{
+			memmove(space->ranges + i, space->ranges + i + 1, (space->rangesCount - i - 1) * sizeof(OrbisElfAddressRange_t));
+			space->rangesCount--;
+			return orbisElfErrorCodeOk;
+		}
+	}
+
+	return orbisElfErrorCodeNotFound;
+}
+
+uint64_t orbisElfAddressSpaceGetModulesCount(OrbisElfAddressSpaceHandle_t space)
+{
+	return space->rangesCount;
+}
+
+OrbisElfHandle_t orbisElfAddressSpaceGetModule(OrbisElfAddressSpaceHandle_t space, uint64_t index)
+{
+	return index < space->rangesCount ? space->ranges[index].elf : NULL;
+}
+
+OrbisElfHandle_t orbisElfAddressSpaceFindModule(OrbisElfAddressSpaceHandle_t space, uint64_t address)
+{
+	uint64_t position = findRange(space, address);
+
+	if (position == space->rangesCount || address < space->ranges[position].begin)
+	{
+		return NULL;
+	}
+
+	return space->ranges[position].elf;
+}
+
+OrbisElfErrorCode_t orbisElfAddressSpaceSymbolize(OrbisElfAddressSpaceHandle_t space, uint64_t address, OrbisElfAddressInfo_t *info)
+{
+	OrbisElfHandle_t elf = orbisElfAddressSpaceFindModule(space, address);
+
+	if (!elf)
+	{
+		return orbisElfErrorCodeNotFound;
+	}
+
+	info->elf = elf;
+	info->symbol = orbisElfFindSymbolByAddress(elf, address, &info->offset);
+
+	if (!info->symbol)
+	{
+		info->offset = address - orbisElfGetVirtualBaseAddress(elf);
+	}
+
+	return orbisElfErrorCodeOk;
+}
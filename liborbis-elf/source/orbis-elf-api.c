@@ -1,16 +1,134 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+	#define _POSIX_C_SOURCE 200809L /* clock_gettime */
+#endif
+
 #include "orbis-elf-types.h"
 #include "orbis-elf-enums.h"
 #include "orbis-elf-api.h"
 
 #include <malloc.h>
+#include <stdlib.h>
 #include <string.h>
-#include <assert.h>
-#include <stdio.h>
+#include <stdatomic.h>
 
-typedef struct OrbisElf_s
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <time.h>
+#endif
+
+typedef struct
+{
+	/* CSR: relocations of symbol i are sites[offsets[i]] .. sites[offsets[i + 1] - 1] */
+	uint32_t *importOffsets;
+	uint32_t *importSites;
+	uint32_t *tlsOffsets;
+	uint32_t *tlsSites;
+} OrbisElfSymbolRelocationIndex_t;
+
+/* what the resolution scans read, derived from OrbisElfSymbol_t rather than copied, a scan touches a fifth of the cache lines */
+typedef struct
+{
+	uint32_t nameHash; /* candidates are confirmed with the names */
+	uint32_t libraryHash; /* 0 without a library */
+	uint16_t moduleIndex; /* into importModules, importModulesCount for the own module */
+	uint8_t type : 4; /* see OrbisElfSymbolType_t */
+	uint8_t bind : 4; /* see OrbisElfSymbolBind_t */
+	uint8_t isDefined; /* header.value != 0 */
+} OrbisElfHotSymbol_t;
+
+#define ORBIS_ELF_NO_MODULE 0xffff
+
+typedef struct
+{
+	/* CSR: relocations of page i are entries[offsets[i]] .. entries[offsets[i + 1] - 1] */
+	uint32_t *offsets;
+	uint32_t *entries;
+	uint64_t pagesCount;
+} OrbisElfPageRelocationIndex_t;
+
+#define ORBIS_ELF_RELOCATION_PAGE_SIZE 0x1000
+
+typedef struct
+{
+	OrbisElfSectionHeader_t header; /* first, so orbisElfSectionGetName gets back here from the header */
+	const char *name;
+} OrbisElfSection_t;
+
+typedef struct
+{
+	OrbisElfSection_t *sections;
+	uint16_t sectionsCount;
+	uint16_t *nameIndex; /* open addressing on the name hash, section index + 1 or 0 for empty slots */
+	uint32_t nameIndexMask;
+} OrbisElfSectionTable_t;
+
+typedef struct
+{
+	uint32_t pcBegin; /* image offsets */
+	uint32_t fde;
+} OrbisElfFdeEntry_t;
+
+typedef struct
+{
+	OrbisElfFdeEntry_t *entries; /* sorted by pcBegin */
+	uint64_t entriesCount;
+} OrbisElfFdeTable_t;
+
+typedef struct
+{
+	const uint8_t *data; /* loaded image, positions are image offsets */
+	uint64_t position;
+	uint64_t end;
+	int isValid;
+} OrbisElfDwarfReader_t;
+
+typedef struct
+{
+	uint64_t value;
+	uint64_t size;
+	uint32_t symbolIndex;
+} OrbisElfAddressEntry_t;
+
+typedef struct
+{
+	uint64_t *values; /* defined symbol values, descending, in Eytzinger order from index 1 */
+	uint32_t *symbolIndexes;
+	uint64_t count;
+} OrbisElfAddressIndex_t;
+
+typedef struct
+{
+	char magic[8];
+	uint64_t preferredBase;
+	uint64_t sitesCount; /* uint32_t image offsets of the rebase sites, right before the trailer */
+	uint64_t imageSize; /* before the sites */
+} OrbisElfPrelinkTrailer_t;
+
+#define ORBIS_ELF_PRELINK_MAGIC "OEPRELNK"
+#define ORBIS_ELF_PRELINK_COPY_SIZE 0x10000
+
+#define DW_EH_PE_absptr 0x00
+#define DW_EH_PE_uleb128 0x01
+#define DW_EH_PE_udata2 0x02
+#define DW_EH_PE_udata4 0x03
+#define DW_EH_PE_udata8 0x04
+#define DW_EH_PE_sleb128 0x09
+#define DW_EH_PE_sdata2 0x0a
+#define DW_EH_PE_sdata4 0x0b
+#define DW_EH_PE_sdata8 0x0c
+#define DW_EH_PE_pcrel 0x10
+#define DW_EH_PE_datarel 0x30
+#define DW_EH_PE_omit 0xff
+
+#if defined(__GNUC__) || defined(__clang__)
+	#define ORBIS_ELF_PREFETCH(address) __builtin_prefetch(address)
+#else
+	#define ORBIS_ELF_PREFETCH(address)
+#endif
+
+typedef struct OrbisElfImage_s
 {
-	OrbisElfReadCallback_t read;
-	void *readUserData;
 	size_t imageSize;
 	
 	OrbisElfHeader_t header;
@@ -18,8 +136,7 @@ typedef struct OrbisElf_s
 	OrbisElfProgramHeader_t *programs;
 	uint16_t programsCount;
 
-	OrbisElfSectionHeader_t *sections;
-	uint16_t sectionsCount;
+	_Atomic(OrbisElfSectionTable_t *) sectionTable; /* built on first query, sections aren't needed for loading */
 
 	OrbisElfLibraryInfo_t *importLibraries;
 	uint64_t importLibrariesCount;
@@ -31,6 +148,7 @@ typedef struct OrbisElf_s
 	uint64_t importModulesCount;
 
 	OrbisElfSymbol_t *symbols;
+	OrbisElfHotSymbol_t *hotSymbols; /* parallel to symbols */
 	uint64_t symbolsCount;
 
 	const OrbisElfSymbolHeader_t *sceSymTab;
@@ -42,6 +160,7 @@ typedef struct OrbisElf_s
 
 	const OrbisElfDynamic_t *dynamics;
 	uint64_t dynamicsCount;
+	uint64_t dynamicsOffset;
 
 	const char *sceDynlibData;
 	uint64_t sceDynlibDataSize;
@@ -57,6 +176,10 @@ typedef struct OrbisElf_s
 	uint64_t tlsInitSize;
 	uint64_t tlsInitAddress;
 
+	uint64_t ehFrameHeaderAddress;
+	uint64_t ehFrameHeaderSize;
+	_Atomic(OrbisElfFdeTable_t *) fdeTable; /* built from the loaded image on first orbisElfFindFde */
+
 	uint64_t loadSize;
 
 	OrbisElfDynamicType_t scePltRelType;
@@ -87,6 +210,11 @@ typedef struct OrbisElf_s
 	OrbisElfRebaseRelocation_t *rebaseRelocations;
 	uint64_t rebaseRelocationsCount;
 
+	uint32_t *prelinkSites; /* NULL unless the image was written by orbisElfPrelink */
+	uint64_t prelinkSitesCount;
+	uint64_t prelinkBase;
+	uint64_t prelinkImageSize; /* image without the prelink sites and trailer */
+
 	OrbisElfRelocation_t *importRelocations;
 	uint64_t importRelocationsCount;
 
@@ -94,242 +222,631 @@ typedef struct OrbisElf_s
 	uint64_t tlsRelocationsCount;
 
 	OrbisElfModuleInfo_t moduleInfo;
-	uint64_t virtualBaseAddress;
+	OrbisElfStringTableHandle_t stringTable; /* module and library names are interned into it when set */
+
+	_Atomic(OrbisElfSymbolRelocationIndex_t *) symbolRelocationIndex; /* built on first use */
+	_Atomic(OrbisElfPageRelocationIndex_t *) pageRelocationIndex; /* built on first orbisElfRelocatePage */
+	_Atomic(OrbisElfAddressIndex_t *) addressIndex; /* built on first orbisElfFindSymbolByAddress */
+	int isValidated; /* passed validateImage, see orbisElfGetTables */
+	atomic_uint_fast64_t handlesCount; /* the parsed handle and its clones, the last one frees the image */
+
+	OrbisElfAllocator_t allocator;
+	uint8_t *arenaBegin; /* caller memory of orbisElfParseInPlace, NULL for heap handles */
+	uint8_t *arenaCurrent;
+	uint8_t *arenaEnd;
+	uint64_t requiredSize; /* what orbisElfParseInPlace would need for the allocations made so far */
+} OrbisElfImage_t;
+
+typedef struct OrbisElfBindingSlot_s
+{
+	_Atomic(struct OrbisElf_s *) module;
+	_Atomic uint64_t virtualBaseAddress;
+	_Atomic uint64_t value;
+	_Atomic uint64_t size;
+} OrbisElfBindingSlot_t;
 
+typedef struct OrbisElfModuleLink_s
+{
+	struct OrbisElf_s *importer;
+	struct OrbisElf_s *dependency; /* NULL while nothing is imported from the module */
+	struct OrbisElfModuleLink_s *previousImporter;
+	struct OrbisElfModuleLink_s *nextImporter;
+} OrbisElfModuleLink_t;
+
+typedef struct OrbisElf_s
+{
+	OrbisElfImage_t *image; /* immutable once parsing is done */
+	OrbisElfReadCallback_t read; /* per handle, clones may read the same image through another source */
+	void *readUserData;
+
+	OrbisElfBindingSlot_t *bindings; /* per symbol, see OrbisElfSymbolBinding_t */
+	atomic_uint_fast64_t bindingsSequence; /* odd while a binding is being written */
+
+	OrbisElfModuleLink_t *dependencies; /* per import module */
+	OrbisElfModuleLink_t *importers; /* links of the modules that import from this one */
+	_Atomic uint64_t referencesCount; /* caller + importers */
+	OrbisElfUnloadCallback_t unloadCallback;
+	void *unloadUserData;
+
+	uint64_t virtualBaseAddress;
 	void *baseAddress;
+
+	uint32_t parseFlags; /* see OrbisElfParseFlags_t */
+	OrbisElfTraceCallback_t traceCallback;
+	void *traceUserData;
+	OrbisElfStats_t stats;
+
+	OrbisElfDiagnosticCallback_t diagnosticCallback;
+	void *diagnosticUserData;
+	atomic_uint_fast64_t diagnostics[orbisElfDiagnosticCount]; /* counted with or without a callback */
 } OrbisElf_t;
 
+#define ORBIS_ELF_ALLOCATION_ALIGN 16
+#define ORBIS_ELF_ALIGN_ALLOCATION(size) (((uint64_t)(size) + ORBIS_ELF_ALLOCATION_ALIGN - 1) & ~(uint64_t)(ORBIS_ELF_ALLOCATION_ALIGN - 1))
+
+static int isTimingEnabled(OrbisElfHandle_t elf)
+{
+	return (elf->parseFlags & orbisElfParseFlagCollectStats) || elf->traceCallback;
+}
+
+static uint64_t beginPhase(OrbisElfHandle_t elf)
+{
+	return isTimingEnabled(elf) ? orbisElfGetTimestampNs() : 0;
+}
+
+static void endPhase(OrbisElfHandle_t elf, OrbisElfPhase_t phase, uint64_t begin)
+{
+	if (!isTimingEnabled(elf))
+	{
+		return;
+	}
+
+	uint64_t end = orbisElfGetTimestampNs();
+
+	if (elf->parseFlags & orbisElfParseFlagCollectStats)
+	{
+		elf->stats.phaseNs[phase] += end - begin;
+		elf->stats.phaseCalls[phase]++;
+	}
+
+	if (elf->traceCallback)
+	{
+		elf->traceCallback(elf, phase, begin, end, elf->traceUserData);
+	}
+}
+
+static OrbisElfErrorCode_t runParsePhase(OrbisElfHandle_t elf, OrbisElfPhase_t phase, OrbisElfErrorCode_t (*parse)(OrbisElfHandle_t elf))
+{
+	uint64_t begin = beginPhase(elf);
+	OrbisElfErrorCode_t errorCode = parse(elf);
+	endPhase(elf, phase, begin);
+	return errorCode;
+}
+
+/* relocation queries report from any thread, so counters are atomic and the callback must be thread safe */
+static void reportDiagnostic(OrbisElfHandle_t elf, OrbisElfDiagnostic_t diagnostic, uint64_t offset, uint64_t value)
+{
+	atomic_fetch_add_explicit(&elf->diagnostics[diagnostic], 1, memory_order_relaxed);
+
+	if (elf->diagnosticCallback)
+	{
+		OrbisElfDiagnosticInfo_t info = { diagnostic, offset, value };
+		elf->diagnosticCallback(elf, &info, elf->diagnosticUserData);
+	}
+}
+
+static void *allocatorAlloc(const OrbisElfAllocator_t *allocator, uint64_t size)
+{
+	return allocator->alloc ? allocator->alloc(size, allocator->userData) : malloc(size);
+}
+
+static void allocatorFree(const OrbisElfAllocator_t *allocator, void *pointer)
+{
+	if (allocator->free)
+	{
+		allocator->free(pointer, allocator->userData);
+	}
+	else
+	{
+		free(pointer);
+	}
+}
+
+static void *allocate(OrbisElfHandle_t elf, size_t size)
+{
+	void *result;
+	uint64_t alignedSize = ORBIS_ELF_ALIGN_ALLOCATION(size);
+
+	if (elf->image->arenaBegin && (uint64_t)(elf->image->arenaEnd - elf->image->arenaCurrent) >= alignedSize)
+	{
+		result = elf->image->arenaCurrent;
+		elf->image->arenaCurrent += alignedSize;
+	}
+	else if (elf->image->arenaBegin && !elf->image->allocator.alloc)
+	{
+		return NULL;
+	}
+	else
+	{
+		result = allocatorAlloc(&elf->image->allocator, size);
+	}
+
+	if (!result)
+	{
+		return NULL;
+	}
+
+	elf->image->requiredSize += alignedSize;
+
+	if (elf->parseFlags & orbisElfParseFlagCollectStats)
+	{
+		elf->stats.allocations++;
+		elf->stats.allocatedBytes += size;
+	}
+
+	return result;
+}
+
+/* storage allocated after parsing, when other handles may use the image, never comes from the arena and isn't counted */
+static void *allocateShared(OrbisElfHandle_t elf, size_t size)
+{
+	return allocatorAlloc(&elf->image->allocator, size);
+}
+
+static void elfFree(OrbisElfHandle_t elf, const void *pointer)
+{
+	if (!pointer || ((const uint8_t *)pointer >= elf->image->arenaBegin && (const uint8_t *)pointer < elf->image->arenaEnd))
+	{
+		return;
+	}
+
+	allocatorFree(&elf->image->allocator, (void *)pointer);
+}
+
+static void countRelocation(OrbisElfHandle_t elf, uint32_t relType)
+{
+	if ((elf->parseFlags & orbisElfParseFlagCollectStats) && relType < ORBIS_ELF_RELOCATION_TYPES_COUNT)
+	{
+		elf->stats.relocations[relType]++;
+	}
+}
+
+/*
+ * Bindings are the only handle state that changes after parsing. A single binding thread writes them under
+ * bindingsSequence (seqlock), so any number of query threads can read consistent bindings without locks.
+ */
+static void beginBindingsWrite(OrbisElfHandle_t elf)
+{
+	uint64_t sequence = atomic_load_explicit(&elf->bindingsSequence, memory_order_relaxed);
+	atomic_store_explicit(&elf->bindingsSequence, sequence + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+}
+
+static void endBindingsWrite(OrbisElfHandle_t elf)
+{
+	uint64_t sequence = atomic_load_explicit(&elf->bindingsSequence, memory_order_relaxed);
+	atomic_store_explicit(&elf->bindingsSequence, sequence + 1, memory_order_release);
+}
+
+static void storeBinding(OrbisElfHandle_t elf, uint64_t index, OrbisElfHandle_t module, uint64_t virtualBaseAddress, uint64_t value, uint64_t size)
+{
+	atomic_store_explicit(&elf->bindings[index].module, module, memory_order_relaxed);
+	atomic_store_explicit(&elf->bindings[index].virtualBaseAddress, virtualBaseAddress, memory_order_relaxed);
+	atomic_store_explicit(&elf->bindings[index].value, value, memory_order_relaxed);
+	atomic_store_explicit(&elf->bindings[index].size, size, memory_order_relaxed);
+}
+
+static void loadBinding(OrbisElfHandle_t elf, uint64_t index, OrbisElfSymbolBinding_t *binding)
+{
+	for (;;)
+	{
+		uint64_t sequence = atomic_load_explicit(&elf->bindingsSequence, memory_order_acquire);
+
+		if (sequence & 1)
+		{
+			continue;
+		}
+
+		binding->module = atomic_load_explicit(&elf->bindings[index].module, memory_order_relaxed);
+		binding->virtualBaseAddress = atomic_load_explicit(&elf->bindings[index].virtualBaseAddress, memory_order_relaxed);
+		binding->value = atomic_load_explicit(&elf->bindings[index].value, memory_order_relaxed);
+		binding->size = atomic_load_explicit(&elf->bindings[index].size, memory_order_relaxed);
+		atomic_thread_fence(memory_order_acquire);
+
+		if (atomic_load_explicit(&elf->bindingsSequence, memory_order_relaxed) == sequence)
+		{
+			return;
+		}
+	}
+}
+
+static OrbisElfErrorCode_t initBindings(OrbisElfHandle_t elf, void *(*allocateBindings)(OrbisElfHandle_t elf, size_t size))
+{
+	elf->bindings = allocateBindings(elf, sizeof(OrbisElfBindingSlot_t) * elf->image->symbolsCount);
+	elf->dependencies = elf->image->importModulesCount ? allocateBindings(elf, sizeof(OrbisElfModuleLink_t) * elf->image->importModulesCount) : NULL;
+
+	if (!elf->bindings || (elf->image->importModulesCount && !elf->dependencies))
+	{
+		return orbisElfErrorCodeNoMemory;
+	}
+
+	for (uint64_t i = 0; i < elf->image->importModulesCount; ++i)
+	{
+		memset(elf->dependencies + i, 0, sizeof(OrbisElfModuleLink_t));
+		elf->dependencies[i].importer = elf;
+	}
+
+	for (uint64_t i = 0; i < elf->image->symbolsCount; ++i)
+	{
+		atomic_init(&elf->bindings[i].module, elf);
+		atomic_init(&elf->bindings[i].virtualBaseAddress, elf->virtualBaseAddress);
+		atomic_init(&elf->bindings[i].value, elf->image->symbols[i].header.value);
+		atomic_init(&elf->bindings[i].size, elf->image->symbols[i].header.size);
+	}
+
+	return orbisElfErrorCodeOk;
+}
+
+/* a prelinked image ends with its rebase sites and OrbisElfPrelinkTrailer_t, the ELF data before them is unchanged */
+static OrbisElfErrorCode_t parsePrelinkTrailer(OrbisElfHandle_t elf)
+{
+	OrbisElfImage_t *image = elf->image;
+	OrbisElfPrelinkTrailer_t trailer;
+
+	image->prelinkImageSize = image->imageSize;
+
+	/* the trailer is appended after everything the headers describe, so images ending there aren't probed */
+	uint64_t dataEnd = (uint64_t)image->header.shoff + (uint64_t)image->header.shnum * image->header.shentsize;
+
+	for (uint16_t i = 0; i < image->programsCount; ++i)
+	{
+		uint64_t programEnd = image->programs[i].offset + image->programs[i].filesz;
+		dataEnd = programEnd > dataEnd ? programEnd : dataEnd;
+	}
+
+	if (image->imageSize <= dataEnd || orbisElfRead(elf, image->imageSize - sizeof(trailer), &trailer, sizeof(trailer)) != sizeof(trailer) ||
+	    memcmp(trailer.magic, ORBIS_ELF_PRELINK_MAGIC, sizeof(trailer.magic)) != 0)
+	{
+		return orbisElfErrorCodeOk;
+	}
+
+	uint64_t sitesEnd = image->imageSize - sizeof(trailer);
+
+	if (trailer.sitesCount > sitesEnd / sizeof(uint32_t) || trailer.imageSize != sitesEnd - trailer.sitesCount * sizeof(uint32_t) || image->loadSize < sizeof(uint64_t))
+	{
+		return orbisElfErrorCodeCorruptedImage;
+	}
+
+	image->prelinkSites = allocate(elf, sizeof(uint32_t) * (trailer.sitesCount ? trailer.sitesCount : 1));
+
+	if (!image->prelinkSites)
+	{
+		return orbisElfErrorCodeNoMemory;
+	}
+
+	if (orbisElfRead(elf, trailer.imageSize, image->prelinkSites, sizeof(uint32_t) * trailer.sitesCount) != sizeof(uint32_t) * trailer.sitesCount)
+	{
+		return orbisElfErrorCodeIoError;
+	}
+
+	for (uint64_t i = 0; i < trailer.sitesCount; ++i)
+	{
+		if (image->prelinkSites[i] > image->loadSize - sizeof(uint64_t))
+		{
+			return orbisElfErrorCodeCorruptedImage;
+		}
+	}
+
+	image->prelinkBase = trailer.preferredBase;
+	image->prelinkSitesCount = trailer.sitesCount;
+	image->prelinkImageSize = trailer.imageSize;
+	return orbisElfErrorCodeOk;
+}
+
 static OrbisElfErrorCode_t parsePrograms(OrbisElfHandle_t elf)
 {
-	if (elf->header.phentsize != sizeof(OrbisElfProgramHeader_t))
+	if (elf->image->header.phentsize != sizeof(OrbisElfProgramHeader_t))
 	{
 		return orbisElfErrorCodeCorruptedImage;
 	}
 	
-	elf->programs = malloc(elf->header.phentsize * elf->header.phnum);
+	elf->image->programs = allocate(elf, elf->image->header.phentsize * elf->image->header.phnum);
 
-	if (!elf->programs)
+	if (!elf->image->programs)
 	{
 		return orbisElfErrorCodeNoMemory;
 	}
 
-	elf->programsCount = elf->header.phnum;
+	elf->image->programsCount = elf->image->header.phnum;
 	
-	if (orbisElfRead(elf, elf->header.phoff, elf->programs, elf->header.phnum * elf->header.phentsize) != elf->header.phnum * elf->header.phentsize)
+	if (orbisElfRead(elf, elf->image->header.phoff, elf->image->programs, elf->image->header.phnum * elf->image->header.phentsize) != elf->image->header.phnum * elf->image->header.phentsize)
 	{
 		return orbisElfErrorCodeIoError;
 	}
 	
 	OrbisElfErrorCode_t error = orbisElfErrorCodeOk;
 
-	for (uint16_t i = 0; i < elf->programsCount; ++i)
+	for (uint16_t i = 0; i < elf->image->programsCount; ++i)
 	{
-		switch (elf->programs[i].type)
+		if ((elf->image->programs[i].type == orbisElfProgramTypeDynamic || elf->image->programs[i].type == orbisElfProgramTypeSceDynlibData) &&
+		    elf->image->programs[i].filesz > elf->image->imageSize)
+		{
+			return orbisElfErrorCodeCorruptedImage;
+		}
+
+		switch (elf->image->programs[i].type)
 		{
 		case orbisElfProgramTypeLoad:
 		case orbisElfProgramTypeSceRelRo:
-			if (elf->programs[i].vaddr + elf->programs[i].memsz > elf->loadSize)
+			if (elf->image->programs[i].vaddr + elf->image->programs[i].memsz > elf->image->loadSize)
 			{
-				elf->loadSize = elf->programs[i].vaddr + elf->programs[i].memsz;
+				elf->image->loadSize = elf->image->programs[i].vaddr + elf->image->programs[i].memsz;
 			}
 			break;
 
 		case orbisElfProgramTypeDynamic:
-			if (elf->programs[i].filesz)
+			if (elf->image->programs[i].filesz)
 			{
-				void *allocatedData = malloc(elf->programs[i].filesz);
-				elf->dynamics = allocatedData;
+				void *allocatedData = allocate(elf, elf->image->programs[i].filesz);
+				elf->image->dynamics = allocatedData;
+
+				if (!allocatedData)
+				{
+					return orbisElfErrorCodeNoMemory;
+				}
 				
-				if (orbisElfRead(elf, elf->programs[i].offset, allocatedData, elf->programs[i].filesz) != elf->programs[i].filesz)
+				if (orbisElfRead(elf, elf->image->programs[i].offset, allocatedData, elf->image->programs[i].filesz) != elf->image->programs[i].filesz)
 				{
 					error = orbisElfErrorCodeIoError;
 				}
 				else
 				{
-					elf->dynamicsCount = elf->programs[i].filesz / sizeof(OrbisElfDynamic_t);
+					elf->image->dynamicsCount = elf->image->programs[i].filesz / sizeof(OrbisElfDynamic_t);
+					elf->image->dynamicsOffset = elf->image->programs[i].offset;
 				}
 			}
 			break;
 
 		case orbisElfProgramTypeSceDynlibData:
-			if (elf->programs[i].filesz)
+			if (elf->image->programs[i].filesz)
 			{
-				void *allocatedData = malloc(elf->programs[i].filesz);
-				elf->sceDynlibData = allocatedData;
+				void *allocatedData = allocate(elf, elf->image->programs[i].filesz);
+				elf->image->sceDynlibData = allocatedData;
+
+				if (!allocatedData)
+				{
+					return orbisElfErrorCodeNoMemory;
+				}
 				
-				if (orbisElfRead(elf, elf->programs[i].offset, allocatedData, elf->programs[i].filesz) != elf->programs[i].filesz)
+				if (orbisElfRead(elf, elf->image->programs[i].offset, allocatedData, elf->image->programs[i].filesz) != elf->image->programs[i].filesz)
 				{
 					error = orbisElfErrorCodeIoError;
 				}
 				else
 				{
-					elf->sceDynlibDataSize = elf->programs[i].filesz;
+					elf->image->sceDynlibDataSize = elf->image->programs[i].filesz;
 				}
 			}
 			break;
 
 		case orbisElfProgramTypeSceProcParam:
-			elf->sceProcParam = elf->programs[i].vaddr;
-			elf->sceProcParamSize = elf->programs[i].filesz;
+			elf->image->sceProcParam = elf->image->programs[i].vaddr;
+			elf->image->sceProcParamSize = elf->image->programs[i].filesz;
 			break;
 
 		case orbisElfProgramTypeTls:
-			elf->tlsSize = elf->programs[i].memsz;
-			elf->tlsAlign = elf->programs[i].align;
-			elf->tlsInitSize = elf->programs[i].filesz;
-			elf->tlsInitAddress = elf->programs[i].vaddr;
+			elf->image->tlsSize = elf->image->programs[i].memsz;
+			elf->image->tlsAlign = elf->image->programs[i].align;
+			elf->image->tlsInitSize = elf->image->programs[i].filesz;
+			elf->image->tlsInitAddress = elf->image->programs[i].vaddr;
+			break;
+
+		case orbisElfProgramTypeGnuEhFrame:
+			elf->image->ehFrameHeaderAddress = elf->image->programs[i].vaddr;
+			elf->image->ehFrameHeaderSize = elf->image->programs[i].filesz;
 			break;
 		}
 	}
 
-	return orbisElfErrorCodeOk;
+	return parsePrelinkTrailer(elf);
 }
 
-static OrbisElfErrorCode_t parseSections(OrbisElfHandle_t elf)
+static int isInDynlibData(OrbisElfHandle_t elf, uint64_t offset, uint64_t size)
+{
+	return offset <= elf->image->sceDynlibDataSize && size <= elf->image->sceDynlibDataSize - offset;
+}
+
+static const char *getString(OrbisElfHandle_t elf, uint64_t offset)
 {
-	/*
-	elf->sections = malloc(sizeof(OrbisElfSection_t) * elf->header.shnum);
+	return offset < elf->image->sceStrTabSize ? elf->image->sceStrTab + offset : NULL;
+}
 
-	if (!elf->sections)
+static int isStringDynamicType(int64_t type)
+{
+	switch (type)
 	{
-		return orbisElfErrorCodeNoMemory;
+	case orbisElfDynamicTypeSoName:
+	case orbisElfDynamicTypeSceImportLib:
+	case orbisElfDynamicTypeSceExportLib:
+	case orbisElfDynamicTypeSceNeededModule:
+	case orbisElfDynamicTypeSceModuleInfo:
+	case orbisElfDynamicTypeSceOriginalFilename:
+	case orbisElfDynamicTypeNeeded:
+		return 1;
+
+	default:
+		return 0;
 	}
+}
 
-	elf->sectionsCount = elf->header.shnum;
-	memset(elf->sections, 0, sizeof(OrbisElfSection_t) * elf->sectionsCount);
+static OrbisElfErrorCode_t internName(OrbisElfHandle_t elf, const char **name, uint32_t *nameId)
+{
+	return *name ? orbisElfStringTableIntern(elf->image->stringTable, *name, nameId, name) : orbisElfErrorCodeOk;
+}
 
-	const OrbisElfSectionHeader_t *strsection = NULL;
+/* names then point into the string table, so every module shares one copy and compares them by id */
+static OrbisElfErrorCode_t internNames(OrbisElfHandle_t elf)
+{
+	OrbisElfImage_t *image = elf->image;
+	uint32_t nameId;
 
-	if (elf->header.shstrndx < elf->sectionsCount)
+	if (!image->stringTable)
 	{
-		strsection = ((const OrbisElfSectionHeader_t *)((const char *)elf->image + elf->header.shoff)) + elf->header.shstrndx;
+		return orbisElfErrorCodeOk;
+	}
 
-		if (strsection->type != orbisElfSectionTypeStrTab)
-		{
-			strsection = NULL;
-		}
+	OrbisElfErrorCode_t errorCode = internName(elf, &image->moduleInfo.name, &image->moduleInfo.nameId);
+	errorCode = errorCode == orbisElfErrorCodeOk ? internName(elf, &image->soName, &nameId) : errorCode;
+	errorCode = errorCode == orbisElfErrorCodeOk ? internName(elf, &image->originalFileName, &nameId) : errorCode;
+
+	for (uint64_t i = 0; errorCode == orbisElfErrorCodeOk && i < image->neededCount; ++i)
+	{
+		errorCode = internName(elf, image->needed + i, &nameId);
 	}
 
-	for (uint16_t i = 0; i < elf->sectionsCount; ++i)
+	for (uint64_t i = 0; errorCode == orbisElfErrorCodeOk && i < image->importModulesCount; ++i)
 	{
-		elf->sections[i].header = ((const OrbisElfSectionHeader_t *)((const char *)elf->image + elf->header.shoff))[i];
-		elf->sections[i].data = (const char *)elf->image + elf->sections[i].header.offset;
+		errorCode = internName(elf, &image->importModules[i].name, &image->importModules[i].nameId);
+	}
 
-		if (strsection)
-		{
-			elf->sections[i].name = (const char *)elf->image + strsection->offset + elf->sections[i].header.name;
-		}
+	for (uint64_t i = 0; errorCode == orbisElfErrorCodeOk && i < image->importLibrariesCount; ++i)
+	{
+		errorCode = internName(elf, &image->importLibraries[i].name, &image->importLibraries[i].nameId);
 	}
-	*/
-	return orbisElfErrorCodeOk;
+
+	for (uint64_t i = 0; errorCode == orbisElfErrorCodeOk && i < image->exportLibrariesCount; ++i)
+	{
+		errorCode = internName(elf, &image->exportLibraries[i].name, &image->exportLibraries[i].nameId);
+	}
+
+	return errorCode;
+}
+
+/* ids of handles interned into the same string table are equal exactly when the names are */
+static int isSameName(OrbisElfHandle_t elf, const char *name, uint32_t nameId, OrbisElfHandle_t otherElf, const char *otherName, uint32_t otherNameId)
+{
+	if (nameId && otherNameId && elf->image->stringTable == otherElf->image->stringTable)
+	{
+		return nameId == otherNameId;
+	}
+
+	return strcmp(name, otherName) == 0;
+}
+
+/* interned symbol names are one copy per table, so equal names of handles sharing it are equal pointers */
+static int isSameSymbolName(OrbisElfHandle_t elf, const char *name, OrbisElfHandle_t otherElf, const char *otherName)
+{
+	if (elf->image->stringTable && elf->image->stringTable == otherElf->image->stringTable)
+	{
+		return name == otherName;
+	}
+
+	return strcmp(name, otherName) == 0;
 }
 
 static OrbisElfErrorCode_t parseDynamicProgram(OrbisElfHandle_t elf)
 {
-	if (!elf->dynamics/* || !elf->sceDynlibData */)
+	if (!elf->image->dynamics/* || !elf->image->sceDynlibData */)
 	{
 		return orbisElfErrorCodeOk;
 	}
 
-	elf->sceSymTabEntrySize = sizeof(OrbisElfSymbolHeader_t);
-	elf->sceRelaEntSize = sizeof(OrbisElfRela_t);
+	elf->image->sceSymTabEntrySize = sizeof(OrbisElfSymbolHeader_t);
+	elf->image->sceRelaEntSize = sizeof(OrbisElfRela_t);
 
 	int neededCount = 0;
+	uint64_t symTabOffset = 0;
+	uint64_t strTabOffset = 0;
+	uint64_t jmpRelOffset = 0;
+	uint64_t relaOffset = 0;
+	int hasTables = 0; /* bits for symtab, strtab, jmprel, rela */
 
-	for (uint64_t i = 0; i < elf->dynamicsCount && elf->dynamics[i].type != orbisElfDynamicTypeNull; ++i)
+	for (uint64_t i = 0; i < elf->image->dynamicsCount && elf->image->dynamics[i].type != orbisElfDynamicTypeNull; ++i)
 	{
-		switch (elf->dynamics[i].type)
+		switch (elf->image->dynamics[i].type)
 		{
 		case orbisElfDynamicTypeSoName:
 			break;
 
 		case orbisElfDynamicTypeSceImportLib:
-			elf->importLibrariesCount++;
+			elf->image->importLibrariesCount++;
 			break;
 
 		case orbisElfDynamicTypeSceExportLib:
-			elf->exportLibrariesCount++;
+			elf->image->exportLibrariesCount++;
 			break;
 
 		case orbisElfDynamicTypeSceNeededModule:
-			elf->importModulesCount++;
+			elf->image->importModulesCount++;
 			break;
 
 		case orbisElfDynamicTypeSceSymTab:
-			if (elf->sceDynlibData)
-			{
-				elf->sceSymTab = (const OrbisElfSymbolHeader_t *)(elf->sceDynlibData + elf->dynamics[i].value);
-			}
+			symTabOffset = elf->image->dynamics[i].value;
+			hasTables |= 1;
 			break;
 
 		case orbisElfDynamicTypeSceSymEnt:
-			elf->sceSymTabEntrySize = elf->dynamics[i].value;
+			elf->image->sceSymTabEntrySize = elf->image->dynamics[i].value;
 			break;
 
 		case orbisElfDynamicTypeSceSymTabSize:
-			elf->sceSymTabSize = elf->dynamics[i].value;
+			elf->image->sceSymTabSize = elf->image->dynamics[i].value;
 			break;
 
 		case orbisElfDynamicTypeSceStrTab:
-			if (elf->sceDynlibData)
-			{
-				elf->sceStrTab = (const char *)(elf->sceDynlibData + elf->dynamics[i].value);
-			}
+			strTabOffset = elf->image->dynamics[i].value;
+			hasTables |= 2;
 			break;
 
 		case orbisElfDynamicTypeSceStrSize:
-			elf->sceStrTabSize = elf->dynamics[i].value;
+			elf->image->sceStrTabSize = elf->image->dynamics[i].value;
 			break;
 
 		case orbisElfDynamicTypeScePltGot:
-			elf->pltGotAddress = elf->dynamics[i].value;
+			elf->image->pltGotAddress = elf->image->dynamics[i].value;
 			break;
 
 		case orbisElfDynamicTypeSceModuleInfo:
-			elf->moduleInfo.id = elf->dynamics[i].value >> 48;
-			elf->moduleInfo.version = (elf->dynamics[i].value >> 32) & 0xffff;
+			elf->image->moduleInfo.id = elf->image->dynamics[i].value >> 48;
+			elf->image->moduleInfo.version = (elf->image->dynamics[i].value >> 32) & 0xffff;
 			break;
 
 		case orbisElfDynamicTypeSceModuleAttr:
-			elf->moduleInfo.attr = elf->dynamics[i].value;
+			elf->image->moduleInfo.attr = elf->image->dynamics[i].value;
 			break;
 
 		case orbisElfDynamicTypeSceJmpRel:
-			if (elf->sceDynlibData)
-			{
-				elf->sceJmpRel = (const void *)(elf->sceDynlibData + elf->dynamics[i].value);
-			}
+			jmpRelOffset = elf->image->dynamics[i].value;
+			hasTables |= 4;
 			break;
 
 		case orbisElfDynamicTypeScePltRel:
-			elf->scePltRelType = elf->dynamics[i].value;
+			elf->image->scePltRelType = elf->image->dynamics[i].value;
 			break;
 
 		case orbisElfDynamicTypeScePltRelSize:
-			elf->scePltRelSize = elf->dynamics[i].value;
+			elf->image->scePltRelSize = elf->image->dynamics[i].value;
 			break;
 
 		case orbisElfDynamicTypeSceRela:
-			if (elf->sceDynlibData)
-			{
-				elf->sceRela = (const OrbisElfRela_t *)(elf->sceDynlibData + elf->dynamics[i].value);
-			}
+			relaOffset = elf->image->dynamics[i].value;
+			hasTables |= 8;
 			break;
 
 		case orbisElfDynamicTypeSceRelaSize:
-			elf->sceRelaSize = elf->dynamics[i].value;
+			elf->image->sceRelaSize = elf->image->dynamics[i].value;
 			break;
 
 		case orbisElfDynamicTypeSceRelaEnt:
-			elf->sceRelaEntSize = elf->dynamics[i].value;
+			elf->image->sceRelaEntSize = elf->image->dynamics[i].value;
 			break;
 
 		case orbisElfDynamicTypeInit:
-			elf->initAddress = elf->dynamics[i].value;
+			elf->image->initAddress = elf->image->dynamics[i].value;
 			break;
 
 		case orbisElfDynamicTypeFini:
-			elf->finiAddress = elf->dynamics[i].value;
+			elf->image->finiAddress = elf->image->dynamics[i].value;
 			break;
 
 		case orbisElfDynamicTypeNeeded:
@@ -337,19 +854,19 @@ static OrbisElfErrorCode_t parseDynamicProgram(OrbisElfHandle_t elf)
 			break;
 
 		case orbisElfDynamicTypeInitArray:
-			elf->initArrayAddress = elf->dynamics[i].value;
+			elf->image->initArrayAddress = elf->image->dynamics[i].value;
 			break;
 
 		case orbisElfDynamicTypeFiniArray:
-			elf->finiArrayAddress = elf->dynamics[i].value;
+			elf->image->finiArrayAddress = elf->image->dynamics[i].value;
 			break;
 
 		case orbisElfDynamicTypeInitArraySize:
-			elf->initArrayCount = elf->dynamics[i].value / 8;
+			elf->image->initArrayCount = elf->image->dynamics[i].value / 8;
 			break;
 
 		case orbisElfDynamicTypeFiniArraySize:
-			elf->finiArrayCount = elf->dynamics[i].value / 8;
+			elf->image->finiArrayCount = elf->image->dynamics[i].value / 8;
 			break;
 
 		case orbisElfDynamicTypeFlags:
@@ -357,28 +874,28 @@ static OrbisElfErrorCode_t parseDynamicProgram(OrbisElfHandle_t elf)
 			break;
 
 		case orbisElfDynamicTypePreinitArray:
-			elf->preinitArrayAddress = elf->dynamics[i].value;
+			elf->image->preinitArrayAddress = elf->image->dynamics[i].value;
 			break;
 
 		case orbisElfDynamicTypePreinitArraySize:
-			elf->preinitArrayCount = elf->dynamics[i].value / 8;
+			elf->image->preinitArrayCount = elf->image->dynamics[i].value / 8;
 			break;
 
 		case orbisElfDynamicTypeDebug:
 			//TODO
 
-			if (elf->dynamics[i].value)
+			if (elf->image->dynamics[i].value)
 			{
-				printf("orbisElfDynamicTypeDebug with value %lu\n", elf->dynamics[i].value);
+				reportDiagnostic(elf, orbisElfDiagnosticDebugDynamic, elf->image->dynamicsOffset + i * sizeof(OrbisElfDynamic_t), elf->image->dynamics[i].value);
 			}
 			break;
 
 		case orbisElfDynamicTypeTextRel:
 			//TODO
 
-			if (elf->dynamics[i].value)
+			if (elf->image->dynamics[i].value)
 			{
-				printf("orbisElfDynamicTypeDebug with value %lu\n", elf->dynamics[i].value);
+				reportDiagnostic(elf, orbisElfDiagnosticTextRelocations, elf->image->dynamicsOffset + i * sizeof(OrbisElfDynamic_t), elf->image->dynamics[i].value);
 			}
 			break;
 
@@ -403,105 +920,134 @@ static OrbisElfErrorCode_t parseDynamicProgram(OrbisElfHandle_t elf)
 			break;
 
 		default:
-			printf("Unhandled dynamic type 0x%lx\n", elf->dynamics[i].type);
+			reportDiagnostic(elf, orbisElfDiagnosticUnhandledDynamicType, elf->image->dynamicsOffset + i * sizeof(OrbisElfDynamic_t), elf->image->dynamics[i].type);
 			continue;
 		}
 	}
 
-	if (!elf->sceStrTab)
+	/* tables live in the dynlib data segment, everything after parsing indexes them without further checks */
+	if (elf->image->sceDynlibData)
+	{
+		if (((hasTables & 1) && ((symTabOffset & 7) || !isInDynlibData(elf, symTabOffset, elf->image->sceSymTabSize))) ||
+		    ((hasTables & 2) && !isInDynlibData(elf, strTabOffset, elf->image->sceStrTabSize)) ||
+		    ((hasTables & 4) && ((jmpRelOffset & 7) || !isInDynlibData(elf, jmpRelOffset, elf->image->scePltRelSize))) ||
+		    ((hasTables & 8) && ((relaOffset & 7) || !isInDynlibData(elf, relaOffset, elf->image->sceRelaSize))))
+		{
+			return orbisElfErrorCodeCorruptedImage;
+		}
+
+		elf->image->sceSymTab = (hasTables & 1) ? (const OrbisElfSymbolHeader_t *)(elf->image->sceDynlibData + symTabOffset) : NULL;
+		elf->image->sceStrTab = (hasTables & 2) ? elf->image->sceDynlibData + strTabOffset : NULL;
+		elf->image->sceJmpRel = (hasTables & 4) ? (const void *)(elf->image->sceDynlibData + jmpRelOffset) : NULL;
+		elf->image->sceRela = (hasTables & 8) ? (const OrbisElfRela_t *)(elf->image->sceDynlibData + relaOffset) : NULL;
+	}
+
+	if (!elf->image->sceStrTab || !elf->image->sceStrTabSize)
 	{
+		elf->image->sceStrTab = NULL;
 		return orbisElfErrorCodeOk;
 	}
 
-	if (elf->importModulesCount)
+	/* a terminated table makes every in range offset a valid string */
+	if (elf->image->sceStrTab[elf->image->sceStrTabSize - 1] != '\0')
+	{
+		return orbisElfErrorCodeCorruptedImage;
+	}
+
+	if (elf->image->importModulesCount)
 	{
-		elf->importModules = malloc(sizeof(OrbisElfModuleInfo_t) * elf->importModulesCount);
+		elf->image->importModules = allocate(elf, sizeof(OrbisElfModuleInfo_t) * elf->image->importModulesCount);
 
-		if (!elf->importModules)
+		if (!elf->image->importModules)
 		{
 			return orbisElfErrorCodeNoMemory;
 		}
 
-		memset(elf->importModules, 0, sizeof(OrbisElfModuleInfo_t) * elf->importModulesCount);
+		memset(elf->image->importModules, 0, sizeof(OrbisElfModuleInfo_t) * elf->image->importModulesCount);
 	}
 
-	if (elf->importLibrariesCount)
+	if (elf->image->importLibrariesCount)
 	{
-		elf->importLibraries = malloc(sizeof(OrbisElfLibraryInfo_t) * elf->importLibrariesCount);
+		elf->image->importLibraries = allocate(elf, sizeof(OrbisElfLibraryInfo_t) * elf->image->importLibrariesCount);
 
-		if (!elf->importLibraries)
+		if (!elf->image->importLibraries)
 		{
 			return orbisElfErrorCodeNoMemory;
 		}
 
-		memset(elf->importLibraries, 0, sizeof(OrbisElfLibraryInfo_t) * elf->importLibrariesCount);
+		memset(elf->image->importLibraries, 0, sizeof(OrbisElfLibraryInfo_t) * elf->image->importLibrariesCount);
 	}
 
-	if (elf->exportLibrariesCount)
+	if (elf->image->exportLibrariesCount)
 	{
-		elf->exportLibraries = malloc(sizeof(OrbisElfLibraryInfo_t) * elf->exportLibrariesCount);
+		elf->image->exportLibraries = allocate(elf, sizeof(OrbisElfLibraryInfo_t) * elf->image->exportLibrariesCount);
 
-		if (!elf->exportLibraries)
+		if (!elf->image->exportLibraries)
 		{
 			return orbisElfErrorCodeNoMemory;
 		}
 
-		memset(elf->exportLibraries, 0, sizeof(OrbisElfLibraryInfo_t) * elf->exportLibrariesCount);
+		memset(elf->image->exportLibraries, 0, sizeof(OrbisElfLibraryInfo_t) * elf->image->exportLibrariesCount);
 	}
 
 	if (neededCount)
 	{
-		elf->needed = malloc(sizeof(char *) * neededCount);
+		elf->image->needed = allocate(elf, sizeof(char *) * neededCount);
 
-		if (!elf->needed)
+		if (!elf->image->needed)
 		{
 			return orbisElfErrorCodeNoMemory;
 		}
 
-		elf->neededCount = neededCount;
+		elf->image->neededCount = neededCount;
 	}
 
-	for (uint64_t i = 0, moduleIndex = 0, importLibraryIndex = 0, exportLibraryIndex = 0, neededIndex = 0; i < elf->dynamicsCount; ++i)
+	for (uint64_t i = 0, moduleIndex = 0, importLibraryIndex = 0, exportLibraryIndex = 0, neededIndex = 0; i < elf->image->dynamicsCount && elf->image->dynamics[i].type != orbisElfDynamicTypeNull; ++i)
 	{
-		const char *name = elf->sceStrTab + (elf->dynamics[i].value & 0xffffffff);
+		const char *name = getString(elf, elf->image->dynamics[i].value & 0xffffffff);
 
-		switch (elf->dynamics[i].type)
+		if (!name && isStringDynamicType(elf->image->dynamics[i].type))
+		{
+			return orbisElfErrorCodeCorruptedImage;
+		}
+
+		switch (elf->image->dynamics[i].type)
 		{
 		case orbisElfDynamicTypeSoName:
-			elf->soName = name;
+			elf->image->soName = name;
 			break;
 
 		case orbisElfDynamicTypeSceImportLib:
-			elf->importLibraries[importLibraryIndex].id = elf->dynamics[i].value >> 48;
-			elf->importLibraries[importLibraryIndex].version = (elf->dynamics[i].value >> 32) & 0xffff;
-			elf->importLibraries[importLibraryIndex].name = name;
+			elf->image->importLibraries[importLibraryIndex].id = elf->image->dynamics[i].value >> 48;
+			elf->image->importLibraries[importLibraryIndex].version = (elf->image->dynamics[i].value >> 32) & 0xffff;
+			elf->image->importLibraries[importLibraryIndex].name = name;
 			importLibraryIndex++;
 			break;
 
 		case orbisElfDynamicTypeSceExportLib:
-			elf->exportLibraries[exportLibraryIndex].id = elf->dynamics[i].value >> 48;
-			elf->exportLibraries[exportLibraryIndex].version = (elf->dynamics[i].value >> 32) & 0xffff;
-			elf->exportLibraries[exportLibraryIndex].name = name;
+			elf->image->exportLibraries[exportLibraryIndex].id = elf->image->dynamics[i].value >> 48;
+			elf->image->exportLibraries[exportLibraryIndex].version = (elf->image->dynamics[i].value >> 32) & 0xffff;
+			elf->image->exportLibraries[exportLibraryIndex].name = name;
 			exportLibraryIndex++;
 			break;
 
 		case orbisElfDynamicTypeSceNeededModule:
-			elf->importModules[moduleIndex].id = elf->dynamics[i].value >> 48;
-			elf->importModules[moduleIndex].version = (elf->dynamics[i].value >> 32) & 0xffff;
-			elf->importModules[moduleIndex].name = elf->sceStrTab + (elf->dynamics[i].value & 0xffffffff);
+			elf->image->importModules[moduleIndex].id = elf->image->dynamics[i].value >> 48;
+			elf->image->importModules[moduleIndex].version = (elf->image->dynamics[i].value >> 32) & 0xffff;
+			elf->image->importModules[moduleIndex].name = name;
 			moduleIndex++;
 			break;
 
 		case orbisElfDynamicTypeSceModuleInfo:
-			elf->moduleInfo.name = name;
+			elf->image->moduleInfo.name = name;
 			break;
 
 		case orbisElfDynamicTypeSceOriginalFilename:
-			elf->originalFileName = name;
+			elf->image->originalFileName = name;
 			break;
 
 		case orbisElfDynamicTypeNeeded:
-			elf->needed[neededIndex++] = name;
+			elf->image->needed[neededIndex++] = name;
 			break;
 
 
@@ -510,28 +1056,28 @@ static OrbisElfErrorCode_t parseDynamicProgram(OrbisElfHandle_t elf)
 		}
 	}
 
-	if (elf->importLibraries || elf->exportLibraries)
+	if (elf->image->importLibraries || elf->image->exportLibraries)
 	{
-		for (uint64_t i = 0; i < elf->dynamicsCount; ++i)
+		for (uint64_t i = 0; i < elf->image->dynamicsCount; ++i)
 		{
-			switch (elf->dynamics[i].type)
+			switch (elf->image->dynamics[i].type)
 			{
 			case orbisElfDynamicTypeSceImportLibAttr:
-				for (uint64_t libraryIndex = 0; libraryIndex < elf->importLibrariesCount; ++libraryIndex)
+				for (uint64_t libraryIndex = 0; libraryIndex < elf->image->importLibrariesCount; ++libraryIndex)
 				{
-					if (elf->importLibraries[libraryIndex].id == (elf->dynamics[i].value >> 32))
+					if (elf->image->importLibraries[libraryIndex].id == (elf->image->dynamics[i].value >> 32))
 					{
-						elf->importLibraries[libraryIndex].attr = elf->dynamics[i].value & 0xffffffff;
+						elf->image->importLibraries[libraryIndex].attr = elf->image->dynamics[i].value & 0xffffffff;
 					}
 				}
 				break;
 
 			case orbisElfDynamicTypeSceExportLibAttr:
-				for (uint64_t libraryIndex = 0; libraryIndex < elf->exportLibrariesCount; ++libraryIndex)
+				for (uint64_t libraryIndex = 0; libraryIndex < elf->image->exportLibrariesCount; ++libraryIndex)
 				{
-					if (elf->exportLibraries[libraryIndex].id == (elf->dynamics[i].value >> 32))
+					if (elf->image->exportLibraries[libraryIndex].id == (elf->image->dynamics[i].value >> 32))
 					{
-						elf->exportLibraries[libraryIndex].attr = elf->dynamics[i].value & 0xffffffff;
+						elf->image->exportLibraries[libraryIndex].attr = elf->image->dynamics[i].value & 0xffffffff;
 					}
 				}
 				break;
@@ -542,44 +1088,94 @@ static OrbisElfErrorCode_t parseDynamicProgram(OrbisElfHandle_t elf)
 		}
 	}
 
-	return orbisElfErrorCodeOk;
+	return internNames(elf);
+}
+
+static uint32_t hashSymbolName(const char *name)
+{
+	/* FNV-1a */
+	uint64_t hash = 0xcbf29ce484222325ull;
+
+	for (; *name; ++name)
+	{
+		hash = (hash ^ (uint8_t)*name) * 0x100000001b3ull;
+	}
+
+	return (uint32_t)(hash ^ (hash >> 32));
+}
+
+static uint32_t hashLibraryName(const char *name)
+{
+	return hashSymbolName(name) | 1;
+}
+
+static void initHotSymbol(OrbisElfHandle_t elf, uint64_t index)
+{
+	const OrbisElfSymbol_t *symbol = elf->image->symbols + index;
+	OrbisElfHotSymbol_t *hotSymbol = elf->image->hotSymbols + index;
+
+	hotSymbol->nameHash = hashSymbolName(symbol->name);
+	hotSymbol->libraryHash = symbol->library ? hashLibraryName(symbol->library->name) : 0;
+	hotSymbol->moduleIndex = ORBIS_ELF_NO_MODULE;
+	hotSymbol->type = (uint8_t)symbol->type;
+	hotSymbol->bind = (uint8_t)symbol->bind;
+	hotSymbol->isDefined = symbol->header.value != 0;
+
+	if (symbol->module)
+	{
+		hotSymbol->moduleIndex = symbol->module == &elf->image->moduleInfo ? elf->image->importModulesCount : (uint16_t)(symbol->module - elf->image->importModules);
+	}
 }
 
 static OrbisElfErrorCode_t parseSymbols(OrbisElfHandle_t elf)
 {
-	if (!elf->sceStrTab || !elf->sceSymTab || !elf->sceStrTabSize || !elf->sceSymTabSize)
+	if (!elf->image->sceStrTab || !elf->image->sceSymTab || !elf->image->sceStrTabSize || !elf->image->sceSymTabSize)
 	{
 		return orbisElfErrorCodeOk;
 	}
 
-	if (elf->sceSymTabEntrySize != sizeof(OrbisElfSymbolHeader_t))
+	if (elf->image->sceSymTabEntrySize != sizeof(OrbisElfSymbolHeader_t))
 	{
 		return orbisElfErrorCodeInvalidImageFormat;
 	}
 
-	elf->symbolsCount = elf->sceSymTabSize / elf->sceSymTabEntrySize;
+	elf->image->symbolsCount = elf->image->sceSymTabSize / elf->image->sceSymTabEntrySize;
 
-	if (!elf->symbolsCount)
+	if (!elf->image->symbolsCount)
 	{
 		return orbisElfErrorCodeOk;
 	}
 
-	elf->symbols = malloc(sizeof(OrbisElfSymbol_t) * elf->symbolsCount);
+	/* module indexes of the hot symbols are 16 bit */
+	if (elf->image->importModulesCount >= ORBIS_ELF_NO_MODULE)
+	{
+		return orbisElfErrorCodeCorruptedImage;
+	}
+
+	elf->image->symbols = allocate(elf, sizeof(OrbisElfSymbol_t) * elf->image->symbolsCount);
+	elf->image->hotSymbols = allocate(elf, sizeof(OrbisElfHotSymbol_t) * elf->image->symbolsCount);
 
-	if (!elf->symbols)
+	if (!elf->image->symbols || !elf->image->hotSymbols)
 	{
 		return orbisElfErrorCodeNoMemory;
 	}
 
-	memset(elf->symbols, 0, sizeof(OrbisElfSymbol_t) * elf->symbolsCount);
+	memset(elf->image->symbols, 0, sizeof(OrbisElfSymbol_t) * elf->image->symbolsCount);
 
-	for (uint32_t i = 0; i < elf->symbolsCount; ++i)
+	for (uint32_t i = 0; i < elf->image->symbolsCount; ++i)
 	{
-		elf->symbols[i].header = elf->sceSymTab[i];
-		elf->symbols[i].bind = elf->symbols[i].header.info >> 4;
-		elf->symbols[i].type = elf->symbols[i].header.info & 0xf;
+		elf->image->symbols[i].header = elf->image->sceSymTab[i];
+		elf->image->symbols[i].bind = elf->image->symbols[i].header.info >> 4;
+		elf->image->symbols[i].type = elf->image->symbols[i].header.info & 0xf;
+
+		const char *name = getString(elf, elf->image->symbols[i].header.name);
+
+		if (!name)
+		{
+			return orbisElfErrorCodeCorruptedImage;
+		}
 
-		const char *name = elf->sceStrTab + elf->symbols[i].header.name;
+		char shortName[12];
 
 		if (strlen(name) == 15 && name[11] == '#' && name[12] >= 'A' && name[12] <= 'Z' && name[13] == '#' && name[14] >= 'A' && name[14] <= 'Z')
 		{
@@ -588,23 +1184,47 @@ static OrbisElfErrorCode_t parseSymbols(OrbisElfHandle_t elf)
 
 			if (module && library)
 			{
-				char *allocatedName = malloc(12);
-				memcpy(allocatedName, name, 11);
-				allocatedName[11] = '\0';
+				memcpy(shortName, name, 11);
+				shortName[11] = '\0';
+				name = shortName;
+
+				elf->image->symbols[i].module = module;
+				elf->image->symbols[i].library = library;
+			}
+		}
 
-				elf->symbols[i].name = allocatedName;
-				elf->symbols[i].module = module;
-				elf->symbols[i].library = library;
+		/* interned symbol names are shared with every module that imports or exports them */
+		if (elf->image->stringTable)
+		{
+			uint32_t nameId;
+			OrbisElfErrorCode_t errorCode = orbisElfStringTableIntern(elf->image->stringTable, name, &nameId, &elf->image->symbols[i].name);
+
+			if (errorCode != orbisElfErrorCodeOk)
+			{
+				return errorCode;
 			}
 		}
+		else if (name == shortName)
+		{
+			char *allocatedName = allocate(elf, 12);
 
-		if (elf->symbols[i].name == NULL)
+			if (!allocatedName)
+			{
+				return orbisElfErrorCodeNoMemory;
+			}
+
+			memcpy(allocatedName, shortName, 12);
+			elf->image->symbols[i].name = allocatedName;
+		}
+		else
 		{
-			elf->symbols[i].name = name;
+			elf->image->symbols[i].name = name;
 		}
+
+		initHotSymbol(elf, i);
 	}
 
-	return orbisElfErrorCodeOk;
+	return initBindings(elf, allocate);
 }
 
 static OrbisElfErrorCode_t parseRelocations(OrbisElfHandle_t elf)
@@ -613,20 +1233,40 @@ static OrbisElfErrorCode_t parseRelocations(OrbisElfHandle_t elf)
 	int importsCount = 0;
 	int tlsCount = 0;
 
-	for (uint64_t i = 0, count = elf->sceRelaSize / elf->sceRelaEntSize; i < count; ++i)
+	if (!elf->image->sceRela)
+	{
+		elf->image->sceRelaSize = 0;
+	}
+	else if (elf->image->sceRelaEntSize != sizeof(OrbisElfRela_t))
+	{
+		return orbisElfErrorCodeInvalidImageFormat;
+	}
+
+	if (!elf->image->sceJmpRel)
 	{
-		uint32_t symbolIndex = elf->sceRela[i].info >> 32;
-		uint32_t relType = elf->sceRela[i].info & 0xffffffff;
+		elf->image->scePltRelSize = 0;
+	}
+	else if (elf->image->scePltRelSize && elf->image->scePltRelType != orbisElfDynamicTypeRela && elf->image->scePltRelType != orbisElfDynamicTypeRel)
+	{
+		return orbisElfErrorCodeInvalidImageFormat;
+	}
+
+	/* the first pass rejects symbol indexes out of the symbol table, so the second one indexes it directly */
+	for (uint64_t i = 0, count = elf->image->sceRelaSize / sizeof(OrbisElfRela_t); i < count; ++i)
+	{
+		uint32_t symbolIndex = elf->image->sceRela[i].info >> 32;
+		uint32_t relType = elf->image->sceRela[i].info & 0xffffffff;
 
 		if (relType == orbisElfRelocationTypeNone)
 		{
 			continue;
 		}
 
+		countRelocation(elf, relType);
+
 		switch (relType)
 		{
 		case orbisElfRelocationTypeRelative:
-			assert(elf->sceRela[i].addend);
 			++rebaseCount;
 			break;
 
@@ -637,7 +1277,12 @@ static OrbisElfErrorCode_t parseRelocations(OrbisElfHandle_t elf)
 			break;
 
 		case orbisElfRelocationType64:
-			if (orbisElfGetSymbol(elf, symbolIndex)->header.value)
+			if (symbolIndex >= elf->image->symbolsCount)
+			{
+				return orbisElfErrorCodeCorruptedImage;
+			}
+
+			if (elf->image->symbols[symbolIndex].header.value)
 			{
 				++rebaseCount;
 			}
@@ -648,27 +1293,32 @@ static OrbisElfErrorCode_t parseRelocations(OrbisElfHandle_t elf)
 			break;
 
 		default:
-			assert(orbisElfGetSymbol(elf, symbolIndex)->header.value == 0);
+			if (symbolIndex >= elf->image->symbolsCount)
+			{
+				return orbisElfErrorCodeCorruptedImage;
+			}
+
 			++importsCount;
 			break;
 		}
 	}
 
-	switch (elf->scePltRelType)
+	switch (elf->image->scePltRelType)
 	{
 	case orbisElfDynamicTypeRela:
 	{
-		const OrbisElfRela_t *rela = (OrbisElfRela_t *)elf->sceJmpRel;
+		const OrbisElfRela_t *rela = (OrbisElfRela_t *)elf->image->sceJmpRel;
 
-		for (uint64_t i = 0, count = elf->scePltRelSize / sizeof(OrbisElfRela_t); i < count; ++i)
+		for (uint64_t i = 0, count = elf->image->scePltRelSize / sizeof(OrbisElfRela_t); i < count; ++i)
 		{
-			if ((rela[i].info & 0xffffffff) != orbisElfRelocationTypeJumpSlot)
+			if ((rela[i].info & 0xffffffff) != orbisElfRelocationTypeJumpSlot || (rela[i].info >> 32) >= elf->image->symbolsCount)
 			{
-				assert(0);
-				continue;
+				return orbisElfErrorCodeCorruptedImage;
 			}
 
-			if (!orbisElfGetSymbol(elf, rela[i].info >> 32)->header.value)
+			countRelocation(elf, orbisElfRelocationTypeJumpSlot);
+
+			if (!elf->image->symbols[rela[i].info >> 32].header.value)
 			{
 				++importsCount;
 			}
@@ -682,17 +1332,18 @@ static OrbisElfErrorCode_t parseRelocations(OrbisElfHandle_t elf)
 
 	case orbisElfDynamicTypeRel:
 	{
-		const OrbisElfRel_t *rel = (OrbisElfRel_t *)elf->sceJmpRel;
+		const OrbisElfRel_t *rel = (OrbisElfRel_t *)elf->image->sceJmpRel;
 
-		for (uint64_t i = 0, count = elf->scePltRelSize / sizeof(OrbisElfRel_t); i < count; ++i)
+		for (uint64_t i = 0, count = elf->image->scePltRelSize / sizeof(OrbisElfRel_t); i < count; ++i)
 		{
-			if ((rel[i].info & 0xffffffff) != orbisElfRelocationTypeJumpSlot)
+			if ((rel[i].info & 0xffffffff) != orbisElfRelocationTypeJumpSlot || (rel[i].info >> 32) >= elf->image->symbolsCount)
 			{
-				assert(0);
-				continue;
+				return orbisElfErrorCodeCorruptedImage;
 			}
 
-			if (!orbisElfGetSymbol(elf, rel[i].info >> 32)->header.value)
+			countRelocation(elf, orbisElfRelocationTypeJumpSlot);
+
+			if (!elf->image->symbols[rel[i].info >> 32].header.value)
 			{
 				++importsCount;
 			}
@@ -705,40 +1356,45 @@ static OrbisElfErrorCode_t parseRelocations(OrbisElfHandle_t elf)
 	}
 
 	default:
-		assert(0);
+		break;
 	}
 
-	elf->rebaseRelocationsCount = rebaseCount;
-	elf->rebaseRelocations = malloc(sizeof(OrbisElfRebaseRelocation_t) * elf->rebaseRelocationsCount);
+	elf->image->rebaseRelocationsCount = rebaseCount;
+	elf->image->rebaseRelocations = allocate(elf, sizeof(OrbisElfRebaseRelocation_t) * elf->image->rebaseRelocationsCount);
 
-	elf->importRelocationsCount = importsCount;
-	elf->importRelocations = malloc(sizeof(OrbisElfRelocation_t) * elf->importRelocationsCount);
+	elf->image->importRelocationsCount = importsCount;
+	elf->image->importRelocations = allocate(elf, sizeof(OrbisElfRelocation_t) * elf->image->importRelocationsCount);
 
-	elf->tlsRelocationsCount = tlsCount;
-	elf->tlsRelocations = malloc(sizeof(OrbisElfRelocation_t) * elf->tlsRelocationsCount);
+	elf->image->tlsRelocationsCount = tlsCount;
+	elf->image->tlsRelocations = allocate(elf, sizeof(OrbisElfRelocation_t) * elf->image->tlsRelocationsCount);
+
+	if ((rebaseCount && !elf->image->rebaseRelocations) || (importsCount && !elf->image->importRelocations) || (tlsCount && !elf->image->tlsRelocations))
+	{
+		return orbisElfErrorCodeNoMemory;
+	}
 
-	OrbisElfRebaseRelocation_t *rebaseIt = elf->rebaseRelocations;
-	OrbisElfRelocation_t *importIt = elf->importRelocations;
-	OrbisElfRelocation_t *tlsIt = elf->tlsRelocations;
+	OrbisElfRebaseRelocation_t *rebaseIt = elf->image->rebaseRelocations;
+	OrbisElfRelocation_t *importIt = elf->image->importRelocations;
+	OrbisElfRelocation_t *tlsIt = elf->image->tlsRelocations;
 
-	for (uint64_t i = 0, count = elf->sceRelaSize / elf->sceRelaEntSize; i < count; ++i)
+	for (uint64_t i = 0, count = elf->image->sceRelaSize / sizeof(OrbisElfRela_t); i < count; ++i)
 	{
-		uint32_t symbolIndex = elf->sceRela[i].info >> 32;
-		uint32_t relType = elf->sceRela[i].info & 0xffffffff;
+		uint32_t symbolIndex = elf->image->sceRela[i].info >> 32;
+		uint32_t relType = elf->image->sceRela[i].info & 0xffffffff;
 
 		if (relType == orbisElfRelocationTypeNone)
 		{
 			continue;
 		}
 
-		const OrbisElfSymbol_t *sym = orbisElfGetSymbol(elf, symbolIndex);
+		const OrbisElfSymbol_t *sym = orbisElfGetSymbol(elf, symbolIndex); /* NULL only for relocations that don't use it */
 
 
 		switch (relType)
 		{
 		case orbisElfRelocationTypeRelative:
-			rebaseIt->offset = elf->sceRela[i].offset;
-			rebaseIt->value = elf->sceRela[i].addend;
+			rebaseIt->offset = elf->image->sceRela[i].offset;
+			rebaseIt->value = elf->image->sceRela[i].addend;
 			rebaseIt->symbolIndex = symbolIndex;
 
 			++rebaseIt;
@@ -747,10 +1403,10 @@ static OrbisElfErrorCode_t parseRelocations(OrbisElfHandle_t elf)
 		case orbisElfRelocationTypeDtpMod64:
 		case orbisElfRelocationTypeTpOff64:
 		case orbisElfRelocationTypeTpOff32:
-			tlsIt->offset = elf->sceRela[i].offset;
+			tlsIt->offset = elf->image->sceRela[i].offset;
 			tlsIt->symbolIndex = symbolIndex;
 			tlsIt->relType = relType;
-			tlsIt->addend = elf->sceRela[i].addend;
+			tlsIt->addend = elf->image->sceRela[i].addend;
 
 			++tlsIt;
 			break;
@@ -758,7 +1414,7 @@ static OrbisElfErrorCode_t parseRelocations(OrbisElfHandle_t elf)
 		case orbisElfRelocationType64:
 			if (sym->header.value)
 			{
-				rebaseIt->offset = elf->sceRela[i].offset;
+				rebaseIt->offset = elf->image->sceRela[i].offset;
 				rebaseIt->value = sym->header.value;
 				rebaseIt->symbolIndex = symbolIndex;
 
@@ -766,38 +1422,38 @@ static OrbisElfErrorCode_t parseRelocations(OrbisElfHandle_t elf)
 			}
 			else
 			{
-				importIt->offset = elf->sceRela[i].offset;
+				importIt->offset = elf->image->sceRela[i].offset;
 				importIt->symbolIndex = symbolIndex;
 				importIt->relType = relType;
-				importIt->addend = elf->sceRela[i].addend;
+				importIt->addend = elf->image->sceRela[i].addend;
 
 				++importIt;
 			}
 			break;
 
 		default:
-			importIt->offset = elf->sceRela[i].offset;
+			importIt->offset = elf->image->sceRela[i].offset;
 			importIt->symbolIndex = symbolIndex;
 			importIt->relType = relType;
-			importIt->addend = elf->sceRela[i].addend;
+			importIt->addend = elf->image->sceRela[i].addend;
 
 			++importIt;
 			break;
 		}
 	}
 
-	switch (elf->scePltRelType)
+	switch (elf->image->scePltRelType)
 	{
 	case orbisElfDynamicTypeRela:
 	{
-		const OrbisElfRela_t *rela = (OrbisElfRela_t *)elf->sceJmpRel;
+		const OrbisElfRela_t *rela = (OrbisElfRela_t *)elf->image->sceJmpRel;
 
-		for (uint64_t i = 0, count = elf->scePltRelSize / sizeof(OrbisElfRela_t); i < count; ++i)
+		for (uint64_t i = 0, count = elf->image->scePltRelSize / sizeof(OrbisElfRela_t); i < count; ++i)
 		{
 			uint32_t symbolIndex = rela[i].info >> 32;
-			const OrbisElfSymbol_t *sym = elf->symbols + symbolIndex;
+			const OrbisElfSymbol_t *sym = elf->image->symbols + symbolIndex;
 
-			if (!orbisElfGetSymbol(elf, symbolIndex)->header.value)
+			if (!sym->header.value)
 			{
 				importIt->offset = rela[i].offset;
 				importIt->symbolIndex = symbolIndex;
@@ -820,14 +1476,14 @@ static OrbisElfErrorCode_t parseRelocations(OrbisElfHandle_t elf)
 
 	case orbisElfDynamicTypeRel:
 	{
-		const OrbisElfRel_t *rel = (OrbisElfRel_t *)elf->sceJmpRel;
+		const OrbisElfRel_t *rel = (OrbisElfRel_t *)elf->image->sceJmpRel;
 
-		for (uint64_t i = 0, count = elf->scePltRelSize / sizeof(OrbisElfRel_t); i < count; ++i)
+		for (uint64_t i = 0, count = elf->image->scePltRelSize / sizeof(OrbisElfRel_t); i < count; ++i)
 		{
 			uint32_t symbolIndex = rel[i].info >> 32;
-			const OrbisElfSymbol_t *sym = elf->symbols + symbolIndex;
+			const OrbisElfSymbol_t *sym = elf->image->symbols + symbolIndex;
 
-			if (!orbisElfGetSymbol(elf, symbolIndex)->header.value)
+			if (!sym->header.value)
 			{
 				importIt->offset = rel[i].offset;
 				importIt->symbolIndex = symbolIndex;
@@ -855,6 +1511,113 @@ static OrbisElfErrorCode_t parseRelocations(OrbisElfHandle_t elf)
 	return orbisElfErrorCodeOk;
 }
 
+static int isInLoadedImage(OrbisElfHandle_t elf, uint64_t address, uint64_t size)
+{
+	return address <= elf->image->loadSize && size <= elf->image->loadSize - address;
+}
+
+static int isArrayInLoadedImage(OrbisElfHandle_t elf, uint64_t address, uint64_t count)
+{
+	return count <= elf->image->loadSize / 8 && isInLoadedImage(elf, address, count * 8);
+}
+
+/* branchless, so scans over large relocation tables vectorize, returns nonzero when any relocation is out of range */
+static uint64_t checkRelocations(const OrbisElfRelocation_t *relocations, uint64_t count, uint64_t loadSize, uint64_t symbolsCount, uint64_t allowedTypes)
+{
+	uint64_t invalid = 0;
+
+	for (uint64_t i = 0; i < count; ++i)
+	{
+		uint64_t relType = relocations[i].relType;
+		uint64_t size = 8 - 4 * ((relType == orbisElfRelocationTypePc32) | (relType == orbisElfRelocationTypeTpOff32) | (relType == orbisElfRelocationTypeDtpOff32));
+
+		invalid |= (relocations[i].offset > loadSize) | (size > loadSize - relocations[i].offset);
+		invalid |= relocations[i].symbolIndex >= symbolsCount;
+		invalid |= (relType > 63) | (~(allowedTypes >> (relType & 63)) & 1);
+	}
+
+	return invalid;
+}
+
+static uint64_t checkRebaseRelocations(const OrbisElfRebaseRelocation_t *relocations, uint64_t count, uint64_t loadSize)
+{
+	uint64_t invalid = 0;
+
+	for (uint64_t i = 0; i < count; ++i)
+	{
+		invalid |= (relocations[i].offset > loadSize) | (8 > loadSize - relocations[i].offset) | (relocations[i].value > loadSize);
+	}
+
+	return invalid;
+}
+
+/* one time check of everything the getters and relocation queries index, after it unchecked access is safe */
+static OrbisElfErrorCode_t validateImage(OrbisElfHandle_t elf)
+{
+	const OrbisElfImage_t *image = elf->image;
+
+	for (uint16_t i = 0; i < image->programsCount; ++i)
+	{
+		const OrbisElfProgramHeader_t *program = image->programs + i;
+
+		if (program->type != orbisElfProgramTypeLoad && program->type != orbisElfProgramTypeSceRelRo)
+		{
+			continue;
+		}
+
+		if (program->filesz > program->memsz || program->filesz > image->imageSize || program->offset > image->imageSize - program->filesz ||
+		    !isInLoadedImage(elf, program->vaddr, program->memsz))
+		{
+			return orbisElfErrorCodeCorruptedImage;
+		}
+	}
+
+	if ((image->header.entry && !isInLoadedImage(elf, image->header.entry, 1)) ||
+	    (image->initAddress && !isInLoadedImage(elf, image->initAddress, 1)) ||
+	    (image->finiAddress && !isInLoadedImage(elf, image->finiAddress, 1)) ||
+	    (image->sceProcParam && !isInLoadedImage(elf, image->sceProcParam, image->sceProcParamSize)) ||
+	    (image->tlsInitSize && !isInLoadedImage(elf, image->tlsInitAddress, image->tlsInitSize)) ||
+	    !isArrayInLoadedImage(elf, image->preinitArrayAddress, image->preinitArrayCount) ||
+	    !isArrayInLoadedImage(elf, image->initArrayAddress, image->initArrayCount) ||
+	    !isArrayInLoadedImage(elf, image->finiArrayAddress, image->finiArrayCount))
+	{
+		return orbisElfErrorCodeCorruptedImage;
+	}
+
+	for (uint64_t i = 0; i < image->symbolsCount; ++i)
+	{
+		uint64_t limit = image->symbols[i].type == orbisElfSymbolTypeTls ? image->tlsSize : image->loadSize;
+
+		if (image->symbols[i].header.value > limit)
+		{
+			return orbisElfErrorCodeCorruptedImage;
+		}
+	}
+
+	uint64_t importTypes = (1ull << orbisElfRelocationType64) | (1ull << orbisElfRelocationTypePc32) | (1ull << orbisElfRelocationTypeGlobDat) |
+		(1ull << orbisElfRelocationTypeJumpSlot) | (1ull << orbisElfRelocationTypeDtpOff64) | (1ull << orbisElfRelocationTypeDtpOff32);
+	uint64_t tlsTypes = (1ull << orbisElfRelocationTypeDtpMod64) | (1ull << orbisElfRelocationTypeTpOff64) | (1ull << orbisElfRelocationTypeTpOff32);
+
+	if (checkRebaseRelocations(image->rebaseRelocations, image->rebaseRelocationsCount, image->loadSize) ||
+	    checkRelocations(image->importRelocations, image->importRelocationsCount, image->loadSize, image->symbolsCount, importTypes) ||
+	    checkRelocations(image->tlsRelocations, image->tlsRelocationsCount, image->loadSize, image->symbolsCount, tlsTypes))
+	{
+		return orbisElfErrorCodeCorruptedImage;
+	}
+
+	elf->image->isValidated = 1;
+	return orbisElfErrorCodeOk;
+}
+
+static OrbisElfErrorCode_t loadPrograms(OrbisElfHandle_t elf, void *baseAddress, uint64_t virtualBaseAddress);
+static OrbisElfErrorCode_t importModule(OrbisElfHandle_t elf, OrbisElfHandle_t importElf);
+static OrbisElfErrorCode_t setImportSymbol(OrbisElfHandle_t elf, const char *moduleName, const char *libraryName, const char *symbolName, uint64_t virtualBaseAddress, uint64_t value, uint64_t size);
+static const OrbisElfSymbolRelocationIndex_t *getSymbolRelocationIndex(OrbisElfHandle_t elf);
+static OrbisElfErrorCode_t parseSections(OrbisElfHandle_t elf);
+static OrbisElfErrorCode_t rebindSymbol(OrbisElfHandle_t elf, uint64_t symbolIndex, OrbisElfHandle_t module, uint64_t virtualBaseAddress, uint64_t value, uint64_t size);
+static uint64_t getSectionTableSize(OrbisElfHandle_t elf);
+static OrbisElfErrorCode_t getFdeTable(OrbisElfHandle_t elf, const OrbisElfFdeTable_t **result);
+
 OrbisElfErrorCode_t orbisElfValidate(const void *image, size_t imageSize, OrbisElfType_t expectedType);
 OrbisElfErrorCode_t orbisElfParse(OrbisElfHandle_t *handle, OrbisElfReadCallback_t readImageCallback, size_t imageSize, void *readImageUserData);
 OrbisElfErrorCode_t orbisElfLoad(OrbisElfHandle_t elf, void *baseAddress, uint64_t virtualBaseAddress);
@@ -898,577 +1661,2711 @@ OrbisElfErrorCode_t orbisElfValidate(const void *image, size_t imageSize, OrbisE
 
 OrbisElfErrorCode_t orbisElfParse(OrbisElfHandle_t *handle, OrbisElfReadCallback_t readImageCallback, size_t imageSize, void *readImageUserData)
 {
-	OrbisElfErrorCode_t errorCode;
+	return orbisElfParseWithOptions(handle, readImageCallback, imageSize, readImageUserData, NULL);
+}
 
-	if (imageSize < sizeof(OrbisElfHeader_t))
+static void initHandle(OrbisElfHandle_t elf, OrbisElfImage_t *image, OrbisElfReadCallback_t readImageCallback, size_t imageSize, void *readImageUserData, const OrbisElfParseOptions_t *options)
+{
+	memset(elf, 0, sizeof(OrbisElf_t));
+	memset(image, 0, sizeof(OrbisElfImage_t));
+	atomic_init(&elf->bindingsSequence, 0);
+	atomic_init(&image->handlesCount, 1);
+	atomic_init(&image->symbolRelocationIndex, NULL);
+	atomic_init(&image->pageRelocationIndex, NULL);
+	atomic_init(&image->sectionTable, NULL);
+	atomic_init(&image->fdeTable, NULL);
+	atomic_init(&image->addressIndex, NULL);
+
+	for (int i = 0; i < orbisElfDiagnosticCount; ++i)
 	{
-		return orbisElfErrorCodeInvalidImageFormat;
+		atomic_init(&elf->diagnostics[i], 0);
 	}
 
-	OrbisElfHandle_t elf = malloc(sizeof(OrbisElf_t));
-		
-	if (!elf)
-	{
-		return orbisElfErrorCodeNoMemory;
-	}
-		
-	memset(elf, 0, sizeof(OrbisElf_t));
+	elf->image = image;
+	atomic_init(&elf->referencesCount, 1);
 	elf->read = readImageCallback;
 	elf->readUserData = readImageUserData;
-	elf->imageSize = imageSize;
-	
-	if (orbisElfRead(elf, 0, &elf->header, sizeof(OrbisElfHeader_t)) != sizeof(OrbisElfHeader_t))
+	elf->image->imageSize = imageSize;
+	elf->image->requiredSize = ORBIS_ELF_ALIGN_ALLOCATION(sizeof(OrbisElf_t)) + ORBIS_ELF_ALIGN_ALLOCATION(sizeof(OrbisElfImage_t));
+
+	if (options)
 	{
-		orbisElfDestroy(elf);
-		return orbisElfErrorCodeIoError;
+		elf->parseFlags = options->flags;
+		elf->traceCallback = options->traceCallback;
+		elf->traceUserData = options->traceUserData;
+		elf->diagnosticCallback = options->diagnosticCallback;
+		elf->diagnosticUserData = options->diagnosticUserData;
+		elf->image->stringTable = options->stringTable;
+
+		if (options->allocator)
+		{
+			elf->image->allocator = *options->allocator;
+		}
 	}
-	
-	*handle = elf;
 
-	int isOk = 1;
-	isOk = isOk && (errorCode = parsePrograms(elf)) == orbisElfErrorCodeOk;
-	isOk = isOk && (errorCode = parseSections(elf)) == orbisElfErrorCodeOk;
-	isOk = isOk && (errorCode = parseDynamicProgram(elf)) == orbisElfErrorCodeOk;
-	isOk = isOk && (errorCode = parseSymbols(elf)) == orbisElfErrorCodeOk;
-	isOk = isOk && (errorCode = parseRelocations(elf)) == orbisElfErrorCodeOk;
-	
-	return isOk ? orbisElfErrorCodeOk : errorCode;
+	if (elf->parseFlags & orbisElfParseFlagCollectStats)
+	{
+		elf->stats.allocations = 2;
+		elf->stats.allocatedBytes = sizeof(OrbisElf_t) + sizeof(OrbisElfImage_t);
+	}
 }
 
-OrbisElfErrorCode_t orbisElfLoad(OrbisElfHandle_t elf, void *baseAddress, uint64_t virtualBaseAddress)
+static OrbisElfErrorCode_t parseImage(OrbisElfHandle_t elf)
 {
-	elf->virtualBaseAddress = virtualBaseAddress ? virtualBaseAddress : (uint64_t)baseAddress;
-	elf->baseAddress = baseAddress;
+	OrbisElfErrorCode_t errorCode;
+
+	int isOk = 1;
+	isOk = isOk && (errorCode = runParsePhase(elf, orbisElfPhaseParsePrograms, parsePrograms)) == orbisElfErrorCodeOk;
 
-	for (uint64_t i = 0; i < elf->symbolsCount; ++i)
+	if (elf->parseFlags & orbisElfParseFlagEagerIndexes)
 	{
-		elf->symbols[i].virtualBaseAddress = elf->virtualBaseAddress;
+		isOk = isOk && (errorCode = runParsePhase(elf, orbisElfPhaseParseSections, parseSections)) == orbisElfErrorCodeOk;
 	}
 
-	for (uint16_t i = 0; i < elf->programsCount; ++i)
+	isOk = isOk && (errorCode = runParsePhase(elf, orbisElfPhaseParseDynamicProgram, parseDynamicProgram)) == orbisElfErrorCodeOk;
+	isOk = isOk && (errorCode = runParsePhase(elf, orbisElfPhaseParseSymbols, parseSymbols)) == orbisElfErrorCodeOk;
+	isOk = isOk && (errorCode = runParsePhase(elf, orbisElfPhaseParseRelocations, parseRelocations)) == orbisElfErrorCodeOk;
+
+	if (elf->parseFlags & orbisElfParseFlagValidate)
 	{
-		if (elf->programs[i].type == orbisElfProgramTypeLoad || elf->programs[i].type == orbisElfProgramTypeSceRelRo)
-		{
-			if (elf->programs[i].offset + elf->programs[i].filesz > elf->imageSize)
-			{
-				return orbisElfErrorCodeCorruptedImage;
-			}
-			
-			if (orbisElfRead(elf, elf->programs[i].offset, (char *)baseAddress + elf->programs[i].vaddr, elf->programs[i].filesz)
-			    != elf->programs[i].filesz)
-			{
-				return orbisElfErrorCodeIoError;
-			}
-		}
+		isOk = isOk && (errorCode = runParsePhase(elf, orbisElfPhaseValidate, validateImage)) == orbisElfErrorCodeOk;
 	}
 
-	return orbisElfErrorCodeOk;
+	/* with interned names nothing points into the dynlib data after parsing, symbols and relocations are copied out of it */
+	if (isOk && elf->image->stringTable)
+	{
+		elfFree(elf, elf->image->sceDynlibData);
+		elf->image->sceDynlibData = NULL;
+		elf->image->sceDynlibDataSize = 0;
+		elf->image->sceSymTab = NULL;
+		elf->image->sceStrTab = NULL;
+		elf->image->sceJmpRel = NULL;
+		elf->image->sceRela = NULL;
+	}
+	
+	return isOk ? orbisElfErrorCodeOk : errorCode;
 }
 
-OrbisElfErrorCode_t orbisElfImportModule(OrbisElfHandle_t elf, OrbisElfHandle_t importElf)
+OrbisElfErrorCode_t orbisElfParseWithOptions(OrbisElfHandle_t *handle, OrbisElfReadCallback_t readImageCallback, size_t imageSize, void *readImageUserData, const OrbisElfParseOptions_t *options)
 {
-	for (uint64_t importSymbolIndex = 0; importSymbolIndex < elf->symbolsCount; ++importSymbolIndex)
+	if (imageSize < sizeof(OrbisElfHeader_t))
 	{
-		if (!elf->symbols[importSymbolIndex].module || !elf->symbols[importSymbolIndex].library)
-		{
-			continue;
-		}
+		return orbisElfErrorCodeInvalidImageFormat;
+	}
+
+	OrbisElfAllocator_t allocator = { NULL, NULL, NULL };
+
+	if (options && options->allocator)
+	{
+		allocator = *options->allocator;
+	}
 
-		if (elf->symbols[importSymbolIndex].type == orbisElfSymbolBindLocal)
+	OrbisElfHandle_t elf = allocatorAlloc(&allocator, sizeof(OrbisElf_t));
+	OrbisElfImage_t *image = allocatorAlloc(&allocator, sizeof(OrbisElfImage_t));
+		
+	if (!elf || !image)
+	{
+		if (elf)
 		{
-			continue;
+			allocatorFree(&allocator, elf);
 		}
 
-		if (elf->symbols[importSymbolIndex].header.value && elf->symbols[importSymbolIndex].type != orbisElfSymbolBindWeak)
+		if (image)
 		{
-			continue;
+			allocatorFree(&allocator, image);
 		}
 
-		if (strcmp(elf->symbols[importSymbolIndex].module->name, importElf->moduleInfo.name) != 0)
+		return orbisElfErrorCodeNoMemory;
+	}
+		
+	initHandle(elf, image, readImageCallback, imageSize, readImageUserData, options);
+	
+	if (orbisElfRead(elf, 0, &elf->image->header, sizeof(OrbisElfHeader_t)) != sizeof(OrbisElfHeader_t))
+	{
+		orbisElfDestroy(elf);
+		return orbisElfErrorCodeIoError;
+	}
+	
+	*handle = elf;
+	return parseImage(elf);
+}
+
+/* counts of the dynamic table entries that size parse storage */
+typedef struct
+{
+	uint64_t importModulesCount;
+	uint64_t librariesCount;
+	uint64_t neededCount;
+	uint64_t symTabSize;
+	uint64_t symTabEntrySize;
+	uint64_t strTabSize;
+	uint64_t relaSize;
+	uint64_t pltRelSize;
+	int64_t pltRelType;
+	int hasTables; /* bits for symtab, strtab, jmprel, rela as in parseDynamicProgram */
+} OrbisElfDynamicCounts_t;
+
+static OrbisElfErrorCode_t countDynamics(OrbisElfHandle_t elf, uint64_t offset, uint64_t count, OrbisElfDynamicCounts_t *counts)
+{
+	OrbisElfDynamic_t dynamics[64];
+
+	memset(counts, 0, sizeof(OrbisElfDynamicCounts_t));
+	counts->symTabEntrySize = sizeof(OrbisElfSymbolHeader_t);
+
+	for (uint64_t i = 0; i < count; i += 64)
+	{
+		uint64_t chunkCount = count - i < 64 ? count - i : 64;
+
+		if (orbisElfRead(elf, offset + i * sizeof(OrbisElfDynamic_t), dynamics, chunkCount * sizeof(OrbisElfDynamic_t)) != chunkCount * sizeof(OrbisElfDynamic_t))
 		{
-			continue;
+			return orbisElfErrorCodeIoError;
 		}
 
-		for (uint64_t exportSymbolIndex = 0; exportSymbolIndex < importElf->symbolsCount; ++exportSymbolIndex)
+		for (uint64_t j = 0; j < chunkCount; ++j)
 		{
-			if (!importElf->symbols[exportSymbolIndex].library || !importElf->symbols[exportSymbolIndex].header.value)
+			switch (dynamics[j].type)
 			{
-				continue;
-			}
+			case orbisElfDynamicTypeNull:
+				return orbisElfErrorCodeOk;
 
-			if (importElf->symbols[exportSymbolIndex].type == orbisElfSymbolBindLocal)
-			{
-				continue;
-			}
+			case orbisElfDynamicTypeSceImportLib:
+			case orbisElfDynamicTypeSceExportLib:
+				counts->librariesCount++;
+				break;
 
-			if (elf->symbols[importSymbolIndex].header.value && importElf->symbols[exportSymbolIndex].type != orbisElfSymbolBindGlobal)
-			{
-				continue;
-			}
+			case orbisElfDynamicTypeSceNeededModule:
+				counts->importModulesCount++;
+				break;
 
-			if (elf->symbols[importSymbolIndex].type != importElf->symbols[exportSymbolIndex].type)
-			{
-				continue;
-			}
+			case orbisElfDynamicTypeNeeded:
+				counts->neededCount++;
+				break;
 
-			if (strcmp(elf->symbols[importSymbolIndex].library->name, importElf->symbols[exportSymbolIndex].library->name) != 0)
-			{
-				continue;
-			}
+			case orbisElfDynamicTypeSceSymTab:
+				counts->hasTables |= 1;
+				break;
 
-			if (strcmp(elf->symbols[importSymbolIndex].name, importElf->symbols[exportSymbolIndex].name) != 0)
-			{
-				continue;
-			}
+			case orbisElfDynamicTypeSceStrTab:
+				counts->hasTables |= 2;
+				break;
 
-			elf->symbols[importSymbolIndex].header.value = importElf->symbols[exportSymbolIndex].header.value;
-			elf->symbols[importSymbolIndex].header.size = importElf->symbols[exportSymbolIndex].header.size;
-			elf->symbols[importSymbolIndex].virtualBaseAddress = importElf->virtualBaseAddress;
-			break;
+			case orbisElfDynamicTypeSceJmpRel:
+				counts->hasTables |= 4;
+				break;
+
+			case orbisElfDynamicTypeSceRela:
+				counts->hasTables |= 8;
+				break;
+
+			case orbisElfDynamicTypeSceSymEnt:
+				counts->symTabEntrySize = dynamics[j].value;
+				break;
+
+			case orbisElfDynamicTypeSceSymTabSize:
+				counts->symTabSize = dynamics[j].value;
+				break;
+
+			case orbisElfDynamicTypeSceStrSize:
+				counts->strTabSize = dynamics[j].value;
+				break;
+
+			case orbisElfDynamicTypeSceRelaSize:
+				counts->relaSize = dynamics[j].value;
+				break;
+
+			case orbisElfDynamicTypeScePltRelSize:
+				counts->pltRelSize = dynamics[j].value;
+				break;
+
+			case orbisElfDynamicTypeScePltRel:
+				counts->pltRelType = dynamics[j].value;
+				break;
+
+			default:
+				break;
+			}
 		}
 	}
 
 	return orbisElfErrorCodeOk;
 }
 
-OrbisElfErrorCode_t orbisElfSetImportSymbol(OrbisElfHandle_t elf, const char *moduleName, const char *libraryName, const char *symbolName, uint64_t virtualBaseAddress, uint64_t value, uint64_t size)
+/*
+ * Upper bound of what parseImage allocates, from the program headers, the dynamic table and the prelink trailer only. Tables
+ * whose size parsing derives from their content (renamed symbols, the split of the relocations) are counted at their largest.
+ */
+static OrbisElfErrorCode_t countParseSize(OrbisElfHandle_t elf, uint64_t *size)
 {
-	for (uint64_t importSymbolIndex = 0; importSymbolIndex < elf->symbolsCount; ++importSymbolIndex)
+	OrbisElfImage_t *image = elf->image;
+	uint64_t total = image->requiredSize;
+	uint64_t dynamicOffset = 0;
+	uint64_t dynamicSize = 0;
+	uint64_t dynlibDataSize = 0;
+
+	if (image->header.phentsize != sizeof(OrbisElfProgramHeader_t))
 	{
-		if (!elf->symbols[importSymbolIndex].module || !elf->symbols[importSymbolIndex].library)
-		{
-			continue;
-		}
+		return orbisElfErrorCodeCorruptedImage;
+	}
+
+	total += ORBIS_ELF_ALIGN_ALLOCATION(sizeof(OrbisElfProgramHeader_t) * image->header.phnum);
+
+	for (uint16_t i = 0; i < image->header.phnum; ++i)
+	{
+		OrbisElfProgramHeader_t program;
 
-		if (strcmp(elf->symbols[importSymbolIndex].module->name, moduleName) != 0)
+		if (orbisElfRead(elf, image->header.phoff + sizeof(program) * i, &program, sizeof(program)) != sizeof(program))
 		{
-			continue;
+			return orbisElfErrorCodeIoError;
 		}
 
-		if (strcmp(elf->symbols[importSymbolIndex].library->name, libraryName) != 0)
+		if (program.type != orbisElfProgramTypeDynamic && program.type != orbisElfProgramTypeSceDynlibData)
 		{
 			continue;
 		}
 
-		if (strcmp(elf->symbols[importSymbolIndex].name, symbolName) != 0)
+		if (program.filesz > image->imageSize)
 		{
-			continue;
+			return orbisElfErrorCodeCorruptedImage;
 		}
 
-		elf->symbols[importSymbolIndex].header.value = value;
-		elf->symbols[importSymbolIndex].header.size = size;
-		elf->symbols[importSymbolIndex].virtualBaseAddress = virtualBaseAddress;
-		return orbisElfErrorCodeOk;
-	}
+		total += ORBIS_ELF_ALIGN_ALLOCATION(program.filesz);
+
+		if (program.filesz && program.type == orbisElfProgramTypeDynamic)
+		{
+			dynamicOffset = program.offset;
+			dynamicSize = program.filesz;
+		}
+		else if (program.filesz)
+		{
+			dynlibDataSize = program.filesz;
+		}
+	}
+
+	OrbisElfPrelinkTrailer_t trailer;
+
+	if (image->imageSize >= sizeof(trailer) && orbisElfRead(elf, image->imageSize - sizeof(trailer), &trailer, sizeof(trailer)) == sizeof(trailer) &&
+	    memcmp(trailer.magic, ORBIS_ELF_PRELINK_MAGIC, sizeof(trailer.magic)) == 0)
+	{
+		if (trailer.sitesCount > (image->imageSize - sizeof(trailer)) / sizeof(uint32_t))
+		{
+			return orbisElfErrorCodeCorruptedImage;
+		}
+
+		total += ORBIS_ELF_ALIGN_ALLOCATION(sizeof(uint32_t) * (trailer.sitesCount ? trailer.sitesCount : 1));
+	}
+
+	if (elf->parseFlags & orbisElfParseFlagEagerIndexes)
+	{
+		total += ORBIS_ELF_ALIGN_ALLOCATION(getSectionTableSize(elf));
+	}
+
+	OrbisElfDynamicCounts_t counts;
+	OrbisElfErrorCode_t errorCode = countDynamics(elf, dynamicOffset, dynamicSize / sizeof(OrbisElfDynamic_t), &counts);
+
+	if (errorCode != orbisElfErrorCodeOk)
+	{
+		return errorCode;
+	}
+
+	/* tables live in the dynlib data, parsing rejects sizes beyond it */
+	if (!dynlibDataSize)
+	{
+		*size = total;
+		return orbisElfErrorCodeOk;
+	}
+
+	if (counts.strTabSize > dynlibDataSize || counts.symTabSize > dynlibDataSize || counts.relaSize > dynlibDataSize || counts.pltRelSize > dynlibDataSize)
+	{
+		return orbisElfErrorCodeCorruptedImage;
+	}
+
+	/* every relocation lands in one of three arrays, the largest entry bounds all of them */
+	uint64_t relocationsCount = ((counts.hasTables & 8) ? counts.relaSize / sizeof(OrbisElfRela_t) : 0) +
+		((counts.hasTables & 4) ? counts.pltRelSize / (counts.pltRelType == orbisElfDynamicTypeRel ? sizeof(OrbisElfRel_t) : sizeof(OrbisElfRela_t)) : 0);
+	uint64_t relocationSize = sizeof(OrbisElfRelocation_t) > sizeof(OrbisElfRebaseRelocation_t) ? sizeof(OrbisElfRelocation_t) : sizeof(OrbisElfRebaseRelocation_t);
+
+	total += ORBIS_ELF_ALIGN_ALLOCATION(relocationSize * relocationsCount) + 2 * ORBIS_ELF_ALLOCATION_ALIGN;
+
+	if (!(counts.hasTables & 2) || !counts.strTabSize)
+	{
+		*size = total;
+		return orbisElfErrorCodeOk;
+	}
+
+	total += ORBIS_ELF_ALIGN_ALLOCATION(sizeof(OrbisElfModuleInfo_t) * counts.importModulesCount);
+	total += ORBIS_ELF_ALIGN_ALLOCATION(sizeof(OrbisElfLibraryInfo_t) * counts.librariesCount) + ORBIS_ELF_ALLOCATION_ALIGN;
+	total += ORBIS_ELF_ALIGN_ALLOCATION(sizeof(char *) * counts.neededCount);
+
+	uint64_t symbolsCount = (counts.hasTables & 1) ? counts.symTabSize / sizeof(OrbisElfSymbolHeader_t) : 0;
+
+	if (symbolsCount && counts.symTabEntrySize != sizeof(OrbisElfSymbolHeader_t))
+	{
+		return orbisElfErrorCodeInvalidImageFormat;
+	}
+
+	if (symbolsCount)
+	{
+		total += ORBIS_ELF_ALIGN_ALLOCATION(sizeof(OrbisElfSymbol_t) * symbolsCount);
+		total += ORBIS_ELF_ALIGN_ALLOCATION(sizeof(OrbisElfHotSymbol_t) * symbolsCount);
+		total += ORBIS_ELF_ALIGN_ALLOCATION(sizeof(OrbisElfBindingSlot_t) * symbolsCount);
+		total += ORBIS_ELF_ALIGN_ALLOCATION(sizeof(OrbisElfModuleLink_t) * counts.importModulesCount);
+
+		/* any symbol may be a NID name with its short copy, interned names take no parse storage */
+		if (!elf->image->stringTable)
+		{
+			total += ORBIS_ELF_ALIGN_ALLOCATION(12) * symbolsCount;
+		}
+	}
+
+	*size = total;
+	return orbisElfErrorCodeOk;
+}
+
+OrbisElfErrorCode_t orbisElfQueryParseSize(OrbisElfReadCallback_t readImageCallback, size_t imageSize, void *readImageUserData, const OrbisElfParseOptions_t *options, uint64_t *size)
+{
+	if (imageSize < sizeof(OrbisElfHeader_t))
+	{
+		return orbisElfErrorCodeInvalidImageFormat;
+	}
+
+	/* a handle on the stack carries the reads and options, nothing is allocated */
+	OrbisElf_t elf;
+	OrbisElfImage_t image;
+	OrbisElfParseOptions_t countOptions;
+
+	if (options)
+	{
+		countOptions = *options;
+		countOptions.flags &= ~(uint32_t)orbisElfParseFlagCollectStats;
+		countOptions.traceCallback = NULL;
+		countOptions.diagnosticCallback = NULL;
+	}
+
+	initHandle(&elf, &image, readImageCallback, imageSize, readImageUserData, options ? &countOptions : NULL);
+
+	if (orbisElfRead(&elf, 0, &image.header, sizeof(OrbisElfHeader_t)) != sizeof(OrbisElfHeader_t))
+	{
+		return orbisElfErrorCodeIoError;
+	}
+
+	return countParseSize(&elf, size);
+}
+
+OrbisElfErrorCode_t orbisElfParseInPlace(OrbisElfHandle_t *handle, void *memory, uint64_t memorySize, OrbisElfReadCallback_t readImageCallback, size_t imageSize, void *readImageUserData, const OrbisElfParseOptions_t *options)
+{
+	uint64_t handleSize = ORBIS_ELF_ALIGN_ALLOCATION(sizeof(OrbisElf_t));
+	uint64_t imageStructSize = ORBIS_ELF_ALIGN_ALLOCATION(sizeof(OrbisElfImage_t));
+
+	if (((uintptr_t)memory & (ORBIS_ELF_ALLOCATION_ALIGN - 1)) || memorySize < handleSize + imageStructSize)
+	{
+		return orbisElfErrorCodeInvalidValue;
+	}
+
+	if (imageSize < sizeof(OrbisElfHeader_t))
+	{
+		return orbisElfErrorCodeInvalidImageFormat;
+	}
+
+	OrbisElfHandle_t elf = memory;
+	initHandle(elf, (OrbisElfImage_t *)((uint8_t *)memory + handleSize), readImageCallback, imageSize, readImageUserData, options);
+	elf->image->arenaBegin = memory;
+	elf->image->arenaCurrent = (uint8_t *)memory + handleSize + imageStructSize;
+	elf->image->arenaEnd = (uint8_t *)memory + memorySize;
+
+	if (orbisElfRead(elf, 0, &elf->image->header, sizeof(OrbisElfHeader_t)) != sizeof(OrbisElfHeader_t))
+	{
+		return orbisElfErrorCodeIoError;
+	}
+
+	*handle = elf;
+	return parseImage(elf);
+}
+
+OrbisElfErrorCode_t orbisElfLoad(OrbisElfHandle_t elf, void *baseAddress, uint64_t virtualBaseAddress)
+{
+	uint64_t begin = beginPhase(elf);
+	OrbisElfErrorCode_t errorCode = loadPrograms(elf, baseAddress, virtualBaseAddress);
+	endPhase(elf, orbisElfPhaseLoad, begin);
+
+	/* the FDE table indexes loaded memory, a broken .eh_frame is reported again by orbisElfFindFde */
+	if (errorCode == orbisElfErrorCodeOk && (elf->parseFlags & orbisElfParseFlagEagerIndexes) && elf->image->ehFrameHeaderSize)
+	{
+		const OrbisElfFdeTable_t *table;
+		begin = beginPhase(elf);
+		getFdeTable(elf, &table);
+		endPhase(elf, orbisElfPhaseParseEhFrame, begin);
+	}
+
+	return errorCode;
+}
+
+static OrbisElfErrorCode_t loadPrograms(OrbisElfHandle_t elf, void *baseAddress, uint64_t virtualBaseAddress)
+{
+	elf->virtualBaseAddress = virtualBaseAddress ? virtualBaseAddress : (uint64_t)baseAddress;
+	elf->baseAddress = baseAddress;
+
+	beginBindingsWrite(elf);
+
+	/* imports bound before loading keep the base of the module or address they are bound to */
+	for (uint64_t i = 0; i < elf->image->symbolsCount; ++i)
+	{
+		if (atomic_load_explicit(&elf->bindings[i].module, memory_order_relaxed) == elf)
+		{
+			atomic_store_explicit(&elf->bindings[i].virtualBaseAddress, elf->virtualBaseAddress, memory_order_relaxed);
+		}
+	}
+
+	endBindingsWrite(elf);
+
+	for (uint16_t i = 0; i < elf->image->programsCount; ++i)
+	{
+		if (elf->image->programs[i].type == orbisElfProgramTypeLoad || elf->image->programs[i].type == orbisElfProgramTypeSceRelRo)
+		{
+			if (elf->image->programs[i].filesz > elf->image->imageSize || elf->image->programs[i].offset > elf->image->imageSize - elf->image->programs[i].filesz)
+			{
+				return orbisElfErrorCodeCorruptedImage;
+			}
+			
+			if (orbisElfRead(elf, elf->image->programs[i].offset, (char *)baseAddress + elf->image->programs[i].vaddr, elf->image->programs[i].filesz)
+			    != elf->image->programs[i].filesz)
+			{
+				return orbisElfErrorCodeIoError;
+			}
+		}
+	}
+
+	return orbisElfErrorCodeOk;
+}
+
+OrbisElfErrorCode_t orbisElfImportModule(OrbisElfHandle_t elf, OrbisElfHandle_t importElf)
+{
+	uint64_t begin = beginPhase(elf);
+	OrbisElfErrorCode_t errorCode = importModule(elf, importElf);
+	endPhase(elf, orbisElfPhaseResolve, begin);
+	return errorCode;
+}
+
+/* returns the export of importElf that resolves import symbol importSymbolIndex of elf, or importElf->image->symbolsCount */
+static uint64_t findExportSymbol(OrbisElfHandle_t elf, uint64_t importSymbolIndex, OrbisElfHandle_t importElf, int isBound)
+{
+	const OrbisElfHotSymbol_t *importSymbol = elf->image->hotSymbols + importSymbolIndex;
+
+	for (uint64_t exportSymbolIndex = 0; exportSymbolIndex < importElf->image->symbolsCount; ++exportSymbolIndex)
+	{
+		const OrbisElfHotSymbol_t *exportSymbol = importElf->image->hotSymbols + exportSymbolIndex;
+
+		if (!exportSymbol->libraryHash || !exportSymbol->isDefined)
+		{
+			continue;
+		}
+
+		if (exportSymbol->bind == orbisElfSymbolBindLocal)
+		{
+			continue;
+		}
+
+		if (isBound && exportSymbol->bind != orbisElfSymbolBindGlobal)
+		{
+			continue;
+		}
+
+		if (importSymbol->type != exportSymbol->type || importSymbol->libraryHash != exportSymbol->libraryHash || importSymbol->nameHash != exportSymbol->nameHash)
+		{
+			continue;
+		}
+
+		if (!isSameName(elf, elf->image->symbols[importSymbolIndex].library->name, elf->image->symbols[importSymbolIndex].library->nameId,
+		                importElf, importElf->image->symbols[exportSymbolIndex].library->name, importElf->image->symbols[exportSymbolIndex].library->nameId))
+		{
+			continue;
+		}
+
+		if (!isSameSymbolName(elf, elf->image->symbols[importSymbolIndex].name, importElf, importElf->image->symbols[exportSymbolIndex].name))
+		{
+			continue;
+		}
+
+		return exportSymbolIndex;
+	}
+
+	return importElf->image->symbolsCount;
+}
+
+static void linkDependency(OrbisElfModuleLink_t *link, OrbisElfHandle_t dependency)
+{
+	link->dependency = dependency;
+	link->previousImporter = NULL;
+	link->nextImporter = dependency->importers;
+
+	if (dependency->importers)
+	{
+		dependency->importers->previousImporter = link;
+	}
+
+	dependency->importers = link;
+	atomic_fetch_add_explicit(&dependency->referencesCount, 1, memory_order_relaxed);
+}
+
+void orbisElfSetReadCallback(OrbisElfHandle_t elf, OrbisElfReadCallback_t readImageCallback, void *readImageUserData)
+{
+	elf->read = readImageCallback;
+	elf->readUserData = readImageUserData;
+}
+
+static void releaseHandle(OrbisElfHandle_t elf);
+
+static void unlinkDependency(OrbisElfModuleLink_t *link)
+{
+	OrbisElfHandle_t dependency = link->dependency;
+
+	if (link->previousImporter)
+	{
+		link->previousImporter->nextImporter = link->nextImporter;
+	}
+	else
+	{
+		dependency->importers = link->nextImporter;
+	}
+
+	if (link->nextImporter)
+	{
+		link->nextImporter->previousImporter = link->previousImporter;
+	}
+
+	link->dependency = NULL;
+	link->previousImporter = NULL;
+	link->nextImporter = NULL;
+	releaseHandle(dependency);
+}
+
+static OrbisElfErrorCode_t importModule(OrbisElfHandle_t elf, OrbisElfHandle_t importElf)
+{
+	uint64_t boundCount = 0;
+	uint16_t lastModuleIndex = ORBIS_ELF_NO_MODULE;
+	int isLastModuleImported = 0;
+
+	for (uint64_t importSymbolIndex = 0; importSymbolIndex < elf->image->symbolsCount; ++importSymbolIndex)
+	{
+		const OrbisElfHotSymbol_t *importSymbol = elf->image->hotSymbols + importSymbolIndex;
+
+		if (importSymbol->moduleIndex == ORBIS_ELF_NO_MODULE || !importSymbol->libraryHash)
+		{
+			continue;
+		}
+
+		if (importSymbol->bind == orbisElfSymbolBindLocal)
+		{
+			continue;
+		}
+
+		uint64_t importValue = atomic_load_explicit(&elf->bindings[importSymbolIndex].value, memory_order_relaxed);
+
+		if (importValue && importSymbol->type != orbisElfSymbolBindWeak)
+		{
+			continue;
+		}
+
+		/* symbols of one module mostly come in runs, so its name is compared once per run */
+		if (importSymbol->moduleIndex != lastModuleIndex)
+		{
+			lastModuleIndex = importSymbol->moduleIndex;
+			isLastModuleImported = isSameName(elf, elf->image->symbols[importSymbolIndex].module->name, elf->image->symbols[importSymbolIndex].module->nameId,
+			                                  importElf, importElf->image->moduleInfo.name, importElf->image->moduleInfo.nameId);
+		}
+
+		if (!isLastModuleImported)
+		{
+			continue;
+		}
+
+		uint64_t exportSymbolIndex = findExportSymbol(elf, importSymbolIndex, importElf, importValue != 0);
+
+		if (exportSymbolIndex == importElf->image->symbolsCount)
+		{
+			continue;
+		}
+
+		beginBindingsWrite(elf);
+		storeBinding(elf, importSymbolIndex, importElf, importElf->virtualBaseAddress, importElf->image->symbols[exportSymbolIndex].header.value, importElf->image->symbols[exportSymbolIndex].header.size);
+		endBindingsWrite(elf);
+		++boundCount;
+	}
+
+	/* the first module bound for an import module keeps the link, orbisElfReplaceModule moves it */
+	for (uint64_t i = 0; boundCount && i < elf->image->importModulesCount; ++i)
+	{
+		if (!elf->dependencies[i].dependency &&
+		    isSameName(elf, elf->image->importModules[i].name, elf->image->importModules[i].nameId, importElf, importElf->image->moduleInfo.name, importElf->image->moduleInfo.nameId))
+		{
+			linkDependency(elf->dependencies + i, importElf);
+			break;
+		}
+	}
+
+	return orbisElfErrorCodeOk;
+}
+
+OrbisElfErrorCode_t orbisElfSetImportSymbol(OrbisElfHandle_t elf, const char *moduleName, const char *libraryName, const char *symbolName, uint64_t virtualBaseAddress, uint64_t value, uint64_t size)
+{
+	uint64_t begin = beginPhase(elf);
+	OrbisElfErrorCode_t errorCode = setImportSymbol(elf, moduleName, libraryName, symbolName, virtualBaseAddress, value, size);
+	endPhase(elf, orbisElfPhaseResolve, begin);
+	return errorCode;
+}
+
+/* hot symbol module index of the module called name, ORBIS_ELF_NO_MODULE when there is none */
+static uint16_t findModuleIndexByName(OrbisElfHandle_t elf, const char *name)
+{
+	for (uint64_t i = 0; elf->image->importModules && i < elf->image->importModulesCount; ++i)
+	{
+		if (strcmp(elf->image->importModules[i].name, name) == 0)
+		{
+			return (uint16_t)i;
+		}
+	}
+
+	return elf->image->moduleInfo.name && strcmp(elf->image->moduleInfo.name, name) == 0 ? (uint16_t)elf->image->importModulesCount : ORBIS_ELF_NO_MODULE;
+}
+
+static const OrbisElfLibraryInfo_t *findLibraryByName(OrbisElfHandle_t elf, const char *name)
+{
+	for (uint64_t i = 0; elf->image->importLibraries && i < elf->image->importLibrariesCount; ++i)
+	{
+		if (strcmp(elf->image->importLibraries[i].name, name) == 0)
+		{
+			return elf->image->importLibraries + i;
+		}
+	}
+
+	for (uint64_t i = 0; elf->image->exportLibraries && i < elf->image->exportLibrariesCount; ++i)
+	{
+		if (strcmp(elf->image->exportLibraries[i].name, name) == 0)
+		{
+			return elf->image->exportLibraries + i;
+		}
+	}
+
+	return NULL;
+}
+
+static OrbisElfErrorCode_t setImportSymbol(OrbisElfHandle_t elf, const char *moduleName, const char *libraryName, const char *symbolName, uint64_t virtualBaseAddress, uint64_t value, uint64_t size)
+{
+	/* the names are looked up once in the few modules and libraries of elf, symbols are then matched by index and pointer */
+	uint16_t moduleIndex = findModuleIndexByName(elf, moduleName);
+	const OrbisElfLibraryInfo_t *library = findLibraryByName(elf, libraryName);
+
+	if (moduleIndex == ORBIS_ELF_NO_MODULE || !library)
+	{
+		return orbisElfErrorCodeNotFound;
+	}
+
+	uint32_t nameHash = hashSymbolName(symbolName);
+	uint32_t libraryHash = hashLibraryName(libraryName);
+
+	for (uint64_t importSymbolIndex = 0; importSymbolIndex < elf->image->symbolsCount; ++importSymbolIndex)
+	{
+		const OrbisElfHotSymbol_t *importSymbol = elf->image->hotSymbols + importSymbolIndex;
+
+		if (importSymbol->moduleIndex != moduleIndex || importSymbol->libraryHash != libraryHash || importSymbol->nameHash != nameHash)
+		{
+			continue;
+		}
+
+		if (elf->image->symbols[importSymbolIndex].library != library || strcmp(elf->image->symbols[importSymbolIndex].name, symbolName) != 0)
+		{
+			continue;
+		}
+
+		beginBindingsWrite(elf);
+		storeBinding(elf, importSymbolIndex, NULL, virtualBaseAddress, value, size);
+		endBindingsWrite(elf);
+		return orbisElfErrorCodeOk;
+	}
 
 	return orbisElfErrorCodeNotFound;
 }
 
-void orbisElfDestroy(OrbisElfHandle_t elf)
+static void freeImage(OrbisElfHandle_t elf)
+{
+	elfFree(elf, elf->image->programs);
+	elfFree(elf, atomic_load_explicit(&elf->image->sectionTable, memory_order_acquire));
+	elfFree(elf, atomic_load_explicit(&elf->image->fdeTable, memory_order_acquire));
+	elfFree(elf, atomic_load_explicit(&elf->image->addressIndex, memory_order_acquire));
+	elfFree(elf, elf->image->importModules);
+	elfFree(elf, elf->image->importLibraries);
+	elfFree(elf, elf->image->exportLibraries);
+
+	for (uint64_t i = 0; elf->image->symbols && !elf->image->stringTable && i < elf->image->symbolsCount; ++i)
+	{
+		if (elf->image->symbols[i].library || elf->image->symbols[i].module)
+		{
+			elfFree(elf, elf->image->symbols[i].name);
+		}
+	}
+
+	elfFree(elf, elf->image->dynamics);
+	elfFree(elf, elf->image->sceDynlibData);
+	elfFree(elf, elf->image->symbols);
+	elfFree(elf, elf->image->hotSymbols);
+	elfFree(elf, elf->image->importRelocations);
+	elfFree(elf, elf->image->rebaseRelocations);
+	elfFree(elf, elf->image->prelinkSites);
+	elfFree(elf, elf->image->tlsRelocations);
+	elfFree(elf, elf->image->needed);
+	elfFree(elf, atomic_load_explicit(&elf->image->symbolRelocationIndex, memory_order_acquire));
+	elfFree(elf, atomic_load_explicit(&elf->image->pageRelocationIndex, memory_order_acquire));
+}
+
+static void freeHandle(OrbisElfHandle_t elf)
+{
+	OrbisElfImage_t *image = elf->image;
+	OrbisElfAllocator_t allocator = image->allocator;
+	int isInArena = (uint8_t *)elf >= image->arenaBegin && (uint8_t *)elf < image->arenaEnd;
+
+	elfFree(elf, elf->bindings);
+	elfFree(elf, elf->dependencies);
+
+	if (atomic_fetch_sub_explicit(&image->handlesCount, 1, memory_order_acq_rel) == 1)
+	{
+		freeImage(elf);
+
+		if (!image->arenaBegin)
+		{
+			allocatorFree(&allocator, image);
+		}
+	}
+
+	/* only the parsed handle of orbisElfParseInPlace lives in the arena, clones come from the allocator */
+	if (!isInArena)
+	{
+		allocatorFree(&allocator, elf);
+	}
+}
+
+OrbisElfErrorCode_t orbisElfClone(OrbisElfHandle_t elf, OrbisElfHandle_t *clone)
+{
+	OrbisElfHandle_t result = allocateShared(elf, sizeof(OrbisElf_t));
+
+	if (!result)
+	{
+		return orbisElfErrorCodeNoMemory;
+	}
+
+	memset(result, 0, sizeof(OrbisElf_t));
+	atomic_init(&result->bindingsSequence, 0);
+
+	for (int i = 0; i < orbisElfDiagnosticCount; ++i)
+	{
+		atomic_init(&result->diagnostics[i], 0);
+	}
+
+	result->image = elf->image;
+	atomic_init(&result->referencesCount, 1);
+	result->read = elf->read;
+	result->readUserData = elf->readUserData;
+	result->parseFlags = elf->parseFlags;
+	result->traceCallback = elf->traceCallback;
+	result->traceUserData = elf->traceUserData;
+	result->diagnosticCallback = elf->diagnosticCallback;
+	result->diagnosticUserData = elf->diagnosticUserData;
+	atomic_fetch_add_explicit(&elf->image->handlesCount, 1, memory_order_relaxed);
+
+	/* bindings start unresolved, as after parsing */
+	OrbisElfErrorCode_t errorCode = initBindings(result, allocateShared);
+
+	if (errorCode != orbisElfErrorCodeOk)
+	{
+		freeHandle(result);
+		return errorCode;
+	}
+
+	*clone = result;
+	return orbisElfErrorCodeOk;
+}
+
+static void releaseHandle(OrbisElfHandle_t elf)
+{
+	if (atomic_fetch_sub_explicit(&elf->referencesCount, 1, memory_order_acq_rel) != 1)
+	{
+		return;
+	}
+
+	if (elf->unloadCallback)
+	{
+		elf->unloadCallback(elf, elf->unloadUserData);
+	}
+
+	freeHandle(elf);
+}
+
+void orbisElfDestroy(OrbisElfHandle_t elf)
+{
+	for (uint64_t i = 0; elf->dependencies && i < elf->image->importModulesCount; ++i)
+	{
+		if (elf->dependencies[i].dependency)
+		{
+			unlinkDependency(elf->dependencies + i);
+		}
+	}
+
+	/* importers still point into the module, the last one to unlink frees it */
+	releaseHandle(elf);
+}
+
+void orbisElfSetUnloadCallback(OrbisElfHandle_t elf, OrbisElfUnloadCallback_t unloadCallback, void *unloadUserData)
+{
+	elf->unloadCallback = unloadCallback;
+	elf->unloadUserData = unloadUserData;
+}
+
+/* rebinds the importer symbols bound into link->dependency to newElf, or back to unresolved, and moves the link */
+static OrbisElfErrorCode_t relinkImporter(OrbisElfModuleLink_t *link, OrbisElfHandle_t newElf, uint64_t *unresolvedCount)
+{
+	OrbisElfHandle_t elf = link->importer;
+	OrbisElfHandle_t oldElf = link->dependency;
+	const OrbisElfModuleInfo_t *module = elf->image->importModules + (link - elf->dependencies);
+
+	if (!getSymbolRelocationIndex(elf))
+	{
+		return orbisElfErrorCodeNoMemory;
+	}
+
+	for (uint64_t i = 0; i < elf->image->symbolsCount; ++i)
+	{
+		if (elf->image->hotSymbols[i].moduleIndex != module - elf->image->importModules || !elf->image->hotSymbols[i].libraryHash)
+		{
+			continue;
+		}
+
+		OrbisElfSymbolBinding_t binding;
+		loadBinding(elf, i, &binding);
+
+		/* skips unresolved symbols and the ones bound elsewhere, by address or to another module at the same base */
+		if (binding.module != oldElf)
+		{
+			continue;
+		}
+
+		uint64_t exportSymbolIndex = newElf ? findExportSymbol(elf, i, newElf, 0) : 0;
+
+		if (newElf && exportSymbolIndex < newElf->image->symbolsCount)
+		{
+			rebindSymbol(elf, i, newElf, newElf->virtualBaseAddress, newElf->image->symbols[exportSymbolIndex].header.value, newElf->image->symbols[exportSymbolIndex].header.size);
+		}
+		else
+		{
+			rebindSymbol(elf, i, elf, elf->virtualBaseAddress, elf->image->symbols[i].header.value, elf->image->symbols[i].header.size);
+			++*unresolvedCount;
+		}
+	}
+
+	unlinkDependency(link);
+
+	if (newElf)
+	{
+		linkDependency(link, newElf);
+	}
+
+	return orbisElfErrorCodeOk;
+}
+
+/* TLS slots of a loaded importer can't follow its symbols to another module, see rebindSymbol */
+static OrbisElfErrorCode_t checkTlsImports(OrbisElfHandle_t elf, OrbisElfHandle_t module)
+{
+	if (!elf->baseAddress || !elf->image->tlsRelocationsCount)
+	{
+		return orbisElfErrorCodeOk;
+	}
+
+	const OrbisElfSymbolRelocationIndex_t *index = getSymbolRelocationIndex(elf);
+
+	if (!index)
+	{
+		return orbisElfErrorCodeNoMemory;
+	}
+
+	for (uint64_t i = 0; i < elf->image->symbolsCount; ++i)
+	{
+		OrbisElfSymbolBinding_t binding;
+
+		if (index->tlsOffsets[i] == index->tlsOffsets[i + 1])
+		{
+			continue;
+		}
+
+		loadBinding(elf, i, &binding);
+
+		if (binding.module == module)
+		{
+			return orbisElfErrorCodeInvalidValue;
+		}
+	}
+
+	return orbisElfErrorCodeOk;
+}
+
+static OrbisElfErrorCode_t relinkImporters(OrbisElfHandle_t elf, OrbisElfHandle_t newElf, uint64_t *unresolvedCount)
+{
+	OrbisElfErrorCode_t errorCode = orbisElfErrorCodeOk;
+
+	/* checked up front, so a refused move leaves every importer as it was */
+	for (const OrbisElfModuleLink_t *link = elf->importers; link && errorCode == orbisElfErrorCodeOk; link = link->nextImporter)
+	{
+		errorCode = checkTlsImports(link->importer, elf);
+	}
+
+	if (errorCode != orbisElfErrorCodeOk)
+	{
+		return errorCode;
+	}
+
+	/* unlinking the last importer must not free elf while its list is walked */
+	atomic_fetch_add_explicit(&elf->referencesCount, 1, memory_order_relaxed);
+
+	while (elf->importers && errorCode == orbisElfErrorCodeOk)
+	{
+		errorCode = relinkImporter(elf->importers, newElf, unresolvedCount);
+	}
+
+	releaseHandle(elf);
+	return errorCode;
+}
+
+OrbisElfErrorCode_t orbisElfReplaceModule(OrbisElfHandle_t elf, OrbisElfHandle_t newElf)
+{
+	if (elf == newElf || !isSameName(elf, elf->image->moduleInfo.name, elf->image->moduleInfo.nameId, newElf, newElf->image->moduleInfo.name, newElf->image->moduleInfo.nameId))
+	{
+		return orbisElfErrorCodeInvalidValue;
+	}
+
+	uint64_t unresolvedCount = 0;
+	OrbisElfErrorCode_t errorCode = relinkImporters(elf, newElf, &unresolvedCount);
+
+	if (errorCode == orbisElfErrorCodeOk && unresolvedCount)
+	{
+		return orbisElfErrorCodeNotFound;
+	}
+
+	return errorCode;
+}
+
+OrbisElfErrorCode_t orbisElfUnloadModule(OrbisElfHandle_t elf)
+{
+	uint64_t unresolvedCount = 0;
+	OrbisElfErrorCode_t errorCode = relinkImporters(elf, NULL, &unresolvedCount);
+
+	if (errorCode != orbisElfErrorCodeOk)
+	{
+		return errorCode;
+	}
+
+	orbisElfDestroy(elf);
+	return orbisElfErrorCodeOk;
+}
+
+uint64_t orbisElfGetImportersCount(OrbisElfHandle_t elf)
+{
+	uint64_t count = 0;
+
+	for (const OrbisElfModuleLink_t *link = elf->importers; link; link = link->nextImporter)
+	{
+		++count;
+	}
+
+	return count;
+}
+
+OrbisElfHandle_t orbisElfGetImporter(OrbisElfHandle_t elf, uint64_t index)
+{
+	for (const OrbisElfModuleLink_t *link = elf->importers; link; link = link->nextImporter)
+	{
+		if (!index--)
+		{
+			return link->importer;
+		}
+	}
+
+	return NULL;
+}
+
+OrbisElfHandle_t orbisElfGetDependency(OrbisElfHandle_t elf, uint64_t importModuleIndex)
+{
+	if (!elf->dependencies || importModuleIndex >= elf->image->importModulesCount)
+	{
+		return NULL;
+	}
+
+	return elf->dependencies[importModuleIndex].dependency;
+}
+
+const OrbisElfHeader_t *orbisElfGetHeader(OrbisElfHandle_t elf)
+{
+	return &elf->image->header;
+}
+
+OrbisElfType_t orbisElfGetType(OrbisElfHandle_t elf)
+{
+	return elf->image->header.type;
+}
+
+const OrbisElfModuleInfo_t *orbisElfGetModuleInfo(OrbisElfHandle_t elf)
+{
+	return &elf->image->moduleInfo;
+}
+
+uint64_t orbisElfGetGotPltAddress(OrbisElfHandle_t elf)
+{
+	return elf->image->pltGotAddress;
+}
+
+uint64_t orbisElfGetTlsSize(OrbisElfHandle_t elf)
+{
+	return elf->image->tlsSize;
+}
+
+uint64_t orbisElfGetTlsAlign(OrbisElfHandle_t elf)
+{
+	return elf->image->tlsAlign;
+}
+
+uint64_t orbisElfGetTlsInitAddress(OrbisElfHandle_t elf)
+{
+	return elf->image->tlsInitAddress;
+}
+
+uint64_t orbisElfGetTlsInitSize(OrbisElfHandle_t elf)
+{
+	return elf->image->tlsInitSize;
+}
+
+uint64_t orbisElfGetLoadSize(OrbisElfHandle_t elf)
+{
+	return elf->image->loadSize;
+}
+
+const char *orbisElfGetSoName(OrbisElfHandle_t elf)
+{
+	return elf->image->soName;
+}
+
+uint64_t orbisElfGetSceProcParam(OrbisElfHandle_t elf, uint64_t *size)
+{
+	if (size)
+	{
+		*size = elf->image->sceProcParam ? elf->image->sceProcParamSize : 0;
+	}
+
+	return elf->image->sceProcParam ? orbisElfGetVirtualBaseAddress(elf) + elf->image->sceProcParam : 0;
+}
+
+uint64_t orbisElfGetEntryPoint(OrbisElfHandle_t elf)
+{
+	return elf->image->header.entry;
+}
+
+uint64_t orbisElfGetVirtualBaseAddress(OrbisElfHandle_t elf)
+{
+	return elf->virtualBaseAddress;
+}
+
+void *orbisElfGetBaseAddress(OrbisElfHandle_t elf)
+{
+	return elf->baseAddress;
+}
+
+uint16_t orbisElfGetProgramsCount(OrbisElfHandle_t elf)
+{
+	return elf->image->programsCount;
+}
+
+static uint32_t hashSectionName(const char *name)
+{
+	/* FNV-1a */
+	uint32_t hash = 2166136261u;
+
+	for (; *name; ++name)
+	{
+		hash = (hash ^ (uint8_t)*name) * 16777619u;
+	}
+
+	return hash;
+}
+
+/* lazy indexes are built by whichever query thread comes first, their reads don't touch the stats of the handle */
+static uint64_t readImage(OrbisElfHandle_t elf, int isParsing, uint64_t offset, void *destination, uint64_t size)
+{
+	return isParsing ? orbisElfRead(elf, offset, destination, size) : elf->read(offset, destination, size, elf->readUserData);
+}
+
+typedef struct
+{
+	uint16_t sectionsCount;
+	uint64_t headersSize;
+	uint32_t nameIndexSize;
+	uint64_t nameIndexOffset;
+	uint64_t namesOffset;
+	uint64_t namesSize;
+	uint64_t namesFileOffset;
+} OrbisElfSectionTableLayout_t;
+
+/* reads only the section names header, returns the bytes the table takes */
+static uint64_t getSectionTableLayout(OrbisElfHandle_t elf, int isParsing, OrbisElfSectionTableLayout_t *layout)
+{
+	const OrbisElfHeader_t *header = &elf->image->header;
+	layout->sectionsCount = header->shentsize == sizeof(OrbisElfSectionHeader_t) ? header->shnum : 0;
+	layout->headersSize = sizeof(OrbisElfSectionHeader_t) * layout->sectionsCount;
+
+	if (header->shoff > elf->image->imageSize || layout->headersSize > elf->image->imageSize - header->shoff)
+	{
+		layout->sectionsCount = 0;
+		layout->headersSize = 0;
+	}
+
+	layout->nameIndexSize = 2;
+
+	while (layout->nameIndexSize < layout->sectionsCount * 2u)
+	{
+		layout->nameIndexSize *= 2;
+	}
+
+	/* headers are read into the start of the sections array, so it gets at least headersSize bytes */
+	uint64_t sectionsSize = ORBIS_ELF_ALIGN_ALLOCATION(sizeof(OrbisElfSection_t) * layout->sectionsCount);
+	layout->nameIndexOffset = ORBIS_ELF_ALIGN_ALLOCATION(sizeof(OrbisElfSectionTable_t)) + sectionsSize;
+	layout->namesOffset = layout->nameIndexOffset + sizeof(uint16_t) * layout->nameIndexSize;
+	layout->namesSize = 0;
+	layout->namesFileOffset = 0;
+	OrbisElfSectionHeader_t stringsHeader;
+
+	if (header->shstrndx < layout->sectionsCount &&
+	    readImage(elf, isParsing, header->shoff + sizeof(OrbisElfSectionHeader_t) * header->shstrndx, &stringsHeader, sizeof(stringsHeader)) == sizeof(stringsHeader) &&
+	    stringsHeader.type == orbisElfSectionTypeStrTab && stringsHeader.offset <= elf->image->imageSize && stringsHeader.size <= elf->image->imageSize - stringsHeader.offset)
+	{
+		layout->namesSize = stringsHeader.size;
+		layout->namesFileOffset = stringsHeader.offset;
+	}
+
+	return layout->namesOffset + layout->namesSize + 1;
+}
+
+static uint64_t getSectionTableSize(OrbisElfHandle_t elf)
+{
+	OrbisElfSectionTableLayout_t layout;
+	return getSectionTableLayout(elf, 1, &layout);
+}
+
+static OrbisElfSectionTable_t *buildSectionTable(OrbisElfHandle_t elf, int isParsing)
+{
+	OrbisElfSectionTableLayout_t layout;
+	uint64_t size = getSectionTableLayout(elf, isParsing, &layout);
+	uint8_t *memory = isParsing ? allocate(elf, size) : allocateShared(elf, size);
+
+	if (!memory)
+	{
+		return NULL;
+	}
+
+	OrbisElfSectionTable_t *table = (OrbisElfSectionTable_t *)memory;
+	table->sections = (OrbisElfSection_t *)(memory + ORBIS_ELF_ALIGN_ALLOCATION(sizeof(OrbisElfSectionTable_t)));
+	table->sectionsCount = layout.sectionsCount;
+	table->nameIndex = (uint16_t *)(memory + layout.nameIndexOffset);
+	table->nameIndexMask = layout.nameIndexSize - 1;
+
+	uint16_t sectionsCount = layout.sectionsCount;
+	uint64_t namesSize = layout.namesSize;
+	char *names = (char *)(memory + layout.namesOffset);
+
+	if (readImage(elf, isParsing, elf->image->header.shoff, table->sections, layout.headersSize) != layout.headersSize ||
+	    readImage(elf, isParsing, layout.namesFileOffset, names, namesSize) != namesSize)
+	{
+		elfFree(elf, memory);
+		return NULL;
+	}
+
+	names[namesSize] = '\0';
+	memset(table->nameIndex, 0, sizeof(uint16_t) * layout.nameIndexSize);
+
+	/* spreads the packed headers out back to front, each one only overlaps headers that are already moved */
+	for (uint16_t i = sectionsCount; i > 0; --i)
+	{
+		OrbisElfSectionHeader_t sectionHeader;
+		memcpy(&sectionHeader, (const OrbisElfSectionHeader_t *)table->sections + (i - 1), sizeof(sectionHeader));
+		table->sections[i - 1].header = sectionHeader;
+		table->sections[i - 1].name = sectionHeader.name < namesSize ? names + sectionHeader.name : names + namesSize;
+	}
+
+	/* inserted in section order, so the first of several equally named sections is found first */
+	for (uint16_t i = 0; i < sectionsCount; ++i)
+	{
+		uint32_t slot = hashSectionName(table->sections[i].name) & table->nameIndexMask;
+
+		while (table->nameIndex[slot])
+		{
+			slot = (slot + 1) & table->nameIndexMask;
+		}
+
+		table->nameIndex[slot] = i + 1;
+	}
+
+	return table;
+}
+
+/* a table that can't be read here is left to the first query */
+static OrbisElfErrorCode_t parseSections(OrbisElfHandle_t elf)
+{
+	atomic_store_explicit(&elf->image->sectionTable, buildSectionTable(elf, 1), memory_order_release);
+	return orbisElfErrorCodeOk;
+}
+
+static const OrbisElfSectionTable_t *getSectionTable(OrbisElfHandle_t elf)
+{
+	OrbisElfSectionTable_t *table = atomic_load_explicit(&elf->image->sectionTable, memory_order_acquire);
+
+	if (table)
+	{
+		return table;
+	}
+
+	table = buildSectionTable(elf, 0);
+
+	if (!table)
+	{
+		return NULL;
+	}
+
+	OrbisElfSectionTable_t *expected = NULL;
+
+	if (!atomic_compare_exchange_strong_explicit(&elf->image->sectionTable, &expected, table, memory_order_acq_rel, memory_order_acquire))
+	{
+		elfFree(elf, table);
+		return expected;
+	}
+
+	return table;
+}
+
+uint16_t orbisElfGetSectionsCount(OrbisElfHandle_t elf)
+{
+	const OrbisElfSectionTable_t *table = getSectionTable(elf);
+	return table ? table->sectionsCount : 0;
+}
+
+uint64_t orbisElfGetImportModulesCount(OrbisElfHandle_t elf)
+{
+	return elf->image->importModulesCount;
+}
+
+uint64_t orbisElfGetImportLibrariesCount(OrbisElfHandle_t elf)
+{
+	return elf->image->importLibrariesCount;
+}
+
+uint64_t orbisElfGetExportLibrariesCount(OrbisElfHandle_t elf)
+{
+	return elf->image->exportLibrariesCount;
+}
+
+uint64_t orbisElfGetSymbolsCount(OrbisElfHandle_t elf)
+{
+	return elf->image->symbolsCount;
+}
+
+uint64_t orbisElfGetInitAddress(OrbisElfHandle_t elf)
+{
+	return elf->image->initAddress;
+}
+
+uint64_t orbisElfGetPreinitArray(OrbisElfHandle_t elf, uint64_t *count)
+{
+	if (count)
+	{
+		*count = elf->image->preinitArrayCount;
+	}
+
+	return elf->image->preinitArrayAddress;
+}
+
+uint64_t orbisElfGetInitArray(OrbisElfHandle_t elf, uint64_t *count)
+{
+	if (count)
+	{
+		*count = elf->image->initArrayCount;
+	}
+
+	return elf->image->initArrayAddress;
+}
+
+uint64_t orbisElfGetFiniAddress(OrbisElfHandle_t elf)
+{
+	return elf->image->finiAddress;
+}
+
+uint64_t orbisElfGetFiniArray(OrbisElfHandle_t elf, uint64_t *count)
+{
+	if (count)
+	{
+		*count = elf->image->finiArrayCount;
+	}
+
+	return elf->image->finiArrayAddress;
+}
+
+const OrbisElfProgramHeader_t *orbisElfGetProgram(OrbisElfHandle_t elf, uint16_t index)
+{
+	if (index >= elf->image->programsCount)
+	{
+		return NULL;
+	}
+
+	return elf->image->programs + index;
+}
+
+const OrbisElfSectionHeader_t *orbisElfGetSection(OrbisElfHandle_t elf, uint16_t index)
+{
+	const OrbisElfSectionTable_t *table = getSectionTable(elf);
+
+	if (!table || index >= table->sectionsCount)
+	{
+		return NULL;
+	}
+
+	return &table->sections[index].header;
+}
+
+const OrbisElfModuleInfo_t *orbisElfGetImportModuleInfo(OrbisElfHandle_t elf, uint64_t index)
+{
+	if (index >= elf->image->importModulesCount)
+	{
+		return NULL;
+	}
+
+	return elf->image->importModules + index;
+}
+
+const OrbisElfLibraryInfo_t *orbisElfGetImportLibraryInfo(OrbisElfHandle_t elf, uint64_t index)
+{
+	if (index >= elf->image->importLibrariesCount)
+	{
+		return NULL;
+	}
+
+	return elf->image->importLibraries + index;
+}
+
+const OrbisElfLibraryInfo_t *orbisElfGetExportLibraryInfo(OrbisElfHandle_t elf, uint64_t index)
+{
+	if (index >= elf->image->exportLibrariesCount)
+	{
+		return NULL;
+	}
+
+	return elf->image->exportLibraries + index;
+}
+
+const OrbisElfSymbol_t *orbisElfGetSymbol(OrbisElfHandle_t elf, uint64_t index)
+{
+	if (index >= elf->image->symbolsCount)
+	{
+		return NULL;
+	}
+
+	return elf->image->symbols + index;
+}
+
+OrbisElfErrorCode_t orbisElfGetSymbolBinding(OrbisElfHandle_t elf, uint64_t index, OrbisElfSymbolBinding_t *binding)
+{
+	if (index >= elf->image->symbolsCount)
+	{
+		return orbisElfErrorCodeInvalidValue;
+	}
+
+	loadBinding(elf, index, binding);
+	return orbisElfErrorCodeOk;
+}
+
+const OrbisElfSymbol_t *orbisElfFindSymbolByName(OrbisElfHandle_t elf, const char *name)
+{
+	uint32_t nameHash = hashSymbolName(name);
+
+	for (uint64_t i = 0; i < elf->image->symbolsCount; ++i)
+	{
+		if (elf->image->hotSymbols[i].nameHash == nameHash && strcmp(elf->image->symbols[i].name, name) == 0)
+		{
+			return elf->image->symbols + i;
+		}
+	}
+
+	return NULL;
+}
+
+const OrbisElfSectionHeader_t *orbisElfFindSectionByName(OrbisElfHandle_t elf, const char *name)
+{
+	const OrbisElfSectionTable_t *table = getSectionTable(elf);
+
+	if (!table)
+	{
+		return NULL;
+	}
+
+	for (uint32_t slot = hashSectionName(name) & table->nameIndexMask; table->nameIndex[slot]; slot = (slot + 1) & table->nameIndexMask)
+	{
+		const OrbisElfSection_t *section = table->sections + table->nameIndex[slot] - 1;
+
+		if (strcmp(section->name, name) == 0)
+		{
+			return &section->header;
+		}
+	}
+
+	return NULL;
+}
+
+const OrbisElfModuleInfo_t *orbisElfFindModuleById(OrbisElfHandle_t elf, uint16_t id)
+{
+	if (elf->image->moduleInfo.id == id)
+	{
+		return &elf->image->moduleInfo;
+	}
+
+	for (uint64_t i = 0; i < elf->image->importModulesCount; ++i)
+	{
+		if (elf->image->importModules[i].id == id)
+		{
+			return elf->image->importModules + i;
+		}
+	}
+
+	return NULL;
+}
+
+const OrbisElfLibraryInfo_t *orbisElfFindLibraryById(OrbisElfHandle_t elf, uint16_t id)
+{
+	for (uint64_t i = 0; i < elf->image->importLibrariesCount; ++i)
+	{
+		if (elf->image->importLibraries[i].id == id)
+		{
+			return elf->image->importLibraries + i;
+		}
+	}
+
+	for (uint64_t i = 0; i < elf->image->exportLibrariesCount; ++i)
+	{
+		if (elf->image->exportLibraries[i].id == id)
+		{
+			return elf->image->exportLibraries + i;
+		}
+	}
+
+	return NULL;
+}
+
+const char *orbisElfSectionGetName(const OrbisElfSectionHeader_t *section)
+{
+	return section ? ((const OrbisElfSection_t *)section)->name : NULL;
+}
+
+uint64_t orbisElfGetRebaseRelocationsCount(OrbisElfHandle_t elf)
+{
+	return elf->image->rebaseRelocationsCount;
+}
+
+OrbisElfRebaseRelocation_t *orbisElfGetRebaseRelocation(OrbisElfHandle_t elf, uint64_t index)
+{
+	if (index >= elf->image->rebaseRelocationsCount)
+	{
+		return NULL;
+	}
+
+	return elf->image->rebaseRelocations + index;
+}
+
+/* file offset of the loaded bytes at address, every byte of them must come from the file */
+static int getFileOffset(OrbisElfHandle_t elf, uint64_t address, uint64_t size, uint64_t *fileOffset)
+{
+	for (uint16_t i = 0; i < elf->image->programsCount; ++i)
+	{
+		const OrbisElfProgramHeader_t *program = elf->image->programs + i;
+
+		if ((program->type == orbisElfProgramTypeLoad || program->type == orbisElfProgramTypeSceRelRo) &&
+		    address >= program->vaddr && address - program->vaddr <= program->filesz && size <= program->filesz - (address - program->vaddr))
+		{
+			*fileOffset = program->offset + (address - program->vaddr);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+OrbisElfErrorCode_t orbisElfPrelink(OrbisElfHandle_t elf, uint64_t preferredBase, OrbisElfWriteCallback_t writeCallback, void *writeUserData)
+{
+	OrbisElfImage_t *image = elf->image;
+	uint64_t sitesSize = sizeof(uint32_t) * image->rebaseRelocationsCount;
+
+	if (image->loadSize > UINT32_MAX)
+	{
+		return orbisElfErrorCodeInvalidValue;
+	}
+
+	uint8_t *buffer = allocateShared(elf, ORBIS_ELF_PRELINK_COPY_SIZE > sitesSize ? ORBIS_ELF_PRELINK_COPY_SIZE : sitesSize);
+
+	if (!buffer)
+	{
+		return orbisElfErrorCodeNoMemory;
+	}
+
+	/* the image is copied as is, a prelinked one without its old sites and trailer */
+	OrbisElfErrorCode_t errorCode = orbisElfErrorCodeOk;
+
+	for (uint64_t offset = 0; errorCode == orbisElfErrorCodeOk && offset < image->prelinkImageSize; offset += ORBIS_ELF_PRELINK_COPY_SIZE)
+	{
+		uint64_t size = image->prelinkImageSize - offset < ORBIS_ELF_PRELINK_COPY_SIZE ? image->prelinkImageSize - offset : ORBIS_ELF_PRELINK_COPY_SIZE;
+
+		if (orbisElfRead(elf, offset, buffer, size) != size || writeCallback(offset, buffer, size, writeUserData) != size)
+		{
+			errorCode = orbisElfErrorCodeIoError;
+		}
+	}
+
+	/* sites get their final value at the preferred base, so they have to be file data */
+	uint32_t *sites = (uint32_t *)buffer;
+
+	for (uint64_t i = 0; errorCode == orbisElfErrorCodeOk && i < image->rebaseRelocationsCount; ++i)
+	{
+		const OrbisElfRebaseRelocation_t *rebase = image->rebaseRelocations + i;
+		uint64_t value = preferredBase + rebase->value;
+		uint64_t fileOffset;
+
+		if (!getFileOffset(elf, rebase->offset, sizeof(value), &fileOffset) || fileOffset > image->prelinkImageSize - sizeof(value))
+		{
+			errorCode = orbisElfErrorCodeInvalidValue;
+		}
+		else if (writeCallback(fileOffset, &value, sizeof(value), writeUserData) != sizeof(value))
+		{
+			errorCode = orbisElfErrorCodeIoError;
+		}
+
+		sites[i] = (uint32_t)rebase->offset;
+	}
+
+	OrbisElfPrelinkTrailer_t trailer;
+	memcpy(trailer.magic, ORBIS_ELF_PRELINK_MAGIC, sizeof(trailer.magic));
+	trailer.preferredBase = preferredBase;
+	trailer.sitesCount = image->rebaseRelocationsCount;
+	trailer.imageSize = image->prelinkImageSize;
+
+	if (errorCode == orbisElfErrorCodeOk &&
+	    (writeCallback(image->prelinkImageSize, sites, sitesSize, writeUserData) != sitesSize ||
+	     writeCallback(image->prelinkImageSize + sitesSize, &trailer, sizeof(trailer), writeUserData) != sizeof(trailer)))
+	{
+		errorCode = orbisElfErrorCodeIoError;
+	}
+
+	elfFree(elf, buffer);
+	return errorCode;
+}
+
+uint64_t orbisElfGetPrelinkBase(OrbisElfHandle_t elf, int *isPrelinked)
+{
+	*isPrelinked = elf->image->prelinkSites != NULL;
+	return elf->image->prelinkBase;
+}
+
+OrbisElfErrorCode_t orbisElfRelocateRebases(OrbisElfHandle_t elf)
+{
+	OrbisElfImage_t *image = elf->image;
+	char *base = elf->baseAddress;
+
+	if (!base)
+	{
+		return orbisElfErrorCodeInvalidValue;
+	}
+
+	if (image->prelinkSites)
+	{
+		/* loaded at the preferred base the image already holds the final values, otherwise they move by the same delta */
+		uint64_t delta = elf->virtualBaseAddress - image->prelinkBase;
+
+		for (uint64_t i = 0; delta && i < image->prelinkSitesCount; ++i)
+		{
+			uint64_t value;
+			memcpy(&value, base + image->prelinkSites[i], sizeof(value));
+			value += delta;
+			memcpy(base + image->prelinkSites[i], &value, sizeof(value));
+		}
+
+		return orbisElfErrorCodeOk;
+	}
+
+	for (uint64_t i = 0; i < image->rebaseRelocationsCount; ++i)
+	{
+		const OrbisElfRebaseRelocation_t *rebase = image->rebaseRelocations + i;
+		uint64_t value = elf->virtualBaseAddress + rebase->value;
+
+		if (rebase->offset > image->loadSize || sizeof(value) > image->loadSize - rebase->offset)
+		{
+			return orbisElfErrorCodeCorruptedImage;
+		}
+
+		memcpy(base + rebase->offset, &value, sizeof(value));
+	}
+
+	return orbisElfErrorCodeOk;
+}
+
+uint64_t orbisElfGetImportRelocationsCount(OrbisElfHandle_t elf)
+{
+	return elf->image->importRelocationsCount;
+}
+
+OrbisElfRelocation_t *orbisElfGetImportRelocation(OrbisElfHandle_t elf, uint64_t index)
+{
+	if (index >= elf->image->importRelocationsCount)
+	{
+		return NULL;
+	}
+
+	return elf->image->importRelocations + index;
+}
+
+uint64_t orbisElfGetTlsRelocationsCount(OrbisElfHandle_t elf)
+{
+	return elf->image->tlsRelocationsCount;
+}
+
+OrbisElfRelocation_t *orbisElfGetTlsRelocation(OrbisElfHandle_t elf, uint64_t index)
 {
-	free(elf->programs);
-	free(elf->sections);
-	free(elf->importModules);
-	free(elf->importLibraries);
-	free(elf->exportLibraries);
-
-	for (uint64_t i = 0; i < elf->symbolsCount; ++i)
+	if (index >= elf->image->tlsRelocationsCount)
 	{
-		if (elf->symbols[i].library || elf->symbols[i].module)
-		{
-			free((void *)elf->symbols[i].name);
-		}
+		return NULL;
 	}
 
-	free((void *)elf->dynamics);
-	free(elf->symbols);
-	free(elf->importRelocations);
-	free(elf->rebaseRelocations);
-	free(elf->tlsRelocations);
-	free((void *)elf->needed);
-	free(elf);
+	return elf->image->tlsRelocations + index;
 }
 
-const OrbisElfHeader_t *orbisElfGetHeader(OrbisElfHandle_t elf)
-{
-	return &elf->header;
-}
 
-OrbisElfType_t orbisElfGetType(OrbisElfHandle_t elf)
+uint8_t orbisElfGetRelocationAddressSize(OrbisElfRelocation_t *rel)
 {
-	return elf->header.type;
+	switch (rel->relType)
+	{
+	case orbisElfRelocationTypePc32:
+	case orbisElfRelocationTypeTpOff32:
+	case orbisElfRelocationTypeDtpOff32:
+		return 4;
+	
+	default:
+		return 8;
+	}
 }
 
-const OrbisElfModuleInfo_t *orbisElfGetModuleInfo(OrbisElfHandle_t elf)
+static uint64_t computeImportRelocationValue(OrbisElfHandle_t elf, const OrbisElfRelocation_t *rel, const OrbisElfSymbolBinding_t *sym)
 {
-	return &elf->moduleInfo;
+	switch (rel->relType)
+	{
+	case orbisElfRelocationTypeJumpSlot:
+		if (sym->value)
+		{
+			return sym->virtualBaseAddress + sym->value + rel->addend;
+		}
+
+		return sym->virtualBaseAddress;
+
+	case orbisElfRelocationType64:
+		return sym->virtualBaseAddress + sym->value + rel->addend;
+
+	case orbisElfRelocationTypePc32:
+		return (uint32_t)(sym->virtualBaseAddress + sym->value + rel->addend - (elf->virtualBaseAddress + rel->offset));
+
+	case orbisElfRelocationTypeCopy:
+		reportDiagnostic(elf, orbisElfDiagnosticCopyRelocation, rel->offset, rel->relType);
+		return 0;
+
+	case orbisElfRelocationTypeGlobDat:
+		return sym->virtualBaseAddress + sym->value;
+
+	case orbisElfRelocationTypeDtpOff64:
+		return sym->value + rel->addend;
+
+	case orbisElfRelocationTypeDtpOff32:
+		return (uint32_t)(sym->value + rel->addend);
+
+	default:
+		reportDiagnostic(elf, orbisElfDiagnosticUnsupportedImportRelocation, rel->offset, rel->relType);
+		return 0;
+	}
 }
 
-uint64_t orbisElfGetGotPltAddress(OrbisElfHandle_t elf)
+static uint64_t computeTlsRelocationValue(OrbisElfHandle_t elf, const OrbisElfRelocation_t *rel, const OrbisElfSymbolBinding_t *sym, uint64_t tlsIndex, uint64_t tlsOffset)
 {
-	return elf->pltGotAddress;
+	switch (rel->relType)
+	{
+	case orbisElfRelocationTypeDtpMod64:
+		return tlsIndex;
+
+	case orbisElfRelocationTypeTpOff64:
+		return sym->value - tlsOffset + rel->addend;
+
+	case orbisElfRelocationTypeTpOff32:
+		return (uint32_t)(sym->value - tlsOffset + rel->addend);
+
+	default:
+		reportDiagnostic(elf, orbisElfDiagnosticUnsupportedTlsRelocation, rel->offset, rel->relType);
+		return 0;
+	}
 }
 
-uint64_t orbisElfGetTlsSize(OrbisElfHandle_t elf)
+uint64_t orbisElfGetImportRelocationValue(OrbisElfHandle_t elf, OrbisElfRelocation_t *rel)
 {
-	return elf->tlsSize;
+	OrbisElfSymbolBinding_t sym;
+
+	if (orbisElfGetSymbolBinding(elf, rel->symbolIndex, &sym) != orbisElfErrorCodeOk)
+	{
+		return 0;
+	}
+
+	return computeImportRelocationValue(elf, rel, &sym);
 }
 
-uint64_t orbisElfGetTlsAlign(OrbisElfHandle_t elf)
+uint64_t orbisElfGetTlsRelocationValue(OrbisElfHandle_t elf, OrbisElfRelocation_t *rel, uint64_t tlsIndex, uint64_t tlsOffset)
 {
-	return elf->tlsAlign;
+	OrbisElfSymbolBinding_t sym;
+
+	if (orbisElfGetSymbolBinding(elf, rel->symbolIndex, &sym) != orbisElfErrorCodeOk)
+	{
+		return 0;
+	}
+
+	return computeTlsRelocationValue(elf, rel, &sym, tlsIndex, tlsOffset);
 }
 
-uint64_t orbisElfGetTlsInitAddress(OrbisElfHandle_t elf)
+void orbisElfWriteRelocation(void *address, uint8_t size, OrbisElfRelocationInjectType_t injectType, uint64_t value)
 {
-	return elf->tlsInitAddress;
+	if (size == 4)
+	{
+		uint32_t current = 0;
+
+		if (injectType == orbisElfRelocationInjectTypeAdd)
+		{
+			memcpy(&current, address, 4);
+		}
+
+		current += (uint32_t)value;
+		memcpy(address, &current, 4);
+	}
+	else
+	{
+		uint64_t current = 0;
+
+		if (injectType == orbisElfRelocationInjectTypeAdd)
+		{
+			memcpy(&current, address, 8);
+		}
+
+		current += value;
+		memcpy(address, &current, 8);
+	}
 }
 
-uint64_t orbisElfGetTlsInitSize(OrbisElfHandle_t elf)
+static void buildSymbolRelocationRows(uint64_t symbolsCount, const OrbisElfRelocation_t *relocations, uint64_t relocationsCount, uint32_t *offsets, uint32_t *sites)
 {
-	return elf->tlsInitSize;
+	memset(offsets, 0, sizeof(uint32_t) * (symbolsCount + 1));
+
+	for (uint64_t i = 0; i < relocationsCount; ++i)
+	{
+		if (relocations[i].symbolIndex < symbolsCount)
+		{
+			offsets[relocations[i].symbolIndex + 1]++;
+		}
+	}
+
+	for (uint64_t i = 0; i < symbolsCount; ++i)
+	{
+		offsets[i + 1] += offsets[i];
+	}
+
+	uint32_t total = offsets[symbolsCount];
+
+	/* offsets[i + 1] is the end of row i here, filling back to front moves it to the row begin */
+	for (uint64_t i = relocationsCount; i > 0; --i)
+	{
+		if (relocations[i - 1].symbolIndex < symbolsCount)
+		{
+			sites[--offsets[relocations[i - 1].symbolIndex + 1]] = (uint32_t)(i - 1);
+		}
+	}
+
+	memmove(offsets, offsets + 1, sizeof(uint32_t) * symbolsCount);
+	offsets[symbolsCount] = total;
 }
 
-uint64_t orbisElfGetLoadSize(OrbisElfHandle_t elf)
+static const OrbisElfSymbolRelocationIndex_t *getSymbolRelocationIndex(OrbisElfHandle_t elf)
 {
-	return elf->loadSize;
+	OrbisElfSymbolRelocationIndex_t *index = atomic_load_explicit(&elf->image->symbolRelocationIndex, memory_order_acquire);
+
+	if (index)
+	{
+		return index;
+	}
+
+	OrbisElfImage_t *image = elf->image;
+	uint64_t size = sizeof(OrbisElfSymbolRelocationIndex_t) + sizeof(uint32_t) * ((image->symbolsCount + 1) * 2 + image->importRelocationsCount + image->tlsRelocationsCount);
+	index = allocateShared(elf, size);
+
+	if (!index)
+	{
+		return NULL;
+	}
+
+	index->importOffsets = (uint32_t *)(index + 1);
+	index->importSites = index->importOffsets + image->symbolsCount + 1;
+	index->tlsOffsets = index->importSites + image->importRelocationsCount;
+	index->tlsSites = index->tlsOffsets + image->symbolsCount + 1;
+
+	buildSymbolRelocationRows(image->symbolsCount, image->importRelocations, image->importRelocationsCount, index->importOffsets, index->importSites);
+	buildSymbolRelocationRows(image->symbolsCount, image->tlsRelocations, image->tlsRelocationsCount, index->tlsOffsets, index->tlsSites);
+
+	/* several threads may build the index at once, the first one to publish wins */
+	OrbisElfSymbolRelocationIndex_t *expected = NULL;
+
+	if (!atomic_compare_exchange_strong_explicit(&image->symbolRelocationIndex, &expected, index, memory_order_acq_rel, memory_order_acquire))
+	{
+		elfFree(elf, index);
+		return expected;
+	}
+
+	return index;
 }
 
-const char *orbisElfGetSoName(OrbisElfHandle_t elf)
+const uint32_t *orbisElfGetSymbolImportRelocations(OrbisElfHandle_t elf, uint64_t symbolIndex, uint64_t *count)
 {
-	return elf->soName;
+	const OrbisElfSymbolRelocationIndex_t *index = symbolIndex < elf->image->symbolsCount ? getSymbolRelocationIndex(elf) : NULL;
+
+	if (!index)
+	{
+		*count = 0;
+		return NULL;
+	}
+
+	*count = index->importOffsets[symbolIndex + 1] - index->importOffsets[symbolIndex];
+	return index->importSites + index->importOffsets[symbolIndex];
 }
 
-uint64_t orbisElfGetSceProcParam(OrbisElfHandle_t elf, uint64_t *size)
+const uint32_t *orbisElfGetSymbolTlsRelocations(OrbisElfHandle_t elf, uint64_t symbolIndex, uint64_t *count)
 {
-	if (size)
+	const OrbisElfSymbolRelocationIndex_t *index = symbolIndex < elf->image->symbolsCount ? getSymbolRelocationIndex(elf) : NULL;
+
+	if (!index)
 	{
-		*size = elf->sceProcParam ? elf->sceProcParamSize : 0;
+		*count = 0;
+		return NULL;
 	}
 
-	return elf->sceProcParam ? orbisElfGetVirtualBaseAddress(elf) + elf->sceProcParam : 0;
+	*count = index->tlsOffsets[symbolIndex + 1] - index->tlsOffsets[symbolIndex];
+	return index->tlsSites + index->tlsOffsets[symbolIndex];
 }
 
-uint64_t orbisElfGetEntryPoint(OrbisElfHandle_t elf)
+static OrbisElfErrorCode_t rebindSymbol(OrbisElfHandle_t elf, uint64_t symbolIndex, OrbisElfHandle_t module, uint64_t virtualBaseAddress, uint64_t value, uint64_t size)
 {
-	return elf->header.entry;
+	if (symbolIndex >= elf->image->symbolsCount)
+	{
+		return orbisElfErrorCodeInvalidValue;
+	}
+
+	const OrbisElfSymbolRelocationIndex_t *index = getSymbolRelocationIndex(elf);
+
+	if (!index)
+	{
+		return orbisElfErrorCodeNoMemory;
+	}
+
+	OrbisElfSymbolBinding_t oldBinding;
+	OrbisElfSymbolBinding_t newBinding = { virtualBaseAddress, value, size, module };
+	loadBinding(elf, symbolIndex, &oldBinding);
+
+	/* module index and block offset in TLS slots come from orbisElfTlsApply, only a move within the module can be patched */
+	if (elf->baseAddress && module != oldBinding.module && index->tlsOffsets[symbolIndex] != index->tlsOffsets[symbolIndex + 1])
+	{
+		return orbisElfErrorCodeInvalidValue;
+	}
+
+	beginBindingsWrite(elf);
+	storeBinding(elf, symbolIndex, module, virtualBaseAddress, value, size);
+	endBindingsWrite(elf);
+
+	if (!elf->baseAddress)
+	{
+		return orbisElfErrorCodeOk;
+	}
+
+	/* set slots get the new value, add slots already hold the old one and get the difference */
+	for (uint32_t i = index->importOffsets[symbolIndex]; i < index->importOffsets[symbolIndex + 1]; ++i)
+	{
+		const OrbisElfRelocation_t *rel = elf->image->importRelocations + index->importSites[i];
+		uint64_t newValue = computeImportRelocationValue(elf, rel, &newBinding);
+
+		if (orbisElfGetRelocationInjectType((OrbisElfRelocation_t *)rel) == orbisElfRelocationInjectTypeAdd)
+		{
+			newValue -= computeImportRelocationValue(elf, rel, &oldBinding);
+		}
+
+		orbisElfWriteRelocation((char *)elf->baseAddress + rel->offset, orbisElfGetRelocationAddressSize((OrbisElfRelocation_t *)rel), orbisElfGetRelocationInjectType((OrbisElfRelocation_t *)rel), newValue);
+	}
+
+	/* TLS slots are all add slots, the module stays the same so its index and block offset cancel out of the difference */
+	for (uint32_t i = index->tlsOffsets[symbolIndex]; i < index->tlsOffsets[symbolIndex + 1]; ++i)
+	{
+		const OrbisElfRelocation_t *rel = elf->image->tlsRelocations + index->tlsSites[i];
+		uint64_t delta = computeTlsRelocationValue(elf, rel, &newBinding, 0, 0) - computeTlsRelocationValue(elf, rel, &oldBinding, 0, 0);
+		orbisElfWriteRelocation((char *)elf->baseAddress + rel->offset, orbisElfGetRelocationAddressSize((OrbisElfRelocation_t *)rel), orbisElfRelocationInjectTypeAdd, delta);
+	}
+
+	return orbisElfErrorCodeOk;
 }
 
-uint64_t orbisElfGetVirtualBaseAddress(OrbisElfHandle_t elf)
+OrbisElfErrorCode_t orbisElfRebindSymbol(OrbisElfHandle_t elf, uint64_t symbolIndex, uint64_t virtualBaseAddress, uint64_t value, uint64_t size)
 {
-	return elf->virtualBaseAddress;
+	return rebindSymbol(elf, symbolIndex, NULL, virtualBaseAddress, value, size);
 }
 
-void *orbisElfGetBaseAddress(OrbisElfHandle_t elf)
+/* entries below rebaseRelocationsCount are rebases, the rest imports, relocations are listed with the page of their first byte */
+static void addPageRelocation(OrbisElfPageRelocationIndex_t *index, uint64_t offset, uint8_t size, uint64_t loadSize, uint32_t entry, int isCounting)
 {
-	return elf->baseAddress;
+	if (offset > loadSize || size > loadSize - offset)
+	{
+		return;
+	}
+
+	uint64_t page = offset / ORBIS_ELF_RELOCATION_PAGE_SIZE;
+
+	if (isCounting)
+	{
+		index->offsets[page + 1]++;
+	}
+	else
+	{
+		index->entries[index->offsets[page]++] = entry;
+	}
 }
 
-uint16_t orbisElfGetProgramsCount(OrbisElfHandle_t elf)
+static const OrbisElfPageRelocationIndex_t *getPageRelocationIndex(OrbisElfHandle_t elf)
 {
-	return elf->programsCount;
+	OrbisElfPageRelocationIndex_t *index = atomic_load_explicit(&elf->image->pageRelocationIndex, memory_order_acquire);
+
+	if (index)
+	{
+		return index;
+	}
+
+	OrbisElfImage_t *image = elf->image;
+	uint64_t pagesCount = (image->loadSize + ORBIS_ELF_RELOCATION_PAGE_SIZE - 1) / ORBIS_ELF_RELOCATION_PAGE_SIZE;
+	uint64_t relocationsCount = image->rebaseRelocationsCount + image->importRelocationsCount;
+
+	if (relocationsCount > UINT32_MAX)
+	{
+		return NULL;
+	}
+
+	index = allocateShared(elf, sizeof(OrbisElfPageRelocationIndex_t) + sizeof(uint32_t) * (pagesCount + 1 + relocationsCount));
+
+	if (!index)
+	{
+		return NULL;
+	}
+
+	index->offsets = (uint32_t *)(index + 1);
+	index->entries = index->offsets + pagesCount + 1;
+	index->pagesCount = pagesCount;
+	memset(index->offsets, 0, sizeof(uint32_t) * (pagesCount + 1));
+
+	/* counting sort by page, the second pass moves offsets[page] from the row begin to its end, then they are shifted back */
+	for (int isCounting = 1; isCounting >= 0; --isCounting)
+	{
+		for (uint64_t i = 0; i < image->rebaseRelocationsCount; ++i)
+		{
+			addPageRelocation(index, image->rebaseRelocations[i].offset, sizeof(uint64_t), image->loadSize, (uint32_t)i, isCounting);
+		}
+
+		for (uint64_t i = 0; i < image->importRelocationsCount; ++i)
+		{
+			addPageRelocation(index, image->importRelocations[i].offset, orbisElfGetRelocationAddressSize(image->importRelocations + i), image->loadSize,
+				(uint32_t)(image->rebaseRelocationsCount + i), isCounting);
+		}
+
+		for (uint64_t page = 0; isCounting && page < pagesCount; ++page)
+		{
+			index->offsets[page + 1] += index->offsets[page];
+		}
+	}
+
+	memmove(index->offsets + 1, index->offsets, sizeof(uint32_t) * pagesCount);
+	index->offsets[0] = 0;
+
+	/* several threads may build the index at once, the first one to publish wins */
+	OrbisElfPageRelocationIndex_t *expected = NULL;
+
+	if (!atomic_compare_exchange_strong_explicit(&image->pageRelocationIndex, &expected, index, memory_order_acq_rel, memory_order_acquire))
+	{
+		elfFree(elf, index);
+		return expected;
+	}
+
+	return index;
 }
 
-uint16_t orbisElfGetSectionsCount(OrbisElfHandle_t elf)
+OrbisElfErrorCode_t orbisElfRelocatePage(OrbisElfHandle_t elf, uint64_t pageSize, uint64_t pageIndex)
 {
-	return elf->sectionsCount;
+	if (!elf->baseAddress || pageSize < ORBIS_ELF_RELOCATION_PAGE_SIZE || (pageSize & (pageSize - 1)))
+	{
+		return orbisElfErrorCodeInvalidValue;
+	}
+
+	const OrbisElfPageRelocationIndex_t *index = getPageRelocationIndex(elf);
+
+	if (!index)
+	{
+		return orbisElfErrorCodeNoMemory;
+	}
+
+	/* larger pages cover several consecutive index pages */
+	uint64_t pagesPerPage = pageSize / ORBIS_ELF_RELOCATION_PAGE_SIZE;
+
+	if (pageIndex >= (index->pagesCount + pagesPerPage - 1) / pagesPerPage)
+	{
+		return orbisElfErrorCodeInvalidValue;
+	}
+
+	OrbisElfImage_t *image = elf->image;
+	char *base = elf->baseAddress;
+	uint64_t endPage = (pageIndex + 1) * pagesPerPage < index->pagesCount ? (pageIndex + 1) * pagesPerPage : index->pagesCount;
+
+	for (uint32_t i = index->offsets[pageIndex * pagesPerPage]; i < index->offsets[endPage]; ++i)
+	{
+		uint32_t entry = index->entries[i];
+
+		if (entry < image->rebaseRelocationsCount)
+		{
+			const OrbisElfRebaseRelocation_t *rebase = image->rebaseRelocations + entry;
+			uint64_t value = elf->virtualBaseAddress + rebase->value;
+			memcpy(base + rebase->offset, &value, sizeof(value));
+		}
+		else
+		{
+			OrbisElfRelocation_t *rel = image->importRelocations + (entry - image->rebaseRelocationsCount);
+			orbisElfWriteRelocation(base + rel->offset, orbisElfGetRelocationAddressSize(rel), orbisElfGetRelocationInjectType(rel), orbisElfGetImportRelocationValue(elf, rel));
+		}
+	}
+
+	return orbisElfErrorCodeOk;
 }
 
-uint64_t orbisElfGetImportModulesCount(OrbisElfHandle_t elf)
+static int isAddressIndexSymbol(const OrbisElfSymbol_t *symbol)
 {
-	return elf->importModulesCount;
+	/* TLS values are offsets in the TLS block, not addresses */
+	return symbol->header.shndx && symbol->header.value &&
+	       (symbol->type == orbisElfSymbolTypeNoType || symbol->type == orbisElfSymbolTypeObject || symbol->type == orbisElfSymbolTypeFunction);
 }
 
-uint64_t orbisElfGetImportLibrariesCount(OrbisElfHandle_t elf)
+static int compareAddressEntries(const void *a, const void *b)
 {
-	return elf->importLibrariesCount;
+	const OrbisElfAddressEntry_t *left = a;
+	const OrbisElfAddressEntry_t *right = b;
+
+	/* descending values, sized symbols first among aliases */
+	if (left->value != right->value)
+	{
+		return left->value < right->value ? 1 : -1;
+	}
+
+	if (left->size != right->size)
+	{
+		return left->size < right->size ? 1 : -1;
+	}
+
+	return (left->symbolIndex > right->symbolIndex) - (left->symbolIndex < right->symbolIndex);
 }
 
-uint64_t orbisElfGetExportLibrariesCount(OrbisElfHandle_t elf)
+/* in-order walk of the implicit tree, so the sorted entries end up in Eytzinger order */
+static uint64_t fillAddressIndex(OrbisElfAddressIndex_t *index, const OrbisElfAddressEntry_t *entries, uint64_t next, uint64_t node)
 {
-	return elf->exportLibrariesCount;
+	if (node > index->count)
+	{
+		return next;
+	}
+
+	next = fillAddressIndex(index, entries, next, node * 2);
+	index->values[node] = entries[next].value;
+	index->symbolIndexes[node] = entries[next].symbolIndex;
+	return fillAddressIndex(index, entries, next + 1, node * 2 + 1);
 }
 
-uint64_t orbisElfGetSymbolsCount(OrbisElfHandle_t elf)
+static const OrbisElfAddressIndex_t *getAddressIndex(OrbisElfHandle_t elf)
 {
-	return elf->symbolsCount;
-}
+	OrbisElfAddressIndex_t *index = atomic_load_explicit(&elf->image->addressIndex, memory_order_acquire);
+
+	if (index)
+	{
+		return index;
+	}
+
+	OrbisElfImage_t *image = elf->image;
+	uint64_t count = 0;
+
+	for (uint64_t i = 0; i < image->symbolsCount; ++i)
+	{
+		count += isAddressIndexSymbol(image->symbols + i);
+	}
+
+	OrbisElfAddressEntry_t *entries = allocateShared(elf, sizeof(OrbisElfAddressEntry_t) * (count ? count : 1));
+
+	if (!entries)
+	{
+		return NULL;
+	}
+
+	count = 0;
+
+	for (uint64_t i = 0; i < image->symbolsCount; ++i)
+	{
+		if (isAddressIndexSymbol(image->symbols + i))
+		{
+			entries[count].value = image->symbols[i].header.value;
+			entries[count].size = image->symbols[i].header.size;
+			entries[count].symbolIndex = (uint32_t)i;
+			count++;
+		}
+	}
 
-uint64_t orbisElfGetInitAddress(OrbisElfHandle_t elf)
-{
-	return elf->initAddress;
-}
+	qsort(entries, count, sizeof(OrbisElfAddressEntry_t), compareAddressEntries);
 
-uint64_t orbisElfGetPreinitArray(OrbisElfHandle_t elf, uint64_t *count)
-{
-	if (count)
+	/* element 0 is unused, children of node k are 2k and 2k + 1 */
+	index = allocateShared(elf, ORBIS_ELF_ALIGN_ALLOCATION(sizeof(OrbisElfAddressIndex_t)) + (sizeof(uint64_t) + sizeof(uint32_t)) * (count + 1));
+
+	if (!index)
 	{
-		*count = elf->preinitArrayCount;
+		elfFree(elf, entries);
+		return NULL;
 	}
 
-	return elf->preinitArrayAddress;
-}
+	index->values = (uint64_t *)((uint8_t *)index + ORBIS_ELF_ALIGN_ALLOCATION(sizeof(OrbisElfAddressIndex_t)));
+	index->symbolIndexes = (uint32_t *)(index->values + count + 1);
+	index->count = count;
+	index->values[0] = 0;
+	index->symbolIndexes[0] = 0;
+	fillAddressIndex(index, entries, 0, 1);
+	elfFree(elf, entries);
 
-uint64_t orbisElfGetInitArray(OrbisElfHandle_t elf, uint64_t *count)
-{
-	if (count)
+	OrbisElfAddressIndex_t *expected = NULL;
+
+	if (!atomic_compare_exchange_strong_explicit(&image->addressIndex, &expected, index, memory_order_acq_rel, memory_order_acquire))
 	{
-		*count = elf->initArrayCount;
+		elfFree(elf, index);
+		return expected;
 	}
 
-	return elf->initArrayAddress;
+	return index;
 }
 
-const OrbisElfProgramHeader_t *orbisElfGetProgram(OrbisElfHandle_t elf, uint16_t index)
+const OrbisElfSymbol_t *orbisElfFindSymbolByAddress(OrbisElfHandle_t elf, uint64_t address, uint64_t *offset)
 {
-	if (index >= elf->programsCount)
+	const OrbisElfAddressIndex_t *index = getAddressIndex(elf);
+
+	if (!index || address < elf->virtualBaseAddress)
 	{
 		return NULL;
 	}
 
-	return elf->programs + index;
-}
+	/* values are descending, so this finds the first one not above the image offset, the closest symbol at or below it */
+	uint64_t imageOffset = address - elf->virtualBaseAddress;
+	uint64_t node = 1;
 
-const OrbisElfSectionHeader_t *orbisElfGetSection(OrbisElfHandle_t elf, uint16_t index)
-{
-	if (index >= elf->sectionsCount)
+	while (node <= index->count)
 	{
-		return NULL;
+		/* four levels ahead, while that is still inside the array */
+		if (node * 16 <= index->count)
+		{
+			ORBIS_ELF_PREFETCH(index->values + node * 16);
+		}
+
+		node = node * 2 + (index->values[node] > imageOffset);
 	}
 
-	return elf->sections + index;
-}
+	/* undoes the right turns taken after the match and the left turn at it */
+	while (node & 1)
+	{
+		node >>= 1;
+	}
 
-const OrbisElfModuleInfo_t *orbisElfGetImportModuleInfo(OrbisElfHandle_t elf, uint64_t index)
-{
-	if (index >= elf->importModulesCount)
+	node >>= 1;
+
+	if (!node)
 	{
 		return NULL;
 	}
 
-	return elf->importModules + index;
-}
+	const OrbisElfSymbol_t *symbol = elf->image->symbols + index->symbolIndexes[node];
+	uint64_t symbolOffset = imageOffset - index->values[node];
 
-const OrbisElfLibraryInfo_t *orbisElfGetImportLibraryInfo(OrbisElfHandle_t elf, uint64_t index)
-{
-	if (index >= elf->importLibrariesCount)
+	if (symbol->header.size && symbolOffset >= symbol->header.size)
 	{
 		return NULL;
 	}
 
-	return elf->importLibraries + index;
+	if (offset)
+	{
+		*offset = symbolOffset;
+	}
+
+	return symbol;
 }
 
-const OrbisElfLibraryInfo_t *orbisElfGetExportLibraryInfo(OrbisElfHandle_t elf, uint64_t index)
+static uint64_t dwarfRead(OrbisElfDwarfReader_t *reader, uint64_t size)
 {
-	if (index >= elf->exportLibrariesCount)
+	uint64_t value = 0;
+
+	if (!reader->isValid || size > reader->end - reader->position)
 	{
-		return NULL;
+		reader->isValid = 0;
+		return 0;
 	}
 
-	return elf->exportLibraries + index;
+	memcpy(&value, reader->data + reader->position, size);
+	reader->position += size;
+	return value;
 }
 
-const OrbisElfSymbol_t *orbisElfGetSymbol(OrbisElfHandle_t elf, uint64_t index)
+static uint64_t dwarfReadUleb(OrbisElfDwarfReader_t *reader)
 {
-	if (index >= elf->symbolsCount)
+	uint64_t value = 0;
+
+	for (unsigned shift = 0; reader->isValid; shift += 7)
 	{
-		return NULL;
+		uint8_t byte = (uint8_t)dwarfRead(reader, 1);
+		value |= shift < 64 ? (uint64_t)(byte & 0x7f) << shift : 0;
+
+		if (!(byte & 0x80))
+		{
+			break;
+		}
 	}
 
-	return elf->symbols + index;
+	return value;
 }
 
-const OrbisElfSymbol_t *orbisElfFindSymbolByName(OrbisElfHandle_t elf, const char *name)
+static int64_t dwarfReadSleb(OrbisElfDwarfReader_t *reader)
 {
-	for (uint16_t i = 0; i < elf->symbolsCount; ++i)
+	uint64_t value = 0;
+	unsigned shift = 0;
+	uint8_t byte = 0;
+
+	while (reader->isValid)
 	{
-		if (strcmp(elf->symbols[i].name, name) == 0)
+		byte = (uint8_t)dwarfRead(reader, 1);
+		value |= shift < 64 ? (uint64_t)(byte & 0x7f) << shift : 0;
+		shift += 7;
+
+		if (!(byte & 0x80))
 		{
-			return elf->symbols + i;
+			break;
 		}
 	}
 
-	return NULL;
+	if (shift < 64 && (byte & 0x40))
+	{
+		value |= ~0ull << shift;
+	}
+
+	return (int64_t)value;
 }
 
-const OrbisElfSectionHeader_t *orbisElfFindSectionByName(OrbisElfHandle_t elf, const char *name)
+/* absolute pointers are taken as image offsets, the usual pc relative encodings need no relocation */
+static uint64_t dwarfReadPointer(OrbisElfDwarfReader_t *reader, uint8_t encoding, uint64_t dataBase)
 {
-	/*
-	for (uint16_t i = 0; i < elf->sectionsCount; ++i)
+	uint64_t fieldAddress = reader->position;
+	uint64_t value = 0;
+
+	switch (encoding & 0x0f)
 	{
-		if (strcmp(elf->sections[i].name, name) == 0)
-		{
-			return elf->sections + i;
-		}
+	case DW_EH_PE_absptr:
+	case DW_EH_PE_udata8:
+	case DW_EH_PE_sdata8: value = dwarfRead(reader, 8); break;
+	case DW_EH_PE_uleb128: value = dwarfReadUleb(reader); break;
+	case DW_EH_PE_udata2: value = dwarfRead(reader, 2); break;
+	case DW_EH_PE_udata4: value = dwarfRead(reader, 4); break;
+	case DW_EH_PE_sleb128: value = (uint64_t)dwarfReadSleb(reader); break;
+	case DW_EH_PE_sdata2: value = (uint64_t)(int64_t)(int16_t)dwarfRead(reader, 2); break;
+	case DW_EH_PE_sdata4: value = (uint64_t)(int64_t)(int32_t)dwarfRead(reader, 4); break;
+
+	default:
+		reader->isValid = 0;
+		return 0;
 	}
-	*/
 
-	return NULL;
+	switch (encoding & 0xf0)
+	{
+	case DW_EH_PE_absptr: return value;
+	case DW_EH_PE_pcrel: return fieldAddress + value;
+	case DW_EH_PE_datarel: return dataBase + value;
+
+	default:
+		reader->isValid = 0;
+		return 0;
+	}
 }
 
-const OrbisElfModuleInfo_t *orbisElfFindModuleById(OrbisElfHandle_t elf, uint16_t id)
+/* reads the length and CIE id of a .eh_frame entry, returns its end or 0 for the terminator */
+static uint64_t dwarfReadEntry(OrbisElfDwarfReader_t *reader, uint64_t *id, uint64_t *idPosition)
 {
-	if (elf->moduleInfo.id == id)
+	uint64_t length = dwarfRead(reader, 4);
+
+	if (length == 0xffffffff)
 	{
-		return &elf->moduleInfo;
+		length = dwarfRead(reader, 8);
 	}
 
-	for (uint64_t i = 0; i < elf->importModulesCount; ++i)
+	if (!length || length > reader->end - reader->position)
 	{
-		if (elf->importModules[i].id == id)
-		{
-			return elf->importModules + i;
-		}
+		reader->isValid &= !length;
+		return 0;
 	}
 
-	return NULL;
+	uint64_t entryEnd = reader->position + length;
+	*idPosition = reader->position;
+	*id = dwarfRead(reader, 4);
+	return reader->isValid ? entryEnd : 0;
 }
 
-const OrbisElfLibraryInfo_t *orbisElfFindLibraryById(OrbisElfHandle_t elf, uint16_t id)
+static uint8_t readCieFdeEncoding(OrbisElfDwarfReader_t *reader)
 {
-	for (uint64_t i = 0; i < elf->importLibrariesCount; ++i)
+	uint8_t version = (uint8_t)dwarfRead(reader, 1);
+	const char *augmentation = (const char *)reader->data + reader->position;
+	uint64_t augmentationLength = strnlen(augmentation, reader->end - reader->position);
+	uint8_t fdeEncoding = DW_EH_PE_absptr;
+
+	reader->position += augmentationLength;
+	dwarfRead(reader, 1);
+	dwarfReadUleb(reader);
+	dwarfReadSleb(reader);
+
+	if (version == 1)
 	{
-		if (elf->importLibraries[i].id == id)
-		{
-			return elf->importLibraries + i;
-		}
+		dwarfRead(reader, 1);
+	}
+	else
+	{
+		dwarfReadUleb(reader);
 	}
 
-	for (uint64_t i = 0; i < elf->exportLibrariesCount; ++i)
+	if (!reader->isValid || augmentation[0] != 'z')
 	{
-		if (elf->exportLibraries[i].id == id)
+		return fdeEncoding;
+	}
+
+	dwarfReadUleb(reader);
+
+	for (uint64_t i = 1; i < augmentationLength && reader->isValid; ++i)
+	{
+		switch (augmentation[i])
 		{
-			return elf->exportLibraries + i;
+		case 'L': dwarfRead(reader, 1); break;
+		case 'P': dwarfReadPointer(reader, (uint8_t)dwarfRead(reader, 1) & 0x0f, 0); break;
+		case 'R': fdeEncoding = (uint8_t)dwarfRead(reader, 1); break;
+		case 'S':
+		case 'B': break;
+
+		default:
+			return fdeEncoding;
 		}
 	}
 
-	return NULL;
+	return fdeEncoding;
 }
 
-const char *orbisElfSectionGetName(const OrbisElfSectionHeader_t *section)
+/* end of the loaded file data that holds address, 0 when it isn't loaded from the file */
+static uint64_t getLoadedDataEnd(OrbisElfHandle_t elf, uint64_t address)
 {
-	return NULL;//section->name;
-}
+	for (uint16_t i = 0; i < elf->image->programsCount; ++i)
+	{
+		const OrbisElfProgramHeader_t *program = elf->image->programs + i;
 
-uint64_t orbisElfGetRebaseRelocationsCount(OrbisElfHandle_t elf)
-{
-	return elf->rebaseRelocationsCount;
+		if ((program->type == orbisElfProgramTypeLoad || program->type == orbisElfProgramTypeSceRelRo) &&
+		    address >= program->vaddr && address - program->vaddr < program->filesz && program->vaddr + program->filesz <= elf->image->loadSize)
+		{
+			return program->vaddr + program->filesz;
+		}
+	}
+
+	return 0;
 }
 
-OrbisElfRebaseRelocation_t *orbisElfGetRebaseRelocation(OrbisElfHandle_t elf, uint64_t index)
+static int decodeFde(const uint8_t *data, uint64_t fde, uint64_t end, uint64_t *pcBegin, uint64_t *pcEnd, uint64_t *cie)
 {
-	if (index >= elf->rebaseRelocationsCount)
+	OrbisElfDwarfReader_t reader = { data, fde, end, fde < end };
+	uint64_t id = 0;
+	uint64_t idPosition = 0;
+	uint64_t entryEnd = dwarfReadEntry(&reader, &id, &idPosition);
+
+	if (!entryEnd || !id || id > idPosition)
 	{
-		return NULL;
+		return 0;
 	}
 
-	return elf->rebaseRelocations + index;
-}
+	uint64_t cieId = 1;
+	*cie = idPosition - id;
+	OrbisElfDwarfReader_t cieReader = { data, *cie, end, 1 };
+	uint64_t cieEnd = dwarfReadEntry(&cieReader, &cieId, &idPosition);
 
-uint64_t orbisElfGetImportRelocationsCount(OrbisElfHandle_t elf)
-{
-	return elf->importRelocationsCount;
+	if (!cieEnd || cieId)
+	{
+		return 0;
+	}
+
+	cieReader.end = cieEnd;
+	uint8_t encoding = readCieFdeEncoding(&cieReader);
+
+	reader.end = entryEnd;
+	*pcBegin = dwarfReadPointer(&reader, encoding, 0);
+	*pcEnd = *pcBegin + dwarfReadPointer(&reader, encoding & 0x0f, 0);
+	return reader.isValid && cieReader.isValid;
 }
 
-OrbisElfRelocation_t *orbisElfGetImportRelocation(OrbisElfHandle_t elf, uint64_t index)
+static OrbisElfFdeTable_t *allocateFdeTable(OrbisElfHandle_t elf, uint64_t count)
 {
-	if (index >= elf->importRelocationsCount)
+	OrbisElfFdeTable_t *table = allocateShared(elf, ORBIS_ELF_ALIGN_ALLOCATION(sizeof(OrbisElfFdeTable_t)) + sizeof(OrbisElfFdeEntry_t) * count);
+
+	if (table)
 	{
-		return NULL;
+		table->entries = (OrbisElfFdeEntry_t *)((uint8_t *)table + ORBIS_ELF_ALIGN_ALLOCATION(sizeof(OrbisElfFdeTable_t)));
+		table->entriesCount = 0;
 	}
 
-	return elf->importRelocations + index;
+	return table;
 }
 
-uint64_t orbisElfGetTlsRelocationsCount(OrbisElfHandle_t elf)
+static int compareFdeEntries(const void *a, const void *b)
 {
-	return elf->tlsRelocationsCount;
+	const OrbisElfFdeEntry_t *left = a;
+	const OrbisElfFdeEntry_t *right = b;
+	return (left->pcBegin > right->pcBegin) - (left->pcBegin < right->pcBegin);
 }
 
-OrbisElfRelocation_t *orbisElfGetTlsRelocation(OrbisElfHandle_t elf, uint64_t index)
+/* walks every FDE of .eh_frame, for images without a usable .eh_frame_hdr search table */
+static OrbisElfErrorCode_t buildFdeTableFromEhFrame(OrbisElfHandle_t elf, uint64_t ehFrame, uint64_t ehFrameEnd, OrbisElfFdeTable_t **result)
 {
-	if (index >= elf->tlsRelocationsCount)
+	const uint8_t *data = elf->baseAddress;
+	OrbisElfDwarfReader_t reader = { data, ehFrame, ehFrameEnd, 1 };
+	uint64_t fdesCount = 0;
+	uint64_t id = 0;
+	uint64_t idPosition = 0;
+
+	for (uint64_t entryEnd; reader.position < reader.end && (entryEnd = dwarfReadEntry(&reader, &id, &idPosition)) != 0; reader.position = entryEnd)
 	{
-		return NULL;
+		fdesCount += id != 0;
 	}
 
-	return elf->tlsRelocations + index;
-}
+	if (!reader.isValid)
+	{
+		return orbisElfErrorCodeCorruptedImage;
+	}
 
+	OrbisElfFdeTable_t *table = allocateFdeTable(elf, fdesCount);
 
-uint8_t orbisElfGetRelocationAddressSize(OrbisElfRelocation_t *rel)
-{
-	switch (rel->relType)
+	if (!table)
 	{
-	case orbisElfRelocationTypePc32:
-	case orbisElfRelocationTypeTpOff32:
-	case orbisElfRelocationTypeDtpOff32:
-		return 4;
-	
-	default:
-		return 8;
+		return orbisElfErrorCodeNoMemory;
+	}
+
+	reader.position = ehFrame;
+
+	for (uint64_t entryEnd, entry = ehFrame; reader.position < reader.end && (entryEnd = dwarfReadEntry(&reader, &id, &idPosition)) != 0; entry = reader.position = entryEnd)
+	{
+		uint64_t pcBegin;
+		uint64_t pcEnd;
+		uint64_t cie;
+
+		if (!id)
+		{
+			continue;
+		}
+
+		if (!decodeFde(data, entry, ehFrameEnd, &pcBegin, &pcEnd, &cie))
+		{
+			elfFree(elf, table);
+			return orbisElfErrorCodeCorruptedImage;
+		}
+
+		/* empty FDEs are left behind by discarded functions */
+		if (pcBegin < pcEnd && pcBegin < elf->image->loadSize)
+		{
+			table->entries[table->entriesCount].pcBegin = (uint32_t)pcBegin;
+			table->entries[table->entriesCount].fde = (uint32_t)entry;
+			table->entriesCount++;
+		}
 	}
+
+	qsort(table->entries, table->entriesCount, sizeof(OrbisElfFdeEntry_t), compareFdeEntries);
+	*result = table;
+	return orbisElfErrorCodeOk;
 }
 
-uint64_t orbisElfGetImportRelocationValue(OrbisElfHandle_t elf, OrbisElfRelocation_t *rel)
+static OrbisElfErrorCode_t buildFdeTable(OrbisElfHandle_t elf, OrbisElfFdeTable_t **result)
 {
-	const OrbisElfSymbol_t *sym = orbisElfGetSymbol(elf, rel->symbolIndex);
+	uint64_t header = elf->image->ehFrameHeaderAddress;
+	uint64_t headerEnd = getLoadedDataEnd(elf, header);
 
-	switch (rel->relType)
+	/* table entries are 32 bit image offsets */
+	if (!headerEnd || elf->image->ehFrameHeaderSize > headerEnd - header || elf->image->loadSize > UINT32_MAX)
 	{
-	case orbisElfRelocationTypeJumpSlot:
-		if (sym->header.value)
+		return orbisElfErrorCodeCorruptedImage;
+	}
+
+	OrbisElfDwarfReader_t reader = { elf->baseAddress, header, header + elf->image->ehFrameHeaderSize, 1 };
+	uint8_t version = (uint8_t)dwarfRead(&reader, 1);
+	uint8_t ehFrameEncoding = (uint8_t)dwarfRead(&reader, 1);
+	uint8_t countEncoding = (uint8_t)dwarfRead(&reader, 1);
+	uint8_t tableEncoding = (uint8_t)dwarfRead(&reader, 1);
+	uint64_t ehFrame = dwarfReadPointer(&reader, ehFrameEncoding, header);
+	uint64_t ehFrameEnd = getLoadedDataEnd(elf, ehFrame);
+
+	if (!reader.isValid || version != 1 || !ehFrameEnd)
+	{
+		return orbisElfErrorCodeCorruptedImage;
+	}
+
+	uint64_t count = countEncoding != DW_EH_PE_omit ? dwarfReadPointer(&reader, countEncoding, header) : 0;
+
+	/* linkers write a sorted table of datarel sdata4 pairs, it is used when it checks out and rebuilt from .eh_frame otherwise */
+	if (reader.isValid && countEncoding != DW_EH_PE_omit && tableEncoding == (DW_EH_PE_datarel | DW_EH_PE_sdata4) && count <= (reader.end - reader.position) / 8)
+	{
+		OrbisElfFdeTable_t *table = allocateFdeTable(elf, count);
+		int isValid = 1;
+
+		if (!table)
 		{
-			return sym->virtualBaseAddress + sym->header.value + rel->addend;
+			return orbisElfErrorCodeNoMemory;
 		}
 
-		return sym->virtualBaseAddress;
+		for (uint64_t i = 0; i < count; ++i)
+		{
+			uint64_t pcBegin = dwarfReadPointer(&reader, tableEncoding, header);
+			uint64_t fde = dwarfReadPointer(&reader, tableEncoding, header);
 
-	case orbisElfRelocationType64:
-		return sym->virtualBaseAddress + sym->header.value + rel->addend;
+			isValid &= (pcBegin < elf->image->loadSize) & (fde >= ehFrame) & (fde < ehFrameEnd) & (!i || pcBegin >= table->entries[i - 1].pcBegin);
+			table->entries[i].pcBegin = (uint32_t)pcBegin;
+			table->entries[i].fde = (uint32_t)fde;
+		}
 
-	case orbisElfRelocationTypePc32:
-		return (uint32_t)(sym->virtualBaseAddress + sym->header.value + rel->addend - (elf->virtualBaseAddress + rel->offset));
+		if (isValid)
+		{
+			table->entriesCount = count;
+			*result = table;
+			return orbisElfErrorCodeOk;
+		}
 
-	case orbisElfRelocationTypeCopy:
-		fprintf(stderr, "%s: Unexpected R_X86_64_COPY relocation in shared library\n", elf->moduleInfo.name);
-		return 0;
+		elfFree(elf, table);
+	}
 
-	case orbisElfRelocationTypeGlobDat:
-		return sym->virtualBaseAddress + sym->header.value;
+	return buildFdeTableFromEhFrame(elf, ehFrame, ehFrameEnd, result);
+}
 
-	case orbisElfRelocationTypeDtpOff64:
-		return sym->header.value + rel->addend;
+static OrbisElfErrorCode_t getFdeTable(OrbisElfHandle_t elf, const OrbisElfFdeTable_t **result)
+{
+	OrbisElfFdeTable_t *table = atomic_load_explicit(&elf->image->fdeTable, memory_order_acquire);
 
-	case orbisElfRelocationTypeDtpOff32:
-		return (uint32_t)(sym->header.value + rel->addend);
+	if (table)
+	{
+		*result = table;
+		return orbisElfErrorCodeOk;
+	}
 
-	default:
-		fprintf(stderr, "%s: Unsupported relocation type %u in imports relocations\n", elf->moduleInfo.name, rel->relType);
-		return 0;
+	if (!elf->image->ehFrameHeaderSize)
+	{
+		return orbisElfErrorCodeNotFound;
+	}
+
+	OrbisElfErrorCode_t errorCode = buildFdeTable(elf, &table);
+
+	if (errorCode != orbisElfErrorCodeOk)
+	{
+		return errorCode;
+	}
+
+	OrbisElfFdeTable_t *expected = NULL;
+
+	if (!atomic_compare_exchange_strong_explicit(&elf->image->fdeTable, &expected, table, memory_order_acq_rel, memory_order_acquire))
+	{
+		elfFree(elf, table);
+		table = expected;
 	}
+
+	*result = table;
+	return orbisElfErrorCodeOk;
 }
 
-uint64_t orbisElfGetTlsRelocationValue(OrbisElfHandle_t elf, OrbisElfRelocation_t *rel, uint64_t tlsIndex, uint64_t tlsOffset)
+OrbisElfErrorCode_t orbisElfFindFde(OrbisElfHandle_t elf, uint64_t pc, OrbisElfFde_t *fde)
 {
-	switch (rel->relType)
+	const OrbisElfFdeTable_t *table;
+
+	if (!elf->baseAddress)
 	{
-	case orbisElfRelocationTypeDtpMod64:
-		return tlsIndex;
+		return orbisElfErrorCodeInvalidValue;
+	}
 
-	case orbisElfRelocationTypeTpOff64:
-		return orbisElfGetSymbol(elf, rel->symbolIndex)->header.value - tlsOffset + rel->addend;
+	OrbisElfErrorCode_t errorCode = getFdeTable(elf, &table);
 
-	case orbisElfRelocationTypeTpOff32:
-		return (uint32_t)(orbisElfGetSymbol(elf, rel->symbolIndex)->header.value - tlsOffset + rel->addend);
+	if (errorCode != orbisElfErrorCodeOk)
+	{
+		return errorCode;
+	}
 
-	default:
-		fprintf(stderr, "%s: Unsupported relocation type %u in TLS relocations\n", elf->moduleInfo.name, rel->relType);
-		return 0;
+	if (pc < elf->virtualBaseAddress || pc - elf->virtualBaseAddress >= elf->image->loadSize)
+	{
+		return orbisElfErrorCodeNotFound;
+	}
+
+	/* last FDE that starts at or below the offset */
+	uint64_t offset = pc - elf->virtualBaseAddress;
+	uint64_t low = 0;
+	uint64_t high = table->entriesCount;
+
+	while (low < high)
+	{
+		uint64_t middle = low + (high - low) / 2;
+
+		if (table->entries[middle].pcBegin <= offset)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+
+	if (!low)
+	{
+		return orbisElfErrorCodeNotFound;
+	}
+
+	const OrbisElfFdeEntry_t *entry = table->entries + low - 1;
+	uint64_t pcBegin;
+	uint64_t pcEnd;
+	uint64_t cie;
+
+	if (!decodeFde(elf->baseAddress, entry->fde, getLoadedDataEnd(elf, entry->fde), &pcBegin, &pcEnd, &cie))
+	{
+		return orbisElfErrorCodeCorruptedImage;
+	}
+
+	if (offset < pcBegin || offset >= pcEnd)
+	{
+		return orbisElfErrorCodeNotFound;
 	}
-}
 
+	fde->pcBegin = elf->virtualBaseAddress + pcBegin;
+	fde->pcEnd = elf->virtualBaseAddress + pcEnd;
+	fde->fde = elf->virtualBaseAddress + entry->fde;
+	fde->cie = elf->virtualBaseAddress + cie;
+	return orbisElfErrorCodeOk;
+}
 
 uint64_t orbisElfGetRelocationOffset(OrbisElfRelocation_t *rel)
 {
@@ -1495,23 +4392,88 @@ const OrbisElfDynamic_t *orbisElfGetDynamics(OrbisElfHandle_t elf, uint64_t *cou
 {
 	if (count)
 	{
-		*count = elf->dynamicsCount;
+		*count = elf->image->dynamicsCount;
 	}
 
-	return elf->dynamics;
+	return elf->image->dynamics;
 }
 
 const char **orbisElfGetNeeded(OrbisElfHandle_t elf, uint64_t *count)
 {
 	if (count)
 	{
-		*count = elf->neededCount;
+		*count = elf->image->neededCount;
 	}
 
-	return elf->needed;
+	return elf->image->needed;
 }
 
 uint64_t orbisElfRead(OrbisElfHandle_t elf, uint64_t offset, void *destination, uint64_t size)
 {
-	return elf->read(offset, destination, size, elf->readUserData);
+	uint64_t result = elf->read(offset, destination, size, elf->readUserData);
+
+	if (elf->parseFlags & orbisElfParseFlagCollectStats)
+	{
+		elf->stats.readCalls++;
+		elf->stats.bytesRead += result;
+	}
+
+	return result;
+}
+
+OrbisElfErrorCode_t orbisElfGetTables(OrbisElfHandle_t elf, OrbisElfTables_t *tables)
+{
+	if (!elf->image->isValidated)
+	{
+		return orbisElfErrorCodeInvalidValue;
+	}
+
+	tables->programs = elf->image->programs;
+	tables->programsCount = elf->image->programsCount;
+	tables->symbols = elf->image->symbols;
+	tables->symbolsCount = elf->image->symbolsCount;
+	tables->rebaseRelocations = elf->image->rebaseRelocations;
+	tables->rebaseRelocationsCount = elf->image->rebaseRelocationsCount;
+	tables->importRelocations = elf->image->importRelocations;
+	tables->importRelocationsCount = elf->image->importRelocationsCount;
+	tables->tlsRelocations = elf->image->tlsRelocations;
+	tables->tlsRelocationsCount = elf->image->tlsRelocationsCount;
+	tables->loadSize = elf->image->loadSize;
+	return orbisElfErrorCodeOk;
+}
+
+uint64_t orbisElfGetDiagnosticsCount(OrbisElfHandle_t elf, OrbisElfDiagnostic_t diagnostic)
+{
+	if ((unsigned)diagnostic >= orbisElfDiagnosticCount)
+	{
+		return 0;
+	}
+
+	return atomic_load_explicit(&elf->diagnostics[diagnostic], memory_order_relaxed);
+}
+
+OrbisElfErrorCode_t orbisElfGetStats(OrbisElfHandle_t elf, OrbisElfStats_t *stats)
+{
+	if (!(elf->parseFlags & orbisElfParseFlagCollectStats))
+	{
+		return orbisElfErrorCodeInvalidValue;
+	}
+
+	*stats = elf->stats;
+	return orbisElfErrorCodeOk;
+}
+
+uint64_t orbisElfGetTimestampNs(void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER frequency;
+	LARGE_INTEGER counter;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&counter);
+	return (uint64_t)(counter.QuadPart / frequency.QuadPart * 1000000000ull + counter.QuadPart % frequency.QuadPart * 1000000000ull / frequency.QuadPart);
+#else
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return (uint64_t)time.tv_sec * 1000000000ull + time.tv_nsec;
+#endif
 }
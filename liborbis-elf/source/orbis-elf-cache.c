@@ -0,0 +1,295 @@
+#include "orbis-elf-types.h"
+#include "orbis-elf-enums.h"
+#include "orbis-elf-api.h"
+
+#include <malloc.h>
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+
+typedef struct
+{
+	OrbisElfCacheKey_t key;
+	OrbisElfHandle_t elf; /* parsed once, only cloned from, its read callback is never used again */
+} OrbisElfCacheEntry_t;
+
+typedef struct OrbisElfCache_s
+{
+	mtx_t mutex;
+
+	OrbisElfCacheEntry_t *entries;
+	uint64_t entriesCount;
+	uint64_t entriesCapacity;
+
+	uint64_t *hash; /* open addressing, entry index + 1, 0 is empty */
+	uint64_t hashCapacity;
+
+	uint64_t hitsCount;
+	uint64_t missesCount;
+} OrbisElfCache_t;
+
+static uint64_t hashKey(const OrbisElfCacheKey_t *key)
+{
+	const uint64_t values[4] = { key->device, key->inode, key->modificationTime, key->size };
+	uint64_t hash = 0xcbf29ce484222325ull;
+
+	for (int i = 0; i < 4; ++i)
+	{
+		hash = (hash ^ values[i]) * 0x100000001b3ull;
+		hash ^= hash >> 32;
+	}
+
+	return hash;
+}
+
+static int isSameKey(const OrbisElfCacheKey_t *left, const OrbisElfCacheKey_t *right)
+{
+	return left->device == right->device && left->inode == right->inode && left->modificationTime == right->modificationTime && left->size == right->size;
+}
+
+static OrbisElfErrorCode_t growHash(OrbisElfCacheHandle_t cache)
+{
+	uint64_t capacity = cache->hashCapacity ? cache->hashCapacity * 2 : 256;
+	uint64_t *hash = calloc(capacity, sizeof(uint64_t));
+
+	if (!hash)
+	{
+		return orbisElfErrorCodeNoMemory;
+	}
+
+	for (uint64_t i = 0; i < cache->entriesCount; ++i)
+	{
+		uint64_t slot = hashKey(&cache->entries[i].key) & (capacity - 1);
+
+		while (hash[slot])
+		{
+			slot = (slot + 1) & (capacity - 1);
+		}
+
+		hash[slot] = i + 1;
+	}
+
+	free(cache->hash);
+	cache->hash = hash;
+	cache->hashCapacity = capacity;
+	return orbisElfErrorCodeOk;
+}
+
+/* slot holding the entry index + 1, or the empty slot where it goes */
+static uint64_t findSlot(OrbisElfCacheHandle_t cache, const OrbisElfCacheKey_t *key)
+{
+	uint64_t slot = hashKey(key) & (cache->hashCapacity - 1);
+
+	while (cache->hash[slot] && !isSameKey(&cache->entries[cache->hash[slot] - 1].key, key))
+	{
+		slot = (slot + 1) & (cache->hashCapacity - 1);
+	}
+
+	return slot;
+}
+
+static OrbisElfHandle_t findEntry(OrbisElfCacheHandle_t cache, const OrbisElfCacheKey_t *key)
+{
+	if (!cache->hashCapacity)
+	{
+		return NULL;
+	}
+
+	uint64_t index = cache->hash[findSlot(cache, key)];
+	return index ? cache->entries[index - 1].elf : NULL;
+}
+
+static OrbisElfErrorCode_t addEntry(OrbisElfCacheHandle_t cache, const OrbisElfCacheKey_t *key, OrbisElfHandle_t elf)
+{
+	if ((cache->entriesCount + 1) * 2 > cache->hashCapacity)
+	{
+		OrbisElfErrorCode_t errorCode = growHash(cache);
+
+		if (errorCode != orbisElfErrorCodeOk)
+		{
+			return errorCode;
+		}
+	}
+
+	if (cache->entriesCount == cache->entriesCapacity)
+	{
+		uint64_t capacity = cache->entriesCapacity ? cache->entriesCapacity * 2 : 256;
+		OrbisElfCacheEntry_t *entries = realloc(cache->entries, capacity * sizeof(OrbisElfCacheEntry_t));
+
+		if (!entries)
+		{
+			return orbisElfErrorCodeNoMemory;
+		}
+
+		cache->entries = entries;
+		cache->entriesCapacity = capacity;
+	}
+
+	cache->entries[cache->entriesCount].key = *key;
+	cache->entries[cache->entriesCount].elf = elf;
+	cache->hash[findSlot(cache, key)] = ++cache->entriesCount;
+	return orbisElfErrorCodeOk;
+}
+
+OrbisElfErrorCode_t orbisElfCacheCreate(OrbisElfCacheHandle_t *cache)
+{
+	OrbisElfCacheHandle_t result = malloc(sizeof(OrbisElfCache_t));
+
+	if (!result)
+	{
+		return orbisElfErrorCodeNoMemory;
+	}
+
+	memset(result, 0, sizeof(OrbisElfCache_t));
+
+	if (mtx_init(&result->mutex, mtx_plain) != thrd_success)
+	{
+		free(result);
+		return orbisElfErrorCodeNoMemory;
+	}
+
+	*cache = result;
+	return orbisElfErrorCodeOk;
+}
+
+void orbisElfCacheDestroy(OrbisElfCacheHandle_t cache)
+{
+	/* images still used by opened handles stay alive until those are destroyed */
+	for (uint64_t i = 0; i < cache->entriesCount; ++i)
+	{
+		orbisElfDestroy(cache->entries[i].elf);
+	}
+
+	mtx_destroy(&cache->mutex);
+	free(cache->entries);
+	free(cache->hash);
+	free(cache);
+}
+
+OrbisElfErrorCode_t orbisElfCacheOpen(OrbisElfCacheHandle_t cache, const OrbisElfCacheKey_t *key, OrbisElfHandle_t *handle, OrbisElfReadCallback_t readImageCallback, size_t imageSize, void *readImageUserData, const OrbisElfParseOptions_t *options)
+{
+	mtx_lock(&cache->mutex);
+	OrbisElfHandle_t cached = findEntry(cache, key);
+	OrbisElfErrorCode_t errorCode = orbisElfErrorCodeOk;
+
+	if (cached)
+	{
+		cache->hitsCount++;
+		errorCode = orbisElfClone(cached, handle);
+		mtx_unlock(&cache->mutex);
+
+		if (errorCode == orbisElfErrorCodeOk)
+		{
+			orbisElfSetReadCallback(*handle, readImageCallback, readImageUserData);
+		}
+
+		return errorCode;
+	}
+
+	cache->missesCount++;
+	mtx_unlock(&cache->mutex);
+
+	/* parsing runs unlocked, so misses on different modules don't wait for each other */
+	OrbisElfHandle_t elf = NULL;
+	errorCode = orbisElfParseWithOptions(&elf, readImageCallback, imageSize, readImageUserData, options);
+
+	if (errorCode != orbisElfErrorCodeOk)
+	{
+		/* not cached, the caller still gets the handle to look at and destroy as after orbisElfParse */
+		*handle = elf;
+		return errorCode;
+	}
+
+	mtx_lock(&cache->mutex);
+	cached = findEntry(cache, key);
+
+	/* another thread parsed the same module meanwhile, share its image so there is one per key */
+	if (cached)
+	{
+		orbisElfDestroy(elf);
+		elf = cached;
+	}
+	else
+	{
+		errorCode = addEntry(cache, key, elf);
+	}
+
+	if (errorCode == orbisElfErrorCodeOk)
+	{
+		errorCode = orbisElfClone(elf, handle);
+	}
+	else
+	{
+		/* no room in the cache, the parsed handle is still good */
+		*handle = elf;
+		errorCode = orbisElfErrorCodeOk;
+	}
+
+	mtx_unlock(&cache->mutex);
+
+	if (errorCode == orbisElfErrorCodeOk)
+	{
+		orbisElfSetReadCallback(*handle, readImageCallback, readImageUserData);
+	}
+
+	return errorCode;
+}
+
+OrbisElfErrorCode_t orbisElfCacheRemove(OrbisElfCacheHandle_t cache, const OrbisElfCacheKey_t *key)
+{
+	mtx_lock(&cache->mutex);
+	uint64_t slot = cache->hashCapacity ? findSlot(cache, key) : 0;
+	uint64_t index = cache->hashCapacity ? cache->hash[slot] : 0;
+
+	if (!index)
+	{
+		mtx_unlock(&cache->mutex);
+		return orbisElfErrorCodeNotFound;
+	}
+
+	uint64_t mask = cache->hashCapacity - 1;
+	OrbisElfHandle_t elf = cache->entries[index - 1].elf;
+
+	/* backward shift deletion, entries after the hole move up unless that would put them before their home slot */
+	cache->hash[slot] = 0;
+
+	for (uint64_t next = (slot + 1) & mask; cache->hash[next]; next = (next + 1) & mask)
+	{
+		uint64_t home = hashKey(&cache->entries[cache->hash[next] - 1].key) & mask;
+
+		if (((next - home) & mask) >= ((next - slot) & mask))
+		{
+			cache->hash[slot] = cache->hash[next];
+			cache->hash[next] = 0;
+			slot = next;
+		}
+	}
+
+	/* the last entry fills the gap in the array */
+	if (index != cache->entriesCount)
+	{
+		cache->hash[findSlot(cache, &cache->entries[cache->entriesCount - 1].key)] = index;
+		cache->entries[index - 1] = cache->entries[cache->entriesCount - 1];
+	}
+
+	cache->entriesCount--;
+	mtx_unlock(&cache->mutex);
+	orbisElfDestroy(elf);
+	return orbisElfErrorCodeOk;
+}
+
+uint64_t orbisElfCacheGetEntriesCount(OrbisElfCacheHandle_t cache)
+{
+	mtx_lock(&cache->mutex);
+	uint64_t count = cache->entriesCount;
+	mtx_unlock(&cache->mutex);
+	return count;
+}
+
+void orbisElfCacheGetStats(OrbisElfCacheHandle_t cache, uint64_t *hitsCount, uint64_t *missesCount)
+{
+	mtx_lock(&cache->mutex);
+	*hitsCount = cache->hitsCount;
+	*missesCount = cache->missesCount;
+	mtx_unlock(&cache->mutex);
+}
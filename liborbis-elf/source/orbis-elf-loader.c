@@ -0,0 +1,449 @@
+#include "orbis-elf-types.h"
+#include "orbis-elf-enums.h"
+#include "orbis-elf-api.h"
+
+#include <malloc.h>
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+
+#define LOADER_MAX_THREADS 64
+
+enum
+{
+	moduleStateQueued,
+	moduleStateLoaded,
+	moduleStateMissing
+};
+
+typedef struct
+{
+	const char *name; /* owned by the importing handle, which outlives the loader */
+	OrbisElfHandle_t elf;
+	int state;
+	int isLocated; /* handle comes from the locator and is released with the loader */
+	int visitState; /* for the topological sort */
+} OrbisElfLoaderModule_t;
+
+typedef struct OrbisElfLoader_s
+{
+	OrbisElfModuleLocator_t locator;
+	uint32_t threadsCount;
+	int isUsed;
+
+	/* guarded by mutex while workers run */
+	OrbisElfLoaderModule_t **modules;
+	uint64_t modulesCount;
+	uint64_t modulesCapacity;
+	uint64_t nextModule; /* modules are queued in discovery order, so the queue is [nextModule, modulesCount) */
+	uint64_t activeJobs;
+	OrbisElfErrorCode_t errorCode;
+	mtx_t mutex;
+	cnd_t changed;
+
+	OrbisElfLoaderModule_t **order; /* loaded modules, dependencies first */
+	uint64_t orderCount;
+
+	const char **missing;
+	uint64_t missingCount;
+
+	OrbisElfInitializer_t *initializers;
+	uint64_t initializersCount;
+} OrbisElfLoader_t;
+
+static OrbisElfLoaderModule_t *findModule(OrbisElfLoaderHandle_t loader, const char *name)
+{
+	for (uint64_t i = 0; i < loader->modulesCount; ++i)
+	{
+		if (strcmp(loader->modules[i]->name, name) == 0)
+		{
+			return loader->modules[i];
+		}
+	}
+
+	return NULL;
+}
+
+/* called with the mutex locked */
+static OrbisElfErrorCode_t queueModule(OrbisElfLoaderHandle_t loader, const char *name, OrbisElfHandle_t elf)
+{
+	if (findModule(loader, name))
+	{
+		return orbisElfErrorCodeOk;
+	}
+
+	if (loader->modulesCount == loader->modulesCapacity)
+	{
+		uint64_t capacity = loader->modulesCapacity ? loader->modulesCapacity * 2 : 16;
+		OrbisElfLoaderModule_t **modules = realloc(loader->modules, capacity * sizeof(OrbisElfLoaderModule_t *));
+
+		if (!modules)
+		{
+			return orbisElfErrorCodeNoMemory;
+		}
+
+		loader->modules = modules;
+		loader->modulesCapacity = capacity;
+	}
+
+	OrbisElfLoaderModule_t *module = malloc(sizeof(OrbisElfLoaderModule_t));
+
+	if (!module)
+	{
+		return orbisElfErrorCodeNoMemory;
+	}
+
+	memset(module, 0, sizeof(OrbisElfLoaderModule_t));
+	module->name = name;
+	module->elf = elf;
+	module->state = moduleStateQueued;
+	loader->modules[loader->modulesCount++] = module;
+	return orbisElfErrorCodeOk;
+}
+
+static OrbisElfErrorCode_t loadModule(OrbisElfLoaderHandle_t loader, OrbisElfLoaderModule_t *module)
+{
+	OrbisElfErrorCode_t errorCode;
+
+	if (!module->elf)
+	{
+		errorCode = loader->locator.locate(module->name, &module->elf, loader->locator.userData);
+
+		if (errorCode == orbisElfErrorCodeNotFound)
+		{
+			module->elf = NULL;
+			module->state = moduleStateMissing;
+			return orbisElfErrorCodeOk;
+		}
+
+		if (errorCode != orbisElfErrorCodeOk)
+		{
+			module->elf = NULL;
+			return errorCode;
+		}
+
+		module->isLocated = 1;
+	}
+
+	if (!orbisElfGetBaseAddress(module->elf))
+	{
+		void *baseAddress = NULL;
+		uint64_t virtualBaseAddress = 0;
+
+		errorCode = loader->locator.map(module->elf, &baseAddress, &virtualBaseAddress, loader->locator.userData);
+
+		if (errorCode != orbisElfErrorCodeOk)
+		{
+			return errorCode;
+		}
+
+		errorCode = orbisElfLoad(module->elf, baseAddress, virtualBaseAddress);
+
+		if (errorCode != orbisElfErrorCodeOk)
+		{
+			return errorCode;
+		}
+	}
+
+	module->state = moduleStateLoaded;
+	return orbisElfErrorCodeOk;
+}
+
+static int loaderWorker(void *argument)
+{
+	OrbisElfLoaderHandle_t loader = argument;
+
+	mtx_lock(&loader->mutex);
+
+	for (;;)
+	{
+		while (loader->errorCode == orbisElfErrorCodeOk && loader->nextModule == loader->modulesCount && loader->activeJobs)
+		{
+			cnd_wait(&loader->changed, &loader->mutex);
+		}
+
+		if (loader->errorCode != orbisElfErrorCodeOk || loader->nextModule == loader->modulesCount)
+		{
+			break;
+		}
+
+		OrbisElfLoaderModule_t *module = loader->modules[loader->nextModule++];
+		loader->activeJobs++;
+		mtx_unlock(&loader->mutex);
+
+		/* locating, parsing and copying segments is independent for every module */
+		OrbisElfErrorCode_t errorCode = loadModule(loader, module);
+
+		mtx_lock(&loader->mutex);
+
+		if (errorCode == orbisElfErrorCodeOk && module->state == moduleStateLoaded)
+		{
+			for (uint64_t i = 0, count = orbisElfGetImportModulesCount(module->elf); i < count && errorCode == orbisElfErrorCodeOk; ++i)
+			{
+				errorCode = queueModule(loader, orbisElfGetImportModuleInfo(module->elf, i)->name, NULL);
+			}
+		}
+
+		if (errorCode != orbisElfErrorCodeOk && loader->errorCode == orbisElfErrorCodeOk)
+		{
+			loader->errorCode = errorCode;
+		}
+
+		loader->activeJobs--;
+		cnd_broadcast(&loader->changed);
+	}
+
+	mtx_unlock(&loader->mutex);
+	return 0;
+}
+
+static void visitModule(OrbisElfLoaderHandle_t loader, OrbisElfLoaderModule_t *module)
+{
+	/* post-order DFS, a module that is still being visited is a cycle and keeps its first position */
+	if (module->visitState)
+	{
+		return;
+	}
+
+	module->visitState = 1;
+
+	if (module->state == moduleStateLoaded)
+	{
+		for (uint64_t i = 0, count = orbisElfGetImportModulesCount(module->elf); i < count; ++i)
+		{
+			visitModule(loader, findModule(loader, orbisElfGetImportModuleInfo(module->elf, i)->name));
+		}
+
+		loader->order[loader->orderCount++] = module;
+	}
+	else
+	{
+		loader->missing[loader->missingCount++] = module->name;
+	}
+
+	module->visitState = 2;
+}
+
+static void addInitializer(OrbisElfLoaderHandle_t loader, OrbisElfHandle_t elf, OrbisElfInitializerType_t type, uint64_t address, uint64_t count)
+{
+	if (!address || !count)
+	{
+		return;
+	}
+
+	OrbisElfInitializer_t *initializer = loader->initializers + loader->initializersCount++;
+	initializer->elf = elf;
+	initializer->type = type;
+	initializer->address = orbisElfGetVirtualBaseAddress(elf) + address;
+	initializer->count = count;
+}
+
+static OrbisElfErrorCode_t buildInitializers(OrbisElfLoaderHandle_t loader, OrbisElfHandle_t root)
+{
+	/* preinit array (root only), then init and init array of every module, then finalizers in reverse */
+	loader->initializers = malloc(sizeof(OrbisElfInitializer_t) * (1 + loader->orderCount * 4));
+
+	if (!loader->initializers)
+	{
+		return orbisElfErrorCodeNoMemory;
+	}
+
+	uint64_t count;
+	uint64_t address = orbisElfGetPreinitArray(root, &count);
+	addInitializer(loader, root, orbisElfInitializerTypePreinitArray, address, count);
+
+	for (uint64_t i = 0; i < loader->orderCount; ++i)
+	{
+		OrbisElfHandle_t elf = loader->order[i]->elf;
+		addInitializer(loader, elf, orbisElfInitializerTypeInit, orbisElfGetInitAddress(elf), 1);
+		address = orbisElfGetInitArray(elf, &count);
+		addInitializer(loader, elf, orbisElfInitializerTypeInitArray, address, count);
+	}
+
+	for (uint64_t i = loader->orderCount; i > 0; --i)
+	{
+		OrbisElfHandle_t elf = loader->order[i - 1]->elf;
+		address = orbisElfGetFiniArray(elf, &count);
+		addInitializer(loader, elf, orbisElfInitializerTypeFiniArray, address, count);
+		addInitializer(loader, elf, orbisElfInitializerTypeFini, orbisElfGetFiniAddress(elf), 1);
+	}
+
+	return orbisElfErrorCodeOk;
+}
+
+OrbisElfErrorCode_t orbisElfLoaderCreate(OrbisElfLoaderHandle_t *loader, const OrbisElfModuleLocator_t *locator, uint32_t threadsCount)
+{
+	if (!locator->locate || !locator->map)
+	{
+		return orbisElfErrorCodeInvalidValue;
+	}
+
+	OrbisElfLoaderHandle_t result = malloc(sizeof(OrbisElfLoader_t));
+
+	if (!result)
+	{
+		return orbisElfErrorCodeNoMemory;
+	}
+
+	memset(result, 0, sizeof(OrbisElfLoader_t));
+	result->locator = *locator;
+	result->threadsCount = threadsCount == 0 ? 1 : threadsCount > LOADER_MAX_THREADS ? LOADER_MAX_THREADS : threadsCount;
+
+	if (mtx_init(&result->mutex, mtx_plain) != thrd_success)
+	{
+		free(result);
+		return orbisElfErrorCodeNoMemory;
+	}
+
+	if (cnd_init(&result->changed) != thrd_success)
+	{
+		mtx_destroy(&result->mutex);
+		free(result);
+		return orbisElfErrorCodeNoMemory;
+	}
+
+	*loader = result;
+	return orbisElfErrorCodeOk;
+}
+
+OrbisElfErrorCode_t orbisElfLoaderLoad(OrbisElfLoaderHandle_t loader, OrbisElfHandle_t root)
+{
+	/* modules are keyed by name, a root without DT_SCE_MODULE_INFO has none */
+	if (loader->isUsed || !orbisElfGetModuleInfo(root)->name)
+	{
+		return orbisElfErrorCodeInvalidValue;
+	}
+
+	loader->isUsed = 1;
+
+	OrbisElfErrorCode_t errorCode = queueModule(loader, orbisElfGetModuleInfo(root)->name, root);
+
+	if (errorCode != orbisElfErrorCodeOk)
+	{
+		return errorCode;
+	}
+
+	thrd_t threads[LOADER_MAX_THREADS];
+	uint32_t threadsCount = 0;
+
+	for (uint32_t i = 1; i < loader->threadsCount; ++i)
+	{
+		if (thrd_create(threads + threadsCount, loaderWorker, loader) == thrd_success)
+		{
+			++threadsCount;
+		}
+	}
+
+	loaderWorker(loader);
+
+	for (uint32_t i = 0; i < threadsCount; ++i)
+	{
+		thrd_join(threads[i], NULL);
+	}
+
+	if (loader->errorCode != orbisElfErrorCodeOk)
+	{
+		return loader->errorCode;
+	}
+
+	loader->order = malloc(sizeof(OrbisElfLoaderModule_t *) * loader->modulesCount);
+	loader->missing = malloc(sizeof(const char *) * loader->modulesCount);
+
+	if (!loader->order || !loader->missing)
+	{
+		return orbisElfErrorCodeNoMemory;
+	}
+
+	visitModule(loader, loader->modules[0]);
+
+	/* bind every module after its dependencies, so their own imports are already resolved */
+	for (uint64_t i = 0; i < loader->orderCount; ++i)
+	{
+		OrbisElfHandle_t elf = loader->order[i]->elf;
+
+		for (uint64_t j = 0, count = orbisElfGetImportModulesCount(elf); j < count; ++j)
+		{
+			OrbisElfLoaderModule_t *dependency = findModule(loader, orbisElfGetImportModuleInfo(elf, j)->name);
+
+			if (dependency->state != moduleStateLoaded)
+			{
+				continue;
+			}
+
+			errorCode = orbisElfImportModule(elf, dependency->elf);
+
+			if (errorCode != orbisElfErrorCodeOk)
+			{
+				return errorCode;
+			}
+		}
+	}
+
+	return buildInitializers(loader, root);
+}
+
+uint64_t orbisElfLoaderGetModulesCount(OrbisElfLoaderHandle_t loader)
+{
+	return loader->orderCount;
+}
+
+OrbisElfHandle_t orbisElfLoaderGetModule(OrbisElfLoaderHandle_t loader, uint64_t index)
+{
+	if (index >= loader->orderCount)
+	{
+		return NULL;
+	}
+
+	return loader->order[index]->elf;
+}
+
+uint64_t orbisElfLoaderGetMissingModulesCount(OrbisElfLoaderHandle_t loader)
+{
+	return loader->missingCount;
+}
+
+const char *orbisElfLoaderGetMissingModule(OrbisElfLoaderHandle_t loader, uint64_t index)
+{
+	if (index >= loader->missingCount)
+	{
+		return NULL;
+	}
+
+	return loader->missing[index];
+}
+
+uint64_t orbisElfLoaderGetInitializersCount(OrbisElfLoaderHandle_t loader)
+{
+	return loader->initializersCount;
+}
+
+const OrbisElfInitializer_t *orbisElfLoaderGetInitializer(OrbisElfLoaderHandle_t loader, uint64_t index)
+{
+	if (index >= loader->initializersCount)
+	{
+		return NULL;
+	}
+
+	return loader->initializers + index;
+}
+
+void orbisElfLoaderDestroy(OrbisElfLoaderHandle_t loader)
+{
+	for (uint64_t i = 0; i < loader->modulesCount; ++i)
+	{
+		if (loader->modules[i]->isLocated && loader->locator.release)
+		{
+			loader->locator.release(loader->modules[i]->elf, loader->locator.userData);
+		}
+
+		free(loader->modules[i]);
+	}
+
+	cnd_destroy(&loader->changed);
+	mtx_destroy(&loader->mutex);
+	free(loader->modules);
+	free(loader->order);
+	free((void *)loader->missing);
+	free(loader->initializers);
+	free(loader);
+}
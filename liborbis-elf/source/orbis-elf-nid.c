@@ -0,0 +1,353 @@
+#include "orbis-elf-types.h"
+#include "orbis-elf-enums.h"
+#include "orbis-elf-api.h"
+
+#include <string.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+	#include <immintrin.h>
+	#define NID_HAVE_SSE2 1
+
+	#if defined(__GNUC__) || defined(__clang__)
+		#define NID_HAVE_AVX2 1
+	#endif
+#endif
+
+#define NID_MAX_LANES 8
+
+static const char nidAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+-";
+
+static const uint8_t nidSuffix[16] = {
+	0x51, 0x8d, 0x64, 0xa6, 0x35, 0xde, 0xd8, 0xc1, 0xe6, 0xb0, 0x39, 0xb1, 0xc3, 0xe5, 0x52, 0x30
+};
+
+static const uint32_t sha1InitialState[5] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0 };
+
+typedef void (*Sha1LanesFunction_t)(const uint32_t *words, uint32_t *state);
+
+#define SHA1_LANES_FUNCTION sha1Lanes1
+#define SHA1_LANES_TARGET
+#define SHA1_LANES 1
+#define SHA1_VEC uint32_t
+#define SHA1_LOAD(p) (*(p))
+#define SHA1_STORE(p, v) (*(p) = (v))
+#define SHA1_SET1(x) ((uint32_t)(x))
+#define SHA1_ADD(a, b) ((a) + (b))
+#define SHA1_XOR(a, b) ((a) ^ (b))
+#define SHA1_AND(a, b) ((a) & (b))
+#define SHA1_OR(a, b) ((a) | (b))
+#define SHA1_ANDNOT(a, b) (~(a) & (b))
+#define SHA1_SLL(a, n) ((a) << (n))
+#define SHA1_SRL(a, n) ((a) >> (n))
+#include "orbis-elf-sha1-lanes.inl"
+#undef SHA1_LANES_FUNCTION
+#undef SHA1_LANES_TARGET
+#undef SHA1_LANES
+#undef SHA1_VEC
+#undef SHA1_LOAD
+#undef SHA1_STORE
+#undef SHA1_SET1
+#undef SHA1_ADD
+#undef SHA1_XOR
+#undef SHA1_AND
+#undef SHA1_OR
+#undef SHA1_ANDNOT
+#undef SHA1_SLL
+#undef SHA1_SRL
+
+#ifdef NID_HAVE_SSE2
+#define SHA1_LANES_FUNCTION sha1Lanes4
+#define SHA1_LANES_TARGET
+#define SHA1_LANES 4
+#define SHA1_VEC __m128i
+#define SHA1_LOAD(p) _mm_loadu_si128((const __m128i *)(p))
+#define SHA1_STORE(p, v) _mm_storeu_si128((__m128i *)(p), (v))
+#define SHA1_SET1(x) _mm_set1_epi32((int)(x))
+#define SHA1_ADD(a, b) _mm_add_epi32((a), (b))
+#define SHA1_XOR(a, b) _mm_xor_si128((a), (b))
+#define SHA1_AND(a, b) _mm_and_si128((a), (b))
+#define SHA1_OR(a, b) _mm_or_si128((a), (b))
+#define SHA1_ANDNOT(a, b) _mm_andnot_si128((a), (b))
+#define SHA1_SLL(a, n) _mm_slli_epi32((a), (n))
+#define SHA1_SRL(a, n) _mm_srli_epi32((a), (n))
+#include "orbis-elf-sha1-lanes.inl"
+#undef SHA1_LANES_FUNCTION
+#undef SHA1_LANES_TARGET
+#undef SHA1_LANES
+#undef SHA1_VEC
+#undef SHA1_LOAD
+#undef SHA1_STORE
+#undef SHA1_SET1
+#undef SHA1_ADD
+#undef SHA1_XOR
+#undef SHA1_AND
+#undef SHA1_OR
+#undef SHA1_ANDNOT
+#undef SHA1_SLL
+#undef SHA1_SRL
+#endif
+
+#ifdef NID_HAVE_AVX2
+#define SHA1_LANES_FUNCTION sha1Lanes8
+#define SHA1_LANES_TARGET __attribute__((target("avx2")))
+#define SHA1_LANES 8
+#define SHA1_VEC __m256i
+#define SHA1_LOAD(p) _mm256_loadu_si256((const __m256i *)(p))
+#define SHA1_STORE(p, v) _mm256_storeu_si256((__m256i *)(p), (v))
+#define SHA1_SET1(x) _mm256_set1_epi32((int)(x))
+#define SHA1_ADD(a, b) _mm256_add_epi32((a), (b))
+#define SHA1_XOR(a, b) _mm256_xor_si256((a), (b))
+#define SHA1_AND(a, b) _mm256_and_si256((a), (b))
+#define SHA1_OR(a, b) _mm256_or_si256((a), (b))
+#define SHA1_ANDNOT(a, b) _mm256_andnot_si256((a), (b))
+#define SHA1_SLL(a, n) _mm256_slli_epi32((a), (n))
+#define SHA1_SRL(a, n) _mm256_srli_epi32((a), (n))
+#include "orbis-elf-sha1-lanes.inl"
+#undef SHA1_LANES_FUNCTION
+#undef SHA1_LANES_TARGET
+#undef SHA1_LANES
+#undef SHA1_VEC
+#undef SHA1_LOAD
+#undef SHA1_STORE
+#undef SHA1_SET1
+#undef SHA1_ADD
+#undef SHA1_XOR
+#undef SHA1_AND
+#undef SHA1_OR
+#undef SHA1_ANDNOT
+#undef SHA1_SLL
+#undef SHA1_SRL
+#endif
+
+typedef struct
+{
+	const char *name;
+	uint64_t nameLength;
+	uint64_t blocksCount;
+	uint64_t block;
+	uint64_t index;
+} NidLane_t;
+
+/* writes block of name + suffix + SHA-1 padding as words[i * stride] */
+static void loadNidBlock(const NidLane_t *lane, uint32_t *words, int stride)
+{
+	uint8_t bytes[64];
+	uint64_t messageLength = lane->nameLength + sizeof(nidSuffix);
+	uint64_t begin = lane->block * 64;
+	uint64_t position = 0;
+
+	memset(bytes, 0, sizeof(bytes));
+
+	if (begin < lane->nameLength)
+	{
+		position = lane->nameLength - begin < 64 ? lane->nameLength - begin : 64;
+		memcpy(bytes, lane->name + begin, position);
+	}
+
+	for (; position < 64 && begin + position < messageLength; ++position)
+	{
+		bytes[position] = nidSuffix[begin + position - lane->nameLength];
+	}
+
+	if (position < 64 && begin + position == messageLength)
+	{
+		bytes[position] = 0x80;
+	}
+
+	if (lane->block + 1 == lane->blocksCount)
+	{
+		uint64_t bitsLength = messageLength * 8;
+
+		for (int i = 0; i < 8; ++i)
+		{
+			bytes[56 + i] = (uint8_t)(bitsLength >> (56 - i * 8));
+		}
+	}
+
+	for (int i = 0; i < 16; ++i)
+	{
+		words[i * stride] = ((uint32_t)bytes[i * 4] << 24) | ((uint32_t)bytes[i * 4 + 1] << 16) | ((uint32_t)bytes[i * 4 + 2] << 8) | bytes[i * 4 + 3];
+	}
+}
+
+static void computeNidsWithLanes(const char *const *names, uint64_t count, uint64_t *nids, int lanesCount, Sha1LanesFunction_t compress)
+{
+	NidLane_t lanes[NID_MAX_LANES];
+	uint32_t words[16 * NID_MAX_LANES];
+	uint32_t state[5 * NID_MAX_LANES];
+	uint32_t nextState[5 * NID_MAX_LANES];
+	uint64_t next = 0;
+	int active = 0;
+
+	for (int lane = 0; lane < lanesCount; ++lane)
+	{
+		lanes[lane].name = NULL;
+	}
+
+	/* every lane takes the next name as soon as its current one is done, so long names don't stall the others */
+	for (;;)
+	{
+		for (int lane = 0; lane < lanesCount; ++lane)
+		{
+			if (lanes[lane].name || next >= count)
+			{
+				continue;
+			}
+
+			lanes[lane].name = names[next];
+			lanes[lane].nameLength = strlen(names[next]);
+			lanes[lane].blocksCount = (lanes[lane].nameLength + sizeof(nidSuffix) + 9 + 63) / 64;
+			lanes[lane].block = 0;
+			lanes[lane].index = next++;
+
+			for (int i = 0; i < 5; ++i)
+			{
+				state[i * lanesCount + lane] = sha1InitialState[i];
+			}
+
+			++active;
+		}
+
+		if (!active)
+		{
+			break;
+		}
+
+		for (int lane = 0; lane < lanesCount; ++lane)
+		{
+			if (lanes[lane].name)
+			{
+				loadNidBlock(lanes + lane, words + lane, lanesCount);
+			}
+			else
+			{
+				for (int i = 0; i < 16; ++i)
+				{
+					words[i * lanesCount + lane] = 0;
+				}
+			}
+		}
+
+		memcpy(nextState, state, sizeof(uint32_t) * 5 * lanesCount);
+		compress(words, nextState);
+
+		for (int lane = 0; lane < lanesCount; ++lane)
+		{
+			if (!lanes[lane].name)
+			{
+				continue;
+			}
+
+			for (int i = 0; i < 5; ++i)
+			{
+				state[i * lanesCount + lane] = nextState[i * lanesCount + lane];
+			}
+
+			if (++lanes[lane].block == lanes[lane].blocksCount)
+			{
+				uint32_t h0 = state[lane];
+				uint32_t h1 = state[lanesCount + lane];
+
+				/* NID is the first 8 digest bytes read as little endian */
+				nids[lanes[lane].index] =
+					((uint64_t)(h0 >> 24)) | ((uint64_t)((h0 >> 16) & 0xff) << 8) | ((uint64_t)((h0 >> 8) & 0xff) << 16) | ((uint64_t)(h0 & 0xff) << 24) |
+					((uint64_t)(h1 >> 24) << 32) | ((uint64_t)((h1 >> 16) & 0xff) << 40) | ((uint64_t)((h1 >> 8) & 0xff) << 48) | ((uint64_t)(h1 & 0xff) << 56);
+
+				lanes[lane].name = NULL;
+				--active;
+			}
+		}
+	}
+}
+
+static int nidCharToValue(char c)
+{
+	if (c >= 'A' && c <= 'Z')
+	{
+		return c - 'A';
+	}
+
+	if (c >= 'a' && c <= 'z')
+	{
+		return c - 'a' + 26;
+	}
+
+	if (c >= '0' && c <= '9')
+	{
+		return c - '0' + 52;
+	}
+
+	switch (c)
+	{
+	case '+': return 62;
+	case '-': return 63;
+
+	default:
+		break;
+	}
+
+	return -1;
+}
+
+OrbisElfErrorCode_t orbisElfNidFromString(const char *string, uint64_t *nid)
+{
+	uint64_t result = 0;
+
+	for (int i = 0; i < 10; ++i)
+	{
+		int value = nidCharToValue(string[i]);
+
+		if (value < 0)
+		{
+			return orbisElfErrorCodeInvalidValue;
+		}
+
+		result = (result << 6) | value;
+	}
+
+	/* the last character carries only the low 4 bits of the NID */
+	int lastValue = nidCharToValue(string[10]);
+
+	if (lastValue < 0 || (lastValue & 3) || string[11] != '\0')
+	{
+		return orbisElfErrorCodeInvalidValue;
+	}
+
+	*nid = (result << 4) | (lastValue >> 2);
+	return orbisElfErrorCodeOk;
+}
+
+void orbisElfNidToString(uint64_t nid, char *string)
+{
+	for (int i = 0; i < 10; ++i)
+	{
+		string[i] = nidAlphabet[(nid >> (58 - i * 6)) & 0x3f];
+	}
+
+	string[10] = nidAlphabet[(nid & 0xf) << 2];
+	string[11] = '\0';
+}
+
+uint64_t orbisElfComputeNid(const char *name)
+{
+	uint64_t nid;
+	computeNidsWithLanes(&name, 1, &nid, 1, sha1Lanes1);
+	return nid;
+}
+
+void orbisElfComputeNids(const char *const *names, uint64_t count, uint64_t *nids)
+{
+#ifdef NID_HAVE_AVX2
+	if (__builtin_cpu_supports("avx2"))
+	{
+		computeNidsWithLanes(names, count, nids, 8, sha1Lanes8);
+		return;
+	}
+#endif
+
+#ifdef NID_HAVE_SSE2
+	computeNidsWithLanes(names, count, nids, 4, sha1Lanes4);
+#else
+	computeNidsWithLanes(names, count, nids, 1, sha1Lanes1);
+#endif
+}
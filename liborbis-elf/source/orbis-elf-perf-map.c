@@ -0,0 +1,137 @@
+#include "orbis-elf-types.h"
+#include "orbis-elf-enums.h"
+#include "orbis-elf-api.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#define PERF_MAP_PROGRAM_FLAG_EXECUTE 1
+#define PERF_MAP_MAX_LINE 1024
+
+typedef struct
+{
+	OrbisElfWriteCallback_t write;
+	void *userData;
+	uint64_t offset;
+} PerfMapWriter_t;
+
+/* one "<start> <size> <name>" line, perf reads both numbers as hex */
+static int writePerfMapLine(PerfMapWriter_t *writer, uint64_t address, uint64_t size, const char *prefix, const char *name, const char *suffix)
+{
+	char line[PERF_MAP_MAX_LINE];
+	int length = snprintf(line, sizeof(line), "%" PRIx64 " %" PRIx64 " %s:%s%s\n", address, size, prefix, name, suffix);
+
+	if (length < 0)
+	{
+		return 0;
+	}
+
+	/* overlong names are cut, the line still ends with a newline */
+	if ((size_t)length >= sizeof(line))
+	{
+		length = sizeof(line) - 1;
+		line[length - 1] = '\n';
+	}
+
+	if (writer->write(writer->offset, line, length, writer->userData) != (uint64_t)length)
+	{
+		return 0;
+	}
+
+	writer->offset += length;
+	return 1;
+}
+
+static const char *getPerfMapModuleName(OrbisElfHandle_t elf)
+{
+	const OrbisElfModuleInfo_t *moduleInfo = orbisElfGetModuleInfo(elf);
+
+	if (moduleInfo && moduleInfo->name)
+	{
+		return moduleInfo->name;
+	}
+
+	return orbisElfGetSoName(elf) ? orbisElfGetSoName(elf) : "module";
+}
+
+/* imports bound into another handle are written with that module, the rest are host stubs set by orbisElfSetImportSymbol */
+static int isStubImport(OrbisElfHandle_t elf, const OrbisElfSymbol_t *symbol)
+{
+	for (uint64_t i = 0, count = orbisElfGetImportModulesCount(elf); i < count; ++i)
+	{
+		if (orbisElfGetImportModuleInfo(elf, i) == symbol->module)
+		{
+			return orbisElfGetDependency(elf, i) == NULL;
+		}
+	}
+
+	return 1;
+}
+
+static OrbisElfErrorCode_t writePerfMapLines(OrbisElfHandle_t elf, PerfMapWriter_t *writer)
+{
+	uint64_t virtualBaseAddress = orbisElfGetVirtualBaseAddress(elf);
+	const char *moduleName = getPerfMapModuleName(elf);
+	char segmentName[32];
+
+	/* segments first, so samples in code without symbols still land in the right module */
+	for (uint16_t i = 0; i < orbisElfGetProgramsCount(elf); ++i)
+	{
+		const OrbisElfProgramHeader_t *program = orbisElfGetProgram(elf, i);
+
+		if (program->type != orbisElfProgramTypeLoad || !(program->flags & PERF_MAP_PROGRAM_FLAG_EXECUTE) || !program->memsz)
+		{
+			continue;
+		}
+
+		snprintf(segmentName, sizeof(segmentName), "segment%u", i);
+
+		if (!writePerfMapLine(writer, virtualBaseAddress + program->vaddr, program->memsz, moduleName, segmentName, ""))
+		{
+			return orbisElfErrorCodeIoError;
+		}
+	}
+
+	for (uint64_t i = 0, count = orbisElfGetSymbolsCount(elf); i < count; ++i)
+	{
+		const OrbisElfSymbol_t *symbol = orbisElfGetSymbol(elf, i);
+		OrbisElfSymbolBinding_t binding;
+
+		if (symbol->type != orbisElfSymbolTypeFunction || !symbol->name || orbisElfGetSymbolBinding(elf, i, &binding) != orbisElfErrorCodeOk)
+		{
+			continue;
+		}
+
+		int isOk = 1;
+
+		if (symbol->header.shndx && symbol->header.value && symbol->header.size)
+		{
+			isOk = writePerfMapLine(writer, virtualBaseAddress + symbol->header.value, symbol->header.size, moduleName, symbol->name, "");
+		}
+		else if (!symbol->header.value && binding.value && binding.size && isStubImport(elf, symbol))
+		{
+			isOk = writePerfMapLine(writer, binding.virtualBaseAddress + binding.value, binding.size, symbol->module ? symbol->module->name : moduleName, symbol->name, " (stub)");
+		}
+
+		if (!isOk)
+		{
+			return orbisElfErrorCodeIoError;
+		}
+	}
+
+	return orbisElfErrorCodeOk;
+}
+
+OrbisElfErrorCode_t orbisElfWritePerfMap(OrbisElfHandle_t elf, OrbisElfWriteCallback_t writeCallback, void *writeUserData, uint64_t *offset)
+{
+	if (!orbisElfGetBaseAddress(elf))
+	{
+		return orbisElfErrorCodeInvalidValue;
+	}
+
+	PerfMapWriter_t writer = { writeCallback, writeUserData, *offset };
+	OrbisElfErrorCode_t errorCode = writePerfMapLines(elf, &writer);
+	*offset = writer.offset;
+	return errorCode;
+}
@@ -0,0 +1,488 @@
+#include "orbis-elf-types.h"
+#include "orbis-elf-enums.h"
+#include "orbis-elf-api.h"
+
+#include <malloc.h>
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+
+#ifdef ORBIS_ELF_WITH_ZLIB
+	#include <zlib.h>
+#endif
+
+#define SELF_MAGIC 0x1d3d154f
+#define SELF_DIGEST_SIZE 32
+
+#define SELF_PROPERTY_ENCRYPTED (1ull << 1)
+#define SELF_PROPERTY_COMPRESSED (1ull << 3)
+#define SELF_PROPERTY_HAS_BLOCKS (1ull << 11)
+#define SELF_PROPERTY_HAS_DIGESTS (1ull << 16)
+#define SELF_PROPERTY_HAS_EXTENTS (1ull << 17)
+#define SELF_PROPERTY_BLOCK_SIZE(properties) (1ull << (12 + (((properties) >> 12) & 0xf)))
+#define SELF_PROPERTY_SEGMENT_ID(properties) (((properties) >> 20) & 0xfff)
+
+typedef struct
+{
+	uint32_t magic;
+	uint8_t version;
+	uint8_t mode;
+	uint8_t endian;
+	uint8_t attributes;
+	uint32_t keyType;
+	uint16_t headerSize;
+	uint16_t metaSize;
+	uint64_t fileSize;
+	uint16_t segmentsCount;
+	uint16_t flags;
+	uint32_t reserved;
+} SelfHeader_t;
+
+typedef struct
+{
+	uint64_t properties;
+	uint64_t offset;
+	uint64_t compressedSize;
+	uint64_t decompressedSize;
+} SelfSegment_t;
+
+typedef struct
+{
+	uint32_t offset; /* from the start of the segment data */
+	uint32_t size;
+} SelfExtent_t;
+
+typedef struct
+{
+	uint64_t elfOffset;
+	uint64_t size;
+	uint64_t selfOffset;
+
+	/* compressed segments only, blocks are decompressed one at a time on first touch */
+	uint64_t decompressedSize;
+	uint64_t blockSize;
+	SelfExtent_t *extents;
+} SelfRange_t;
+
+typedef struct OrbisElfSelf_s
+{
+	OrbisElfReadCallback_t read;
+	void *readUserData;
+	uint64_t imageSize; /* of the inner ELF */
+
+	SelfRange_t *ranges; /* by elfOffset */
+	uint64_t rangesCount;
+
+	mtx_t mutex; /* the decompressed block below is shared by all reads */
+	uint8_t *block;
+	uint8_t *compressed;
+	uint64_t blockRange; /* range index + 1, 0 when no block is decompressed */
+	uint64_t blockIndex;
+} OrbisElfSelf_t;
+
+static int compareSelfRanges(const void *a, const void *b)
+{
+	const SelfRange_t *left = a;
+	const SelfRange_t *right = b;
+	return (left->elfOffset > right->elfOffset) - (left->elfOffset < right->elfOffset);
+}
+
+static int isInFile(uint64_t offset, uint64_t size, uint64_t fileSize)
+{
+	return offset <= fileSize && size <= fileSize - offset;
+}
+
+#ifdef ORBIS_ELF_WITH_ZLIB
+static OrbisElfErrorCode_t readExtents(OrbisElfSelfHandle_t self, const SelfSegment_t *segments, uint16_t segmentsCount, uint16_t segmentIndex, SelfRange_t *range, uint64_t fileSize)
+{
+	const SelfSegment_t *segment = segments + segmentIndex;
+	uint64_t blocksCount = range->decompressedSize / range->blockSize + (range->decompressedSize % range->blockSize != 0);
+
+	range->extents = malloc(sizeof(SelfExtent_t) * (blocksCount ? blocksCount : 1));
+
+	if (!range->extents)
+	{
+		return orbisElfErrorCodeNoMemory;
+	}
+
+	/* without extents the whole segment is one compressed block */
+	if (!(segment->properties & SELF_PROPERTY_HAS_EXTENTS))
+	{
+		if (segment->compressedSize > UINT32_MAX)
+		{
+			return orbisElfErrorCodeCorruptedImage;
+		}
+
+		range->blockSize = range->decompressedSize;
+		range->extents[0].offset = 0;
+		range->extents[0].size = (uint32_t)segment->compressedSize;
+		return orbisElfErrorCodeOk;
+	}
+
+	/* digests and extents of a blocked segment are in the segment whose id is its index */
+	const SelfSegment_t *info = NULL;
+
+	for (uint16_t i = 0; i < segmentsCount && !info; ++i)
+	{
+		if (!(segments[i].properties & SELF_PROPERTY_HAS_BLOCKS) && SELF_PROPERTY_SEGMENT_ID(segments[i].properties) == segmentIndex)
+		{
+			info = segments + i;
+		}
+	}
+
+	uint64_t digestsSize = segment->properties & SELF_PROPERTY_HAS_DIGESTS ? blocksCount * SELF_DIGEST_SIZE : 0;
+
+	if (!info || (info->properties & (SELF_PROPERTY_ENCRYPTED | SELF_PROPERTY_COMPRESSED)) ||
+	    digestsSize + blocksCount * sizeof(SelfExtent_t) > info->compressedSize || !isInFile(info->offset, info->compressedSize, fileSize))
+	{
+		return orbisElfErrorCodeCorruptedImage;
+	}
+
+	uint64_t extentsSize = blocksCount * sizeof(SelfExtent_t);
+
+	if (self->read(info->offset + digestsSize, range->extents, extentsSize, self->readUserData) != extentsSize)
+	{
+		return orbisElfErrorCodeIoError;
+	}
+
+	for (uint64_t i = 0; i < blocksCount; ++i)
+	{
+		if ((uint64_t)range->extents[i].offset + range->extents[i].size > segment->compressedSize)
+		{
+			return orbisElfErrorCodeCorruptedImage;
+		}
+	}
+
+	return orbisElfErrorCodeOk;
+}
+#endif
+
+static OrbisElfErrorCode_t addSegmentRange(OrbisElfSelfHandle_t self, const SelfSegment_t *segments, uint16_t segmentsCount, uint16_t segmentIndex,
+	const OrbisElfProgramHeader_t *programs, uint16_t programsCount, uint64_t fileSize)
+{
+	const SelfSegment_t *segment = segments + segmentIndex;
+	uint64_t programIndex = SELF_PROPERTY_SEGMENT_ID(segment->properties);
+
+	if (programIndex >= programsCount || !isInFile(segment->offset, segment->compressedSize, fileSize))
+	{
+		return orbisElfErrorCodeCorruptedImage;
+	}
+
+	/* only fake signed images are readable, the contents of encrypted ones need the console keys */
+	if (segment->properties & SELF_PROPERTY_ENCRYPTED)
+	{
+		return orbisElfErrorCodeInvalidValue;
+	}
+
+	SelfRange_t *range = self->ranges + self->rangesCount++;
+	memset(range, 0, sizeof(SelfRange_t));
+	range->elfOffset = programs[programIndex].offset;
+	range->selfOffset = segment->offset;
+
+	if (!(segment->properties & SELF_PROPERTY_COMPRESSED))
+	{
+		range->size = programs[programIndex].filesz < segment->compressedSize ? programs[programIndex].filesz : segment->compressedSize;
+		return orbisElfErrorCodeOk;
+	}
+
+#ifdef ORBIS_ELF_WITH_ZLIB
+	range->size = programs[programIndex].filesz < segment->decompressedSize ? programs[programIndex].filesz : segment->decompressedSize;
+	range->decompressedSize = segment->decompressedSize;
+	range->blockSize = SELF_PROPERTY_BLOCK_SIZE(segment->properties);
+	return readExtents(self, segments, segmentsCount, segmentIndex, range, fileSize);
+#else
+	(void)segmentsCount;
+	return orbisElfErrorCodeInvalidValue;
+#endif
+}
+
+static OrbisElfErrorCode_t openSelf(OrbisElfSelfHandle_t self, uint64_t fileSize)
+{
+	SelfHeader_t header;
+
+	if (fileSize < sizeof(header))
+	{
+		return orbisElfErrorCodeInvalidImageFormat;
+	}
+
+	if (self->read(0, &header, sizeof(header), self->readUserData) != sizeof(header))
+	{
+		return orbisElfErrorCodeIoError;
+	}
+
+	if (header.magic != SELF_MAGIC)
+	{
+		return orbisElfErrorCodeInvalidImageFormat;
+	}
+
+	uint64_t elfOffset = sizeof(SelfHeader_t) + header.segmentsCount * sizeof(SelfSegment_t);
+	OrbisElfHeader_t elfHeader;
+
+	if (!isInFile(elfOffset, sizeof(elfHeader), fileSize))
+	{
+		return orbisElfErrorCodeCorruptedImage;
+	}
+
+	SelfSegment_t *segments = malloc(sizeof(SelfSegment_t) * (header.segmentsCount ? header.segmentsCount : 1));
+	OrbisElfProgramHeader_t *programs = NULL;
+	OrbisElfErrorCode_t errorCode = orbisElfErrorCodeOk;
+
+	if (!segments)
+	{
+		return orbisElfErrorCodeNoMemory;
+	}
+
+	if (self->read(sizeof(SelfHeader_t), segments, header.segmentsCount * sizeof(SelfSegment_t), self->readUserData) != header.segmentsCount * sizeof(SelfSegment_t) ||
+	    self->read(elfOffset, &elfHeader, sizeof(elfHeader), self->readUserData) != sizeof(elfHeader))
+	{
+		errorCode = orbisElfErrorCodeIoError;
+	}
+	else if (memcmp(elfHeader.magic, "\x7f" "ELF", 4) != 0 || elfHeader.phentsize != sizeof(OrbisElfProgramHeader_t) ||
+	         !isInFile(elfHeader.phoff, elfHeader.phnum * sizeof(OrbisElfProgramHeader_t), fileSize - elfOffset))
+	{
+		errorCode = orbisElfErrorCodeCorruptedImage;
+	}
+	else if (!(programs = malloc(sizeof(OrbisElfProgramHeader_t) * (elfHeader.phnum ? elfHeader.phnum : 1))) ||
+	         !(self->ranges = malloc(sizeof(SelfRange_t) * (header.segmentsCount + 1))))
+	{
+		errorCode = orbisElfErrorCodeNoMemory;
+	}
+	else if (self->read(elfOffset + elfHeader.phoff, programs, elfHeader.phnum * sizeof(OrbisElfProgramHeader_t), self->readUserData) != elfHeader.phnum * sizeof(OrbisElfProgramHeader_t))
+	{
+		errorCode = orbisElfErrorCodeIoError;
+	}
+
+	if (errorCode == orbisElfErrorCodeOk)
+	{
+		/* the ELF and program headers are stored as is right after the segment table */
+		SelfRange_t *range = self->ranges + self->rangesCount++;
+		memset(range, 0, sizeof(SelfRange_t));
+		range->selfOffset = elfOffset;
+		range->size = elfHeader.phoff + elfHeader.phnum * sizeof(OrbisElfProgramHeader_t);
+		range->size = range->size > sizeof(elfHeader) ? range->size : sizeof(elfHeader);
+	}
+
+	for (uint16_t i = 0; i < header.segmentsCount && errorCode == orbisElfErrorCodeOk; ++i)
+	{
+		if (segments[i].properties & SELF_PROPERTY_HAS_BLOCKS)
+		{
+			errorCode = addSegmentRange(self, segments, header.segmentsCount, i, programs, elfHeader.phnum, fileSize);
+		}
+	}
+
+	free(programs);
+	free(segments);
+
+	if (errorCode != orbisElfErrorCodeOk)
+	{
+		return errorCode;
+	}
+
+	qsort(self->ranges, self->rangesCount, sizeof(SelfRange_t), compareSelfRanges);
+
+	uint64_t blockSize = 0;
+	uint64_t compressedSize = 0;
+
+	for (uint64_t i = 0; i < self->rangesCount; ++i)
+	{
+		const SelfRange_t *range = self->ranges + i;
+
+		if (range->elfOffset + range->size > self->imageSize)
+		{
+			self->imageSize = range->elfOffset + range->size;
+		}
+
+		for (uint64_t j = 0; range->extents && j * range->blockSize < range->decompressedSize; ++j)
+		{
+			blockSize = range->blockSize > blockSize ? range->blockSize : blockSize;
+			compressedSize = range->extents[j].size > compressedSize ? range->extents[j].size : compressedSize;
+		}
+	}
+
+	if (blockSize && (!(self->block = malloc(blockSize)) || !(self->compressed = malloc(compressedSize ? compressedSize : 1))))
+	{
+		return orbisElfErrorCodeNoMemory;
+	}
+
+	return orbisElfErrorCodeOk;
+}
+
+OrbisElfErrorCode_t orbisElfSelfOpen(OrbisElfSelfHandle_t *self, OrbisElfReadCallback_t readCallback, size_t fileSize, void *readUserData)
+{
+	OrbisElfSelfHandle_t result = malloc(sizeof(OrbisElfSelf_t));
+
+	if (!result)
+	{
+		return orbisElfErrorCodeNoMemory;
+	}
+
+	memset(result, 0, sizeof(OrbisElfSelf_t));
+	result->read = readCallback;
+	result->readUserData = readUserData;
+
+	if (mtx_init(&result->mutex, mtx_plain) != thrd_success)
+	{
+		free(result);
+		return orbisElfErrorCodeNoMemory;
+	}
+
+	OrbisElfErrorCode_t errorCode = openSelf(result, fileSize);
+
+	if (errorCode != orbisElfErrorCodeOk)
+	{
+		orbisElfSelfDestroy(result);
+		return errorCode;
+	}
+
+	*self = result;
+	return orbisElfErrorCodeOk;
+}
+
+void orbisElfSelfDestroy(OrbisElfSelfHandle_t self)
+{
+	for (uint64_t i = 0; i < self->rangesCount; ++i)
+	{
+		free(self->ranges[i].extents);
+	}
+
+	mtx_destroy(&self->mutex);
+	free(self->ranges);
+	free(self->block);
+	free(self->compressed);
+	free(self);
+}
+
+uint64_t orbisElfSelfGetImageSize(OrbisElfSelfHandle_t self)
+{
+	return self->imageSize;
+}
+
+#ifdef ORBIS_ELF_WITH_ZLIB
+/* called with the mutex held */
+static int decompressBlock(OrbisElfSelfHandle_t self, uint64_t rangeIndex, uint64_t blockIndex)
+{
+	if (self->blockRange == rangeIndex + 1 && self->blockIndex == blockIndex)
+	{
+		return 1;
+	}
+
+	const SelfRange_t *range = self->ranges + rangeIndex;
+	const SelfExtent_t *extent = range->extents + blockIndex;
+	uint64_t blockSize = range->decompressedSize - blockIndex * range->blockSize;
+	blockSize = blockSize < range->blockSize ? blockSize : range->blockSize;
+	self->blockRange = 0;
+
+	/* blocks that don't get smaller are stored as is */
+	if (extent->size >= blockSize)
+	{
+		if (self->read(range->selfOffset + extent->offset, self->block, blockSize, self->readUserData) != blockSize)
+		{
+			return 0;
+		}
+	}
+	else
+	{
+		uLongf decompressedSize = (uLongf)blockSize;
+
+		if (self->read(range->selfOffset + extent->offset, self->compressed, extent->size, self->readUserData) != extent->size ||
+		    uncompress(self->block, &decompressedSize, self->compressed, extent->size) != Z_OK || decompressedSize != blockSize)
+		{
+			return 0;
+		}
+	}
+
+	self->blockRange = rangeIndex + 1;
+	self->blockIndex = blockIndex;
+	return 1;
+}
+#endif
+
+static int readRange(OrbisElfSelfHandle_t self, uint64_t rangeIndex, uint64_t offset, uint8_t *destination, uint64_t size)
+{
+	const SelfRange_t *range = self->ranges + rangeIndex;
+
+	if (!range->extents)
+	{
+		return self->read(range->selfOffset + offset, destination, size, self->readUserData) == size;
+	}
+
+#ifdef ORBIS_ELF_WITH_ZLIB
+	int isOk = 1;
+	mtx_lock(&self->mutex);
+
+	while (size && isOk)
+	{
+		uint64_t blockIndex = offset / range->blockSize;
+		uint64_t blockOffset = offset % range->blockSize;
+		uint64_t chunkSize = range->blockSize - blockOffset < size ? range->blockSize - blockOffset : size;
+
+		isOk = decompressBlock(self, rangeIndex, blockIndex);
+
+		if (isOk)
+		{
+			memcpy(destination, self->block + blockOffset, chunkSize);
+			destination += chunkSize;
+			offset += chunkSize;
+			size -= chunkSize;
+		}
+	}
+
+	mtx_unlock(&self->mutex);
+	return isOk;
+#else
+	return 0;
+#endif
+}
+
+uint64_t orbisElfSelfRead(uint64_t offset, void *destination, uint64_t size, void *readUserData)
+{
+	OrbisElfSelfHandle_t self = readUserData;
+
+	if (offset >= self->imageSize)
+	{
+		return 0;
+	}
+
+	if (size > self->imageSize - offset)
+	{
+		size = self->imageSize - offset;
+	}
+
+	uint8_t *output = destination;
+	uint64_t current = offset;
+	uint64_t end = offset + size;
+
+	/* bytes of the inner image not stored in any segment (sections, padding) read as zeros */
+	for (uint64_t i = 0; i < self->rangesCount && current < end; ++i)
+	{
+		const SelfRange_t *range = self->ranges + i;
+
+		if (range->elfOffset + range->size <= current)
+		{
+			continue;
+		}
+
+		if (range->elfOffset >= end)
+		{
+			break;
+		}
+
+		if (range->elfOffset > current)
+		{
+			memset(output + (current - offset), 0, range->elfOffset - current);
+			current = range->elfOffset;
+		}
+
+		uint64_t rangeEnd = range->elfOffset + range->size < end ? range->elfOffset + range->size : end;
+
+		if (!readRange(self, i, current - range->elfOffset, output + (current - offset), rangeEnd - current))
+		{
+			return current - offset;
+		}
+
+		current = rangeEnd;
+	}
+
+	memset(output + (current - offset), 0, end - current);
+	return size;
+}
@@ -0,0 +1,76 @@
+/*
+ * SHA-1 compression over several independent messages at once, one message per
+ * vector lane. Included by orbis-elf-nid.c with the following defined:
+ *   SHA1_LANES_FUNCTION  name of the generated function
+ *   SHA1_LANES_TARGET    function attributes (may be empty)
+ *   SHA1_LANES           lanes count
+ *   SHA1_VEC             vector type
+ *   SHA1_LOAD(p), SHA1_STORE(p, v), SHA1_SET1(x)
+ *   SHA1_ADD(a, b), SHA1_XOR(a, b), SHA1_AND(a, b), SHA1_OR(a, b), SHA1_ANDNOT(a, b) (~a & b)
+ *   SHA1_SLL(a, n), SHA1_SRL(a, n)
+ *
+ * words is [16][SHA1_LANES] big endian decoded message words, state is [5][SHA1_LANES].
+ */
+
+#define SHA1_ROTL(a, n) SHA1_OR(SHA1_SLL(a, n), SHA1_SRL(a, 32 - (n)))
+
+#define SHA1_ROUND(f, k, t) \
+	do \
+	{ \
+		SHA1_VEC w; \
+		if ((t) < 16) \
+		{ \
+			w = SHA1_LOAD(words + (t) * SHA1_LANES); \
+		} \
+		else \
+		{ \
+			w = SHA1_XOR(SHA1_XOR(schedule[((t) - 3) & 15], schedule[((t) - 8) & 15]), SHA1_XOR(schedule[((t) - 14) & 15], schedule[(t) & 15])); \
+			w = SHA1_ROTL(w, 1); \
+		} \
+		schedule[(t) & 15] = w; \
+		SHA1_VEC temp = SHA1_ADD(SHA1_ADD(SHA1_ROTL(a, 5), (f)), SHA1_ADD(SHA1_ADD(e, SHA1_SET1(k)), w)); \
+		e = d; \
+		d = c; \
+		c = SHA1_ROTL(b, 30); \
+		b = a; \
+		a = temp; \
+	} while (0)
+
+SHA1_LANES_TARGET static void SHA1_LANES_FUNCTION(const uint32_t *words, uint32_t *state)
+{
+	SHA1_VEC a = SHA1_LOAD(state + 0 * SHA1_LANES);
+	SHA1_VEC b = SHA1_LOAD(state + 1 * SHA1_LANES);
+	SHA1_VEC c = SHA1_LOAD(state + 2 * SHA1_LANES);
+	SHA1_VEC d = SHA1_LOAD(state + 3 * SHA1_LANES);
+	SHA1_VEC e = SHA1_LOAD(state + 4 * SHA1_LANES);
+	SHA1_VEC schedule[16];
+
+	for (int t = 0; t < 20; ++t)
+	{
+		SHA1_ROUND(SHA1_OR(SHA1_AND(b, c), SHA1_ANDNOT(b, d)), 0x5a827999, t);
+	}
+
+	for (int t = 20; t < 40; ++t)
+	{
+		SHA1_ROUND(SHA1_XOR(SHA1_XOR(b, c), d), 0x6ed9eba1, t);
+	}
+
+	for (int t = 40; t < 60; ++t)
+	{
+		SHA1_ROUND(SHA1_OR(SHA1_AND(b, c), SHA1_AND(d, SHA1_OR(b, c))), 0x8f1bbcdc, t);
+	}
+
+	for (int t = 60; t < 80; ++t)
+	{
+		SHA1_ROUND(SHA1_XOR(SHA1_XOR(b, c), d), 0xca62c1d6, t);
+	}
+
+	SHA1_STORE(state + 0 * SHA1_LANES, SHA1_ADD(a, SHA1_LOAD(state + 0 * SHA1_LANES)));
+	SHA1_STORE(state + 1 * SHA1_LANES, SHA1_ADD(b, SHA1_LOAD(state + 1 * SHA1_LANES)));
+	SHA1_STORE(state + 2 * SHA1_LANES, SHA1_ADD(c, SHA1_LOAD(state + 2 * SHA1_LANES)));
+	SHA1_STORE(state + 3 * SHA1_LANES, SHA1_ADD(d, SHA1_LOAD(state + 3 * SHA1_LANES)));
+	SHA1_STORE(state + 4 * SHA1_LANES, SHA1_ADD(e, SHA1_LOAD(state + 4 * SHA1_LANES)));
+}
+
+#undef SHA1_ROUND
+#undef SHA1_ROTL
@@ -0,0 +1,243 @@
+#include "orbis-elf-types.h"
+#include "orbis-elf-enums.h"
+#include "orbis-elf-api.h"
+
+#include <malloc.h>
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+
+#define STRING_BLOCK_SIZE 0x10000
+
+typedef struct StringBlock_s
+{
+	struct StringBlock_s *next;
+	uint64_t used;
+	uint64_t size;
+	char data[];
+} StringBlock_t;
+
+typedef struct OrbisElfStringTable_s
+{
+	mtx_t mutex;
+
+	const char **strings; /* by id, strings[0] is unused so 0 stays "no id" */
+	uint64_t stringsCount;
+	uint64_t stringsCapacity;
+
+	uint32_t *hash; /* open addressing, id, 0 is empty */
+	uint64_t hashCapacity;
+
+	StringBlock_t *blocks; /* interned strings never move, handles keep pointers to them */
+} OrbisElfStringTable_t;
+
+static uint64_t hashString(const char *string)
+{
+	uint64_t hash = 0xcbf29ce484222325ull;
+
+	for (; *string; ++string)
+	{
+		hash = (hash ^ (uint8_t)*string) * 0x100000001b3ull;
+	}
+
+	return hash;
+}
+
+static const char *copyString(OrbisElfStringTableHandle_t table, const char *string, uint64_t size)
+{
+	StringBlock_t *block = table->blocks;
+
+	if (!block || block->size - block->used < size)
+	{
+		uint64_t blockSize = size > STRING_BLOCK_SIZE ? size : STRING_BLOCK_SIZE;
+		block = malloc(sizeof(StringBlock_t) + blockSize);
+
+		if (!block)
+		{
+			return NULL;
+		}
+
+		block->used = 0;
+		block->size = blockSize;
+
+		/* a string that doesn't fit the current block gets its own, the current one keeps taking short strings */
+		if (table->blocks && blockSize == size)
+		{
+			block->next = table->blocks->next;
+			table->blocks->next = block;
+		}
+		else
+		{
+			block->next = table->blocks;
+			table->blocks = block;
+		}
+	}
+
+	char *result = block->data + block->used;
+	memcpy(result, string, size);
+	block->used += size;
+	return result;
+}
+
+static OrbisElfErrorCode_t growHash(OrbisElfStringTableHandle_t table)
+{
+	uint64_t capacity = table->hashCapacity ? table->hashCapacity * 2 : 256;
+	uint32_t *hash = calloc(capacity, sizeof(uint32_t));
+
+	if (!hash)
+	{
+		return orbisElfErrorCodeNoMemory;
+	}
+
+	for (uint64_t id = 1; id < table->stringsCount; ++id)
+	{
+		uint64_t slot = hashString(table->strings[id]) & (capacity - 1);
+
+		while (hash[slot])
+		{
+			slot = (slot + 1) & (capacity - 1);
+		}
+
+		hash[slot] = (uint32_t)id;
+	}
+
+	free(table->hash);
+	table->hash = hash;
+	table->hashCapacity = capacity;
+	return orbisElfErrorCodeOk;
+}
+
+/* slot holding the string, or the empty slot where it goes */
+static uint64_t findSlot(OrbisElfStringTableHandle_t table, const char *string)
+{
+	uint64_t slot = hashString(string) & (table->hashCapacity - 1);
+
+	while (table->hash[slot] && strcmp(table->strings[table->hash[slot]], string) != 0)
+	{
+		slot = (slot + 1) & (table->hashCapacity - 1);
+	}
+
+	return slot;
+}
+
+OrbisElfErrorCode_t orbisElfStringTableCreate(OrbisElfStringTableHandle_t *table)
+{
+	OrbisElfStringTableHandle_t result = malloc(sizeof(OrbisElfStringTable_t));
+
+	if (!result)
+	{
+		return orbisElfErrorCodeNoMemory;
+	}
+
+	memset(result, 0, sizeof(OrbisElfStringTable_t));
+	result->stringsCount = 1;
+
+	if (mtx_init(&result->mutex, mtx_plain) != thrd_success)
+	{
+		free(result);
+		return orbisElfErrorCodeNoMemory;
+	}
+
+	*table = result;
+	return orbisElfErrorCodeOk;
+}
+
+void orbisElfStringTableDestroy(OrbisElfStringTableHandle_t table)
+{
+	while (table->blocks)
+	{
+		StringBlock_t *next = table->blocks->next;
+		free(table->blocks);
+		table->blocks = next;
+	}
+
+	mtx_destroy(&table->mutex);
+	free(table->strings);
+	free(table->hash);
+	free(table);
+}
+
+OrbisElfErrorCode_t orbisElfStringTableIntern(OrbisElfStringTableHandle_t table, const char *string, uint32_t *id, const char **internedString)
+{
+	OrbisElfErrorCode_t errorCode = orbisElfErrorCodeOk;
+	mtx_lock(&table->mutex);
+
+	if (table->stringsCount * 2 >= table->hashCapacity)
+	{
+		errorCode = growHash(table);
+	}
+
+	uint64_t slot = errorCode == orbisElfErrorCodeOk ? findSlot(table, string) : 0;
+
+	if (errorCode == orbisElfErrorCodeOk && !table->hash[slot])
+	{
+		if (table->stringsCount > UINT32_MAX)
+		{
+			errorCode = orbisElfErrorCodeNoMemory;
+		}
+		else if (table->stringsCount >= table->stringsCapacity)
+		{
+			uint64_t capacity = table->stringsCapacity ? table->stringsCapacity * 2 : 256;
+			const char **strings = realloc((void *)table->strings, capacity * sizeof(const char *));
+
+			if (strings)
+			{
+				table->strings = strings;
+				table->stringsCapacity = capacity;
+			}
+			else
+			{
+				errorCode = orbisElfErrorCodeNoMemory;
+			}
+		}
+
+		const char *copy = errorCode == orbisElfErrorCodeOk ? copyString(table, string, strlen(string) + 1) : NULL;
+
+		if (copy)
+		{
+			table->strings[table->stringsCount] = copy;
+			table->hash[slot] = (uint32_t)table->stringsCount++;
+		}
+		else
+		{
+			errorCode = orbisElfErrorCodeNoMemory;
+		}
+	}
+
+	if (errorCode == orbisElfErrorCodeOk)
+	{
+		*id = table->hash[slot];
+
+		if (internedString)
+		{
+			*internedString = table->strings[*id];
+		}
+	}
+
+	mtx_unlock(&table->mutex);
+	return errorCode;
+}
+
+uint32_t orbisElfStringTableFind(OrbisElfStringTableHandle_t table, const char *string)
+{
+	mtx_lock(&table->mutex);
+	uint32_t id = table->hashCapacity ? table->hash[findSlot(table, string)] : 0;
+	mtx_unlock(&table->mutex);
+	return id;
+}
+
+const char *orbisElfStringTableGetString(OrbisElfStringTableHandle_t table, uint32_t id)
+{
+	mtx_lock(&table->mutex);
+	const char *string = id && id < table->stringsCount ? table->strings[id] : NULL;
+	mtx_unlock(&table->mutex);
+	return string;
+}
+
+uint64_t orbisElfStringTableGetCount(OrbisElfStringTableHandle_t table)
+{
+	mtx_lock(&table->mutex);
+	uint64_t count = table->stringsCount - 1;
+	mtx_unlock(&table->mutex);
+	return count;
+}
@@ -0,0 +1,280 @@
+#include "orbis-elf-types.h"
+#include "orbis-elf-enums.h"
+#include "orbis-elf-api.h"
+
+#include <malloc.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define STUB_SIZE 16
+#define STUB_PAGE_SIZE 0x1000
+
+typedef struct
+{
+	OrbisElfHandle_t elf;
+	uint64_t symbolIndex;
+	uint64_t stubIndex;
+} OrbisElfStubSite_t;
+
+typedef struct OrbisElfStubTable_s
+{
+	OrbisElfStub_t *stubs;
+	uint64_t stubsCount;
+	uint64_t stubsCapacity;
+
+	uint64_t *stubsHash; /* open addressing, stub index + 1, 0 is empty */
+	uint64_t stubsHashCapacity;
+
+	OrbisElfStubSite_t *sites; /* import symbols pointed at the stubs by orbisElfStubTableBuild */
+	uint64_t sitesCount;
+	uint64_t sitesCapacity;
+} OrbisElfStubTable_t;
+
+static uint64_t hashStub(const char *moduleName, const char *libraryName, const char *name)
+{
+	const char *strings[3] = { moduleName, libraryName, name };
+	uint64_t hash = 0xcbf29ce484222325ull;
+
+	for (int i = 0; i < 3; ++i)
+	{
+		for (const char *string = strings[i]; *string; ++string)
+		{
+			hash = (hash ^ (uint8_t)*string) * 0x100000001b3ull;
+		}
+
+		hash = (hash ^ 0xff) * 0x100000001b3ull;
+	}
+
+	return hash;
+}
+
+static OrbisElfErrorCode_t growStubsHash(OrbisElfStubTableHandle_t table)
+{
+	uint64_t capacity = table->stubsHashCapacity ? table->stubsHashCapacity * 2 : 256;
+	uint64_t *stubsHash = calloc(capacity, sizeof(uint64_t));
+
+	if (!stubsHash)
+	{
+		return orbisElfErrorCodeNoMemory;
+	}
+
+	for (uint64_t i = 0; i < table->stubsCount; ++i)
+	{
+		const OrbisElfStub_t *stub = table->stubs + i;
+		uint64_t slot = hashStub(stub->moduleName, stub->libraryName, stub->name) & (capacity - 1);
+
+		while (stubsHash[slot])
+		{
+			slot = (slot + 1) & (capacity - 1);
+		}
+
+		stubsHash[slot] = i + 1;
+	}
+
+	free(table->stubsHash);
+	table->stubsHash = stubsHash;
+	table->stubsHashCapacity = capacity;
+	return orbisElfErrorCodeOk;
+}
+
+static OrbisElfErrorCode_t findOrAddStub(OrbisElfStubTableHandle_t table, const OrbisElfSymbol_t *symbol, uint64_t *stubIndex)
+{
+	if ((table->stubsCount + 1) * 2 > table->stubsHashCapacity)
+	{
+		OrbisElfErrorCode_t errorCode = growStubsHash(table);
+
+		if (errorCode != orbisElfErrorCodeOk)
+		{
+			return errorCode;
+		}
+	}
+
+	uint64_t slot = hashStub(symbol->module->name, symbol->library->name, symbol->name) & (table->stubsHashCapacity - 1);
+
+	for (; table->stubsHash[slot]; slot = (slot + 1) & (table->stubsHashCapacity - 1))
+	{
+		const OrbisElfStub_t *stub = table->stubs + table->stubsHash[slot] - 1;
+
+		if (strcmp(stub->name, symbol->name) == 0 && strcmp(stub->libraryName, symbol->library->name) == 0 && strcmp(stub->moduleName, symbol->module->name) == 0)
+		{
+			*stubIndex = table->stubsHash[slot] - 1;
+			return orbisElfErrorCodeOk;
+		}
+	}
+
+	if (table->stubsCount == table->stubsCapacity)
+	{
+		uint64_t capacity = table->stubsCapacity ? table->stubsCapacity * 2 : 256;
+		OrbisElfStub_t *stubs = realloc(table->stubs, capacity * sizeof(OrbisElfStub_t));
+
+		if (!stubs)
+		{
+			return orbisElfErrorCodeNoMemory;
+		}
+
+		table->stubs = stubs;
+		table->stubsCapacity = capacity;
+	}
+
+	OrbisElfStub_t *stub = table->stubs + table->stubsCount;
+	memset(stub, 0, sizeof(OrbisElfStub_t));
+	stub->moduleName = symbol->module->name;
+	stub->libraryName = symbol->library->name;
+	stub->name = symbol->name;
+
+	table->stubsHash[slot] = table->stubsCount + 1;
+	*stubIndex = table->stubsCount++;
+	return orbisElfErrorCodeOk;
+}
+
+OrbisElfErrorCode_t orbisElfStubTableCreate(OrbisElfStubTableHandle_t *table)
+{
+	OrbisElfStubTableHandle_t result = malloc(sizeof(OrbisElfStubTable_t));
+
+	if (!result)
+	{
+		return orbisElfErrorCodeNoMemory;
+	}
+
+	memset(result, 0, sizeof(OrbisElfStubTable_t));
+	*table = result;
+	return orbisElfErrorCodeOk;
+}
+
+void orbisElfStubTableDestroy(OrbisElfStubTableHandle_t table)
+{
+	free(table->stubs);
+	free(table->stubsHash);
+	free(table->sites);
+	free(table);
+}
+
+/* only functions called through the PLT get a thunk, data and TLS imports must stay unresolved rather than point at code */
+static int isCalledThroughPlt(OrbisElfHandle_t elf, uint64_t symbolIndex)
+{
+	uint64_t count;
+	const uint32_t *sites = orbisElfGetSymbolImportRelocations(elf, symbolIndex, &count);
+
+	for (uint64_t i = 0; i < count; ++i)
+	{
+		if (orbisElfGetImportRelocation(elf, sites[i])->relType == orbisElfRelocationTypeJumpSlot)
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+OrbisElfErrorCode_t orbisElfStubTableAddModule(OrbisElfStubTableHandle_t table, OrbisElfHandle_t elf)
+{
+	for (uint64_t i = 0, count = orbisElfGetSymbolsCount(elf); i < count; ++i)
+	{
+		const OrbisElfSymbol_t *symbol = orbisElfGetSymbol(elf, i);
+		OrbisElfSymbolBinding_t binding;
+
+		if (!symbol->module || !symbol->library || symbol->header.value ||
+		    (symbol->type != orbisElfSymbolTypeFunction && symbol->type != orbisElfSymbolTypeNoType) ||
+		    orbisElfGetSymbolBinding(elf, i, &binding) != orbisElfErrorCodeOk || binding.value || !isCalledThroughPlt(elf, i))
+		{
+			continue;
+		}
+
+		if (table->sitesCount == table->sitesCapacity)
+		{
+			uint64_t capacity = table->sitesCapacity ? table->sitesCapacity * 2 : 256;
+			OrbisElfStubSite_t *sites = realloc(table->sites, capacity * sizeof(OrbisElfStubSite_t));
+
+			if (!sites)
+			{
+				return orbisElfErrorCodeNoMemory;
+			}
+
+			table->sites = sites;
+			table->sitesCapacity = capacity;
+		}
+
+		OrbisElfStubSite_t *site = table->sites + table->sitesCount;
+		OrbisElfErrorCode_t errorCode = findOrAddStub(table, symbol, &site->stubIndex);
+
+		if (errorCode != orbisElfErrorCodeOk)
+		{
+			return errorCode;
+		}
+
+		site->elf = elf;
+		site->symbolIndex = i;
+		table->sitesCount++;
+	}
+
+	return orbisElfErrorCodeOk;
+}
+
+uint64_t orbisElfStubTableGetSize(OrbisElfStubTableHandle_t table)
+{
+	/* code pages first, so they can be mapped executable, then the target slots */
+	uint64_t codeSize = (table->stubsCount * STUB_SIZE + STUB_PAGE_SIZE - 1) & ~(uint64_t)(STUB_PAGE_SIZE - 1);
+	uint64_t slotsSize = (table->stubsCount * sizeof(uint64_t) + STUB_PAGE_SIZE - 1) & ~(uint64_t)(STUB_PAGE_SIZE - 1);
+	return codeSize + slotsSize;
+}
+
+OrbisElfErrorCode_t orbisElfStubTableBuild(OrbisElfStubTableHandle_t table, void *memory, uint64_t virtualAddress, uint64_t dispatcherAddress)
+{
+	if (!virtualAddress)
+	{
+		virtualAddress = (uint64_t)memory;
+	}
+
+	/* code and slot pages get different protections, so the table has to start on a page */
+	if (((uintptr_t)memory & (STUB_PAGE_SIZE - 1)) || (virtualAddress & (STUB_PAGE_SIZE - 1)) || table->stubsCount > UINT32_MAX)
+	{
+		return orbisElfErrorCodeInvalidValue;
+	}
+
+	uint8_t *code = memory;
+	uint64_t slotsOffset = (table->stubsCount * STUB_SIZE + STUB_PAGE_SIZE - 1) & ~(uint64_t)(STUB_PAGE_SIZE - 1);
+	uint64_t *slots = (uint64_t *)(code + slotsOffset);
+
+	memset(memory, 0xcc, slotsOffset);
+
+	for (uint64_t i = 0; i < table->stubsCount; ++i)
+	{
+		/* mov eax, <stub index>; jmp qword ptr [rip + <slot>]; int3 padding */
+		uint8_t *stub = code + i * STUB_SIZE;
+		uint32_t stubIndex = (uint32_t)i;
+		int32_t displacement = (int32_t)(slotsOffset + i * sizeof(uint64_t) - (i * STUB_SIZE + 11));
+
+		stub[0] = 0xb8;
+		memcpy(stub + 1, &stubIndex, 4);
+		stub[5] = 0xff;
+		stub[6] = 0x25;
+		memcpy(stub + 7, &displacement, 4);
+
+		slots[i] = dispatcherAddress;
+		table->stubs[i].address = virtualAddress + i * STUB_SIZE;
+		table->stubs[i].slot = slots + i;
+	}
+
+	for (uint64_t i = 0; i < table->sitesCount; ++i)
+	{
+		const OrbisElfStubSite_t *site = table->sites + i;
+		OrbisElfErrorCode_t errorCode = orbisElfRebindSymbol(site->elf, site->symbolIndex, 0, table->stubs[site->stubIndex].address, STUB_SIZE);
+
+		if (errorCode != orbisElfErrorCodeOk)
+		{
+			return errorCode;
+		}
+	}
+
+	return orbisElfErrorCodeOk;
+}
+
+uint64_t orbisElfStubTableGetStubsCount(OrbisElfStubTableHandle_t table)
+{
+	return table->stubsCount;
+}
+
+const OrbisElfStub_t *orbisElfStubTableGetStub(OrbisElfStubTableHandle_t table, uint64_t index)
+{
+	return index < table->stubsCount ? table->stubs + index : NULL;
+}
@@ -0,0 +1,495 @@
+#include "orbis-elf-types.h"
+#include "orbis-elf-enums.h"
+#include "orbis-elf-api.h"
+
+#include <malloc.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * On-disk layout, little endian, every table 8 byte aligned:
+ *   OrbisElfSymbolDbFileHeader_t
+ *   uint32_t index[(1 << indexBits) + 1]   first entry for every top indexBits of NID
+ *   OrbisElfSymbolDbFileEntry_t entries[]  sorted by NID
+ *   char strings[]                         NUL terminated module and library names
+ */
+
+#define SYMBOL_DB_MAGIC "OESYMDB"
+#define SYMBOL_DB_VERSION 1
+#define SYMBOL_DB_MAX_INDEX_BITS 20
+
+typedef struct
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t indexBits;
+	uint64_t entriesCount;
+	uint64_t indexOffset;
+	uint64_t entriesOffset;
+	uint64_t stringsOffset;
+	uint64_t stringsSize;
+} OrbisElfSymbolDbFileHeader_t;
+
+typedef struct
+{
+	uint64_t nid;
+	uint64_t value;
+	uint64_t size;
+	uint32_t moduleName; /* offset in strings */
+	uint32_t libraryName; /* offset in strings */
+	uint16_t moduleVersion;
+	uint16_t libraryVersion;
+	uint8_t type; /* see OrbisElfSymbolType_t */
+	uint8_t bind; /* see OrbisElfSymbolBind_t */
+	uint8_t pad[2];
+} OrbisElfSymbolDbFileEntry_t;
+
+typedef struct OrbisElfSymbolDb_s
+{
+	const OrbisElfSymbolDbFileHeader_t *header;
+	const uint32_t *index;
+	const OrbisElfSymbolDbFileEntry_t *entries;
+	const char *strings;
+} OrbisElfSymbolDb_t;
+
+typedef struct OrbisElfSymbolDbBuilder_s
+{
+	OrbisElfSymbolDbFileEntry_t *entries;
+	uint64_t entriesCount;
+	uint64_t entriesCapacity;
+
+	char *strings;
+	uint64_t stringsSize;
+	uint64_t stringsCapacity;
+
+	uint32_t *stringsHash; /* open addressing, offset + 1, 0 is empty */
+	uint64_t stringsHashCapacity;
+	uint64_t stringsHashCount;
+} OrbisElfSymbolDbBuilder_t;
+
+static uint64_t hashString(const char *string)
+{
+	uint64_t hash = 0xcbf29ce484222325ull;
+
+	for (; *string; ++string)
+	{
+		hash = (hash ^ (uint8_t)*string) * 0x100000001b3ull;
+	}
+
+	return hash;
+}
+
+static OrbisElfErrorCode_t builderGrowStringsHash(OrbisElfSymbolDbBuilderHandle_t builder)
+{
+	uint64_t capacity = builder->stringsHashCapacity ? builder->stringsHashCapacity * 2 : 256;
+	uint32_t *hash = calloc(capacity, sizeof(uint32_t));
+
+	if (!hash)
+	{
+		return orbisElfErrorCodeNoMemory;
+	}
+
+	for (uint64_t i = 0; i < builder->stringsHashCapacity; ++i)
+	{
+		if (!builder->stringsHash[i])
+		{
+			continue;
+		}
+
+		uint64_t slot = hashString(builder->strings + builder->stringsHash[i] - 1) & (capacity - 1);
+
+		while (hash[slot])
+		{
+			slot = (slot + 1) & (capacity - 1);
+		}
+
+		hash[slot] = builder->stringsHash[i];
+	}
+
+	free(builder->stringsHash);
+	builder->stringsHash = hash;
+	builder->stringsHashCapacity = capacity;
+	return orbisElfErrorCodeOk;
+}
+
+static OrbisElfErrorCode_t builderAddString(OrbisElfSymbolDbBuilderHandle_t builder, const char *string, uint32_t *offset)
+{
+	if ((builder->stringsHashCount + 1) * 2 > builder->stringsHashCapacity)
+	{
+		OrbisElfErrorCode_t error = builderGrowStringsHash(builder);
+
+		if (error != orbisElfErrorCodeOk)
+		{
+			return error;
+		}
+	}
+
+	uint64_t slot = hashString(string) & (builder->stringsHashCapacity - 1);
+
+	while (builder->stringsHash[slot])
+	{
+		if (strcmp(builder->strings + builder->stringsHash[slot] - 1, string) == 0)
+		{
+			*offset = builder->stringsHash[slot] - 1;
+			return orbisElfErrorCodeOk;
+		}
+
+		slot = (slot + 1) & (builder->stringsHashCapacity - 1);
+	}
+
+	uint64_t length = strlen(string) + 1;
+
+	if (builder->stringsSize + length > UINT32_MAX)
+	{
+		return orbisElfErrorCodeInvalidValue;
+	}
+
+	if (builder->stringsSize + length > builder->stringsCapacity)
+	{
+		uint64_t capacity = builder->stringsCapacity ? builder->stringsCapacity * 2 : 4096;
+
+		while (capacity < builder->stringsSize + length)
+		{
+			capacity *= 2;
+		}
+
+		char *strings = realloc(builder->strings, capacity);
+
+		if (!strings)
+		{
+			return orbisElfErrorCodeNoMemory;
+		}
+
+		builder->strings = strings;
+		builder->stringsCapacity = capacity;
+	}
+
+	memcpy(builder->strings + builder->stringsSize, string, length);
+	*offset = (uint32_t)builder->stringsSize;
+	builder->stringsHash[slot] = (uint32_t)builder->stringsSize + 1;
+	builder->stringsHashCount++;
+	builder->stringsSize += length;
+	return orbisElfErrorCodeOk;
+}
+
+static int compareFileEntries(const void *lhs, const void *rhs)
+{
+	const OrbisElfSymbolDbFileEntry_t *a = lhs;
+	const OrbisElfSymbolDbFileEntry_t *b = rhs;
+
+	if (a->nid != b->nid)
+	{
+		return a->nid < b->nid ? -1 : 1;
+	}
+
+	if (a->moduleName != b->moduleName)
+	{
+		return a->moduleName < b->moduleName ? -1 : 1;
+	}
+
+	if (a->libraryName != b->libraryName)
+	{
+		return a->libraryName < b->libraryName ? -1 : 1;
+	}
+
+	return memcmp(a, b, sizeof(OrbisElfSymbolDbFileEntry_t));
+}
+
+static uint32_t selectIndexBits(uint64_t entriesCount)
+{
+	uint32_t bits = 0;
+
+	while (bits < SYMBOL_DB_MAX_INDEX_BITS && (4ull << bits) < entriesCount)
+	{
+		++bits;
+	}
+
+	return bits;
+}
+
+static uint64_t alignOffset(uint64_t offset)
+{
+	return (offset + 7) & ~7ull;
+}
+
+OrbisElfErrorCode_t orbisElfSymbolDbBuilderCreate(OrbisElfSymbolDbBuilderHandle_t *builder)
+{
+	OrbisElfSymbolDbBuilderHandle_t result = malloc(sizeof(OrbisElfSymbolDbBuilder_t));
+
+	if (!result)
+	{
+		return orbisElfErrorCodeNoMemory;
+	}
+
+	memset(result, 0, sizeof(OrbisElfSymbolDbBuilder_t));
+	*builder = result;
+	return orbisElfErrorCodeOk;
+}
+
+OrbisElfErrorCode_t orbisElfSymbolDbBuilderAddModule(OrbisElfSymbolDbBuilderHandle_t builder, OrbisElfHandle_t elf)
+{
+	for (uint64_t i = 0, count = orbisElfGetSymbolsCount(elf); i < count; ++i)
+	{
+		const OrbisElfSymbol_t *symbol = orbisElfGetSymbol(elf, i);
+
+		if (!symbol->module || !symbol->library || !symbol->header.value || symbol->bind == orbisElfSymbolBindLocal)
+		{
+			continue;
+		}
+
+		uint64_t nid;
+
+		if (orbisElfNidFromString(symbol->name, &nid) != orbisElfErrorCodeOk)
+		{
+			continue;
+		}
+
+		if (builder->entriesCount == builder->entriesCapacity)
+		{
+			uint64_t capacity = builder->entriesCapacity ? builder->entriesCapacity * 2 : 1024;
+			OrbisElfSymbolDbFileEntry_t *entries = realloc(builder->entries, capacity * sizeof(OrbisElfSymbolDbFileEntry_t));
+
+			if (!entries)
+			{
+				return orbisElfErrorCodeNoMemory;
+			}
+
+			builder->entries = entries;
+			builder->entriesCapacity = capacity;
+		}
+
+		OrbisElfSymbolDbFileEntry_t *entry = builder->entries + builder->entriesCount;
+		memset(entry, 0, sizeof(OrbisElfSymbolDbFileEntry_t));
+
+		OrbisElfErrorCode_t error;
+
+		if ((error = builderAddString(builder, symbol->module->name, &entry->moduleName)) != orbisElfErrorCodeOk
+		    || (error = builderAddString(builder, symbol->library->name, &entry->libraryName)) != orbisElfErrorCodeOk)
+		{
+			return error;
+		}
+
+		entry->nid = nid;
+		entry->value = symbol->header.value;
+		entry->size = symbol->header.size;
+		entry->moduleVersion = symbol->module->version;
+		entry->libraryVersion = symbol->library->version;
+		entry->type = symbol->type;
+		entry->bind = symbol->bind;
+		builder->entriesCount++;
+	}
+
+	return orbisElfErrorCodeOk;
+}
+
+OrbisElfErrorCode_t orbisElfSymbolDbBuilderWrite(OrbisElfSymbolDbBuilderHandle_t builder, OrbisElfWriteCallback_t writeCallback, void *writeUserData)
+{
+	qsort(builder->entries, builder->entriesCount, sizeof(OrbisElfSymbolDbFileEntry_t), compareFileEntries);
+
+	uint64_t entriesCount = 0;
+
+	for (uint64_t i = 0; i < builder->entriesCount; ++i)
+	{
+		if (entriesCount && compareFileEntries(builder->entries + entriesCount - 1, builder->entries + i) == 0)
+		{
+			continue;
+		}
+
+		builder->entries[entriesCount++] = builder->entries[i];
+	}
+
+	builder->entriesCount = entriesCount;
+
+	OrbisElfSymbolDbFileHeader_t header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, SYMBOL_DB_MAGIC, sizeof(header.magic));
+	header.version = SYMBOL_DB_VERSION;
+	header.indexBits = selectIndexBits(entriesCount);
+	header.entriesCount = entriesCount;
+	header.indexOffset = alignOffset(sizeof(header));
+	header.entriesOffset = alignOffset(header.indexOffset + (((uint64_t)1 << header.indexBits) + 1) * sizeof(uint32_t));
+	header.stringsOffset = header.entriesOffset + entriesCount * sizeof(OrbisElfSymbolDbFileEntry_t);
+	header.stringsSize = builder->stringsSize;
+
+	uint64_t indexCount = ((uint64_t)1 << header.indexBits) + 1;
+	uint32_t *index = malloc(indexCount * sizeof(uint32_t));
+
+	if (!index)
+	{
+		return orbisElfErrorCodeNoMemory;
+	}
+
+	for (uint64_t bucket = 0, entry = 0; bucket < indexCount; ++bucket)
+	{
+		while (entry < entriesCount && (header.indexBits ? builder->entries[entry].nid >> (64 - header.indexBits) : 0) < bucket)
+		{
+			++entry;
+		}
+
+		index[bucket] = (uint32_t)(bucket + 1 == indexCount ? entriesCount : entry);
+	}
+
+	int isOk = 1;
+	isOk = isOk && writeCallback(0, &header, sizeof(header), writeUserData) == sizeof(header);
+	isOk = isOk && writeCallback(header.indexOffset, index, indexCount * sizeof(uint32_t), writeUserData) == indexCount * sizeof(uint32_t);
+	isOk = isOk && writeCallback(header.entriesOffset, builder->entries, entriesCount * sizeof(OrbisElfSymbolDbFileEntry_t), writeUserData) == entriesCount * sizeof(OrbisElfSymbolDbFileEntry_t);
+	isOk = isOk && writeCallback(header.stringsOffset, builder->strings, builder->stringsSize, writeUserData) == builder->stringsSize;
+
+	free(index);
+	return isOk ? orbisElfErrorCodeOk : orbisElfErrorCodeIoError;
+}
+
+void orbisElfSymbolDbBuilderDestroy(OrbisElfSymbolDbBuilderHandle_t builder)
+{
+	free(builder->entries);
+	free(builder->strings);
+	free(builder->stringsHash);
+	free(builder);
+}
+
+OrbisElfErrorCode_t orbisElfSymbolDbOpen(OrbisElfSymbolDbHandle_t *db, const void *data, size_t size)
+{
+	const OrbisElfSymbolDbFileHeader_t *header = data;
+
+	if (size < sizeof(OrbisElfSymbolDbFileHeader_t) || ((uintptr_t)data & 7))
+	{
+		return orbisElfErrorCodeInvalidImageFormat;
+	}
+
+	if (memcmp(header->magic, SYMBOL_DB_MAGIC, sizeof(header->magic)) != 0 || header->version != SYMBOL_DB_VERSION)
+	{
+		return orbisElfErrorCodeInvalidImageFormat;
+	}
+
+	if (header->indexBits > SYMBOL_DB_MAX_INDEX_BITS)
+	{
+		return orbisElfErrorCodeCorruptedImage;
+	}
+
+	uint64_t indexCount = ((uint64_t)1 << header->indexBits) + 1;
+
+	if (header->indexOffset > size || indexCount * sizeof(uint32_t) > size - header->indexOffset
+	    || header->entriesOffset > size || header->entriesCount > (size - header->entriesOffset) / sizeof(OrbisElfSymbolDbFileEntry_t)
+	    || header->stringsOffset > size || header->stringsSize > size - header->stringsOffset
+	    || (header->indexOffset & 7) || (header->entriesOffset & 7))
+	{
+		return orbisElfErrorCodeCorruptedImage;
+	}
+
+	const char *strings = (const char *)data + header->stringsOffset;
+
+	if (header->stringsSize && strings[header->stringsSize - 1] != '\0')
+	{
+		return orbisElfErrorCodeCorruptedImage;
+	}
+
+	const uint32_t *index = (const uint32_t *)((const char *)data + header->indexOffset);
+
+	if (index[indexCount - 1] != header->entriesCount)
+	{
+		return orbisElfErrorCodeCorruptedImage;
+	}
+
+	const OrbisElfSymbolDbFileEntry_t *entries = (const OrbisElfSymbolDbFileEntry_t *)((const char *)data + header->entriesOffset);
+
+	for (uint64_t i = 0; i < header->entriesCount; ++i)
+	{
+		if (entries[i].moduleName >= header->stringsSize || entries[i].libraryName >= header->stringsSize)
+		{
+			return orbisElfErrorCodeCorruptedImage;
+		}
+	}
+
+	for (uint64_t i = 1; i < indexCount; ++i)
+	{
+		if (index[i - 1] > index[i])
+		{
+			return orbisElfErrorCodeCorruptedImage;
+		}
+	}
+
+	OrbisElfSymbolDbHandle_t result = malloc(sizeof(OrbisElfSymbolDb_t));
+
+	if (!result)
+	{
+		return orbisElfErrorCodeNoMemory;
+	}
+
+	result->header = header;
+	result->index = index;
+	result->entries = entries;
+	result->strings = strings;
+	*db = result;
+	return orbisElfErrorCodeOk;
+}
+
+void orbisElfSymbolDbClose(OrbisElfSymbolDbHandle_t db)
+{
+	free(db);
+}
+
+uint64_t orbisElfSymbolDbGetEntriesCount(OrbisElfSymbolDbHandle_t db)
+{
+	return db->header->entriesCount;
+}
+
+OrbisElfErrorCode_t orbisElfSymbolDbFind(OrbisElfSymbolDbHandle_t db, uint64_t nid, uint64_t *index, uint64_t *count)
+{
+	uint64_t bucket = db->header->indexBits ? nid >> (64 - db->header->indexBits) : 0;
+	uint64_t low = db->index[bucket];
+	uint64_t high = db->index[bucket + 1];
+
+	while (low < high)
+	{
+		uint64_t middle = low + (high - low) / 2;
+
+		if (db->entries[middle].nid < nid)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+
+	uint64_t end = low;
+
+	while (end < db->header->entriesCount && db->entries[end].nid == nid)
+	{
+		++end;
+	}
+
+	if (index)
+	{
+		*index = low;
+	}
+
+	if (count)
+	{
+		*count = end - low;
+	}
+
+	return end != low ? orbisElfErrorCodeOk : orbisElfErrorCodeNotFound;
+}
+
+OrbisElfErrorCode_t orbisElfSymbolDbGetEntry(OrbisElfSymbolDbHandle_t db, uint64_t index, OrbisElfSymbolDbEntry_t *entry)
+{
+	if (index >= db->header->entriesCount)
+	{
+		return orbisElfErrorCodeInvalidValue;
+	}
+
+	const OrbisElfSymbolDbFileEntry_t *fileEntry = db->entries + index;
+
+	entry->nid = fileEntry->nid;
+	entry->moduleName = db->strings + fileEntry->moduleName;
+	entry->libraryName = db->strings + fileEntry->libraryName;
+	entry->moduleVersion = fileEntry->moduleVersion;
+	entry->libraryVersion = fileEntry->libraryVersion;
+	entry->type = fileEntry->type;
+	entry->bind = fileEntry->bind;
+	entry->value = fileEntry->value;
+	entry->size = fileEntry->size;
+	return orbisElfErrorCodeOk;
+}
@@ -0,0 +1,215 @@
+#include "orbis-elf-types.h"
+#include "orbis-elf-enums.h"
+#include "orbis-elf-api.h"
+
+#include <malloc.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct
+{
+	uintptr_t elf;
+	const OrbisElfTlsModule_t *module;
+} TlsModuleHandle_t;
+
+static int compareTlsModuleHandles(const void *a, const void *b)
+{
+	const TlsModuleHandle_t *left = a;
+	const TlsModuleHandle_t *right = b;
+	return (left->elf > right->elf) - (left->elf < right->elf);
+}
+
+OrbisElfErrorCode_t orbisElfTlsPlan(const OrbisElfHandle_t *elfs, uint64_t count, OrbisElfTlsModule_t *modules, uint64_t *staticSize, uint64_t *staticAlign)
+{
+	OrbisElfTlsModule_t **order = malloc(sizeof(OrbisElfTlsModule_t *) * (count ? count : 1));
+
+	if (!order)
+	{
+		return orbisElfErrorCodeNoMemory;
+	}
+
+	for (uint64_t i = 0; i < count; ++i)
+	{
+		uint64_t align = orbisElfGetTlsAlign(elfs[i]);
+
+		if (align & (align - 1))
+		{
+			free(order);
+			return orbisElfErrorCodeInvalidValue;
+		}
+
+		modules[i].elf = elfs[i];
+		modules[i].index = i + 1;
+		modules[i].offset = 0;
+		order[i] = modules + i;
+	}
+
+	/*
+	 * The first module keeps the block right below the thread pointer, executables use fixed offsets for their own TLS.
+	 * The others go by descending alignment, which keeps padding between blocks small, stable for equal alignments.
+	 */
+	for (uint64_t i = 2; i < count; ++i)
+	{
+		OrbisElfTlsModule_t *module = order[i];
+		uint64_t align = orbisElfGetTlsAlign(module->elf);
+		uint64_t j = i;
+
+		for (; j > 1 && orbisElfGetTlsAlign(order[j - 1]->elf) < align; --j)
+		{
+			order[j] = order[j - 1];
+		}
+
+		order[j] = module;
+	}
+
+	/* variant II: a block starts at thread pointer - offset, offset is aligned so the block is when the thread pointer is */
+	uint64_t offset = 0;
+	uint64_t maxAlign = 1;
+
+	for (uint64_t i = 0; i < count; ++i)
+	{
+		uint64_t size = orbisElfGetTlsSize(order[i]->elf);
+		uint64_t align = orbisElfGetTlsAlign(order[i]->elf) ? orbisElfGetTlsAlign(order[i]->elf) : 1;
+
+		if (!size)
+		{
+			continue;
+		}
+
+		if (size > UINT64_MAX - offset - align)
+		{
+			free(order);
+			return orbisElfErrorCodeInvalidValue;
+		}
+
+		offset = (offset + size + align - 1) & ~(align - 1);
+		order[i]->offset = offset;
+		maxAlign = align > maxAlign ? align : maxAlign;
+	}
+
+	free(order);
+	*staticSize = (offset + maxAlign - 1) & ~(maxAlign - 1);
+	*staticAlign = maxAlign;
+	return orbisElfErrorCodeOk;
+}
+
+static const OrbisElfTlsModule_t *findTlsModule(const TlsModuleHandle_t *handles, uint64_t count, OrbisElfHandle_t elf)
+{
+	uint64_t low = 0;
+	uint64_t high = count;
+
+	while (low < high)
+	{
+		uint64_t middle = low + (high - low) / 2;
+
+		if (handles[middle].elf < (uintptr_t)elf)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+
+	return low < count && handles[low].elf == (uintptr_t)elf ? handles[low].module : NULL;
+}
+
+OrbisElfErrorCode_t orbisElfTlsApply(const OrbisElfTlsModule_t *modules, uint64_t count)
+{
+	TlsModuleHandle_t *handles = malloc(sizeof(TlsModuleHandle_t) * (count ? count : 1));
+
+	if (!handles)
+	{
+		return orbisElfErrorCodeNoMemory;
+	}
+
+	for (uint64_t i = 0; i < count; ++i)
+	{
+		if (!orbisElfGetBaseAddress(modules[i].elf))
+		{
+			free(handles);
+			return orbisElfErrorCodeInvalidValue;
+		}
+
+		handles[i].elf = (uintptr_t)modules[i].elf;
+		handles[i].module = modules + i;
+	}
+
+	qsort(handles, count, sizeof(TlsModuleHandle_t), compareTlsModuleHandles);
+
+	OrbisElfErrorCode_t errorCode = orbisElfErrorCodeOk;
+
+	for (uint64_t i = 0; i < count; ++i)
+	{
+		OrbisElfHandle_t elf = modules[i].elf;
+		char *base = orbisElfGetBaseAddress(elf);
+		const OrbisElfTlsModule_t *definingModule = NULL;
+
+		for (uint64_t j = 0, relocationsCount = orbisElfGetTlsRelocationsCount(elf); j < relocationsCount; ++j)
+		{
+			OrbisElfRelocation_t *relocation = orbisElfGetTlsRelocation(elf, j);
+			OrbisElfSymbolBinding_t binding;
+
+			if (orbisElfGetSymbolBinding(elf, relocation->symbolIndex, &binding) != orbisElfErrorCodeOk)
+			{
+				errorCode = orbisElfErrorCodeCorruptedImage;
+				continue;
+			}
+
+			/* module index and offset are the ones of the handle the symbol is bound into, relocations mostly repeat it */
+			if (!definingModule || definingModule->elf != binding.module)
+			{
+				definingModule = findTlsModule(handles, count, binding.module);
+			}
+
+			if (!definingModule)
+			{
+				errorCode = orbisElfErrorCodeNotFound;
+				continue;
+			}
+
+			orbisElfWriteRelocation(base + orbisElfGetRelocationOffset(relocation), orbisElfGetRelocationAddressSize(relocation), orbisElfGetRelocationInjectType(relocation),
+				orbisElfGetTlsRelocationValue(elf, relocation, definingModule->index, definingModule->offset));
+		}
+	}
+
+	free(handles);
+	return errorCode;
+}
+
+OrbisElfErrorCode_t orbisElfTlsBuildTemplate(const OrbisElfTlsModule_t *modules, uint64_t count, void *templateMemory, uint64_t staticSize)
+{
+	/* the template is the whole static block, it ends where the thread pointer will be */
+	char *end = (char *)templateMemory + staticSize;
+	memset(templateMemory, 0, staticSize);
+
+	for (uint64_t i = 0; i < count; ++i)
+	{
+		OrbisElfHandle_t elf = modules[i].elf;
+		uint64_t size = orbisElfGetTlsSize(elf);
+		uint64_t initSize = orbisElfGetTlsInitSize(elf);
+		uint64_t initAddress = orbisElfGetTlsInitAddress(elf);
+
+		if (!size)
+		{
+			continue;
+		}
+
+		if (!orbisElfGetBaseAddress(elf))
+		{
+			return orbisElfErrorCodeInvalidValue;
+		}
+
+		if (modules[i].offset > staticSize || size > modules[i].offset || initSize > size ||
+		    initAddress > orbisElfGetLoadSize(elf) || initSize > orbisElfGetLoadSize(elf) - initAddress)
+		{
+			return orbisElfErrorCodeInvalidValue;
+		}
+
+		/* init data comes from the loaded image, so it is already relocated, the tail up to size stays zero */
+		memcpy(end - modules[i].offset, (const char *)orbisElfGetBaseAddress(elf) + initAddress, initSize);
+	}
+
+	return orbisElfErrorCodeOk;
+}
@@ -0,0 +1,684 @@
+#include "elf-generator.h"
+
+#include <orbis-elf-api.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef ORBIS_ELF_WITH_ZLIB
+	#include <zlib.h>
+#endif
+
+#define PAGE_SIZE 0x4000
+#define EXPORTS_OFFSET 0x1000
+#define TLS_INIT_SIZE 0x40
+#define TLS_SIZE 0x80
+
+#define SELF_MAGIC 0x1d3d154f
+#define SELF_HEADER_SIZE 0x20
+#define SELF_SEGMENT_SIZE 0x20
+#define SELF_SEGMENT_PROPERTIES 0x2805 /* ordered, signed, blocked, 16K blocks */
+#define SELF_EXTENTS_PROPERTIES 0x5 /* ordered, signed */
+#define SELF_PROPERTY_COMPRESSED (1ull << 3)
+#define SELF_PROPERTY_HAS_EXTENTS (1ull << 17)
+#define SELF_BLOCK_SIZE 0x4000
+
+typedef struct
+{
+	uint8_t *data;
+	uint64_t size;
+	uint64_t capacity;
+	int failed;
+} Buffer_t;
+
+static int bufferReserve(Buffer_t *buffer, uint64_t size)
+{
+	if (size <= buffer->capacity)
+	{
+		return 1;
+	}
+
+	uint64_t capacity = buffer->capacity ? buffer->capacity : 4096;
+
+	while (capacity < size)
+	{
+		capacity *= 2;
+	}
+
+	uint8_t *data = realloc(buffer->data, capacity);
+
+	if (!data)
+	{
+		return 0;
+	}
+
+	buffer->data = data;
+	buffer->capacity = capacity;
+	return 1;
+}
+
+static uint64_t bufferAppend(Buffer_t *buffer, const void *data, uint64_t size)
+{
+	uint64_t offset = buffer->size;
+
+	if (buffer->failed || !bufferReserve(buffer, buffer->size + size))
+	{
+		buffer->failed = 1;
+		return 0;
+	}
+
+	if (data)
+	{
+		memcpy(buffer->data + offset, data, size);
+	}
+	else
+	{
+		memset(buffer->data + offset, 0, size);
+	}
+
+	buffer->size += size;
+	return offset;
+}
+
+static uint64_t bufferAlign(Buffer_t *buffer, uint64_t alignment)
+{
+	uint64_t size = (buffer->size + alignment - 1) & ~(alignment - 1);
+	bufferAppend(buffer, NULL, size - buffer->size);
+	return size;
+}
+
+static uint32_t appendString(Buffer_t *strings, const char *string)
+{
+	return (uint32_t)bufferAppend(strings, string, strlen(string) + 1);
+}
+
+static uint32_t appendSymbolName(Buffer_t *strings, const char *moduleName, uint32_t index, uint32_t libraryId, uint32_t moduleId)
+{
+	char name[256];
+	char nid[12];
+
+	snprintf(name, sizeof(name), "%s_sym%u", moduleName, index);
+	orbisElfNidToString(orbisElfComputeNid(name), nid);
+	snprintf(name, sizeof(name), "%s#%c#%c", nid, 'A' + libraryId, 'A' + moduleId);
+	return appendString(strings, name);
+}
+
+static uint64_t packId(uint32_t id, uint32_t nameOffset)
+{
+	return ((uint64_t)id << 48) | ((uint64_t)0x0101 << 32) | nameOffset;
+}
+
+static void appendWord(Buffer_t *buffer, uint32_t value)
+{
+	bufferAppend(buffer, &value, sizeof(value));
+}
+
+/* .eh_frame_hdr then .eh_frame at address, one FDE per export; returns the .eh_frame_hdr size */
+static uint64_t appendEhFrame(Buffer_t *unwind, uint64_t address, uint32_t exportsCount, ElfGeneratorEhFrame_t mode)
+{
+	/* CIE with "zR" augmentation for pcrel sdata4 FDE pointers, cfa = rsp + 8 and the return address at cfa - 8 */
+	static const uint8_t cie[24] = { 20, 0, 0, 0, 0, 0, 0, 0, 1, 'z', 'R', 0, 1, 0x78, 16, 1, 0x1b, 0x0c, 7, 8, 0x90, 1, 0, 0 };
+	static const uint8_t fdePadding[4] = { 0 }; /* empty augmentation data and nops */
+	int hasTable = mode != elfGeneratorEhFrameNoTable;
+	uint64_t headerSize = 8 + (hasTable ? 4 + (uint64_t)exportsCount * 8 : 0);
+	uint64_t ehFrame = address + headerSize;
+	uint64_t fdeSize = 20;
+
+	/* version 1, pcrel sdata4 eh_frame_ptr, then udata4 count and datarel sdata4 table or neither */
+	const uint8_t encodings[4] = { 1, 0x1b, hasTable ? 0x03 : 0xff, hasTable ? 0x3b : 0xff };
+	bufferAppend(unwind, encodings, sizeof(encodings));
+	appendWord(unwind, (uint32_t)(ehFrame - (address + 4)));
+
+	if (hasTable)
+	{
+		appendWord(unwind, exportsCount);
+
+		for (uint32_t i = 0; i < exportsCount; ++i)
+		{
+			uint32_t index = mode == elfGeneratorEhFrameUnsortedTable ? exportsCount - 1 - i : i;
+			appendWord(unwind, (uint32_t)(EXPORTS_OFFSET + (uint64_t)index * 16 - address));
+			appendWord(unwind, (uint32_t)(ehFrame + sizeof(cie) + index * fdeSize - address));
+		}
+	}
+
+	bufferAppend(unwind, cie, sizeof(cie));
+
+	for (uint32_t i = 0; i < exportsCount; ++i)
+	{
+		uint64_t fde = ehFrame + sizeof(cie) + i * fdeSize;
+		appendWord(unwind, (uint32_t)(fdeSize - 4));
+		appendWord(unwind, (uint32_t)(fde + 4 - ehFrame));
+		appendWord(unwind, (uint32_t)(EXPORTS_OFFSET + (uint64_t)i * 16 - (fde + 8)));
+		appendWord(unwind, 16);
+		bufferAppend(unwind, fdePadding, sizeof(fdePadding));
+	}
+
+	appendWord(unwind, 0);
+	return headerSize;
+}
+
+int elfGeneratorGenerate(const ElfGeneratorConfig_t *config, ElfGeneratorImage_t *image)
+{
+	uint32_t exportLibrariesCount = config->exportLibrariesCount ? config->exportLibrariesCount : 1;
+	uint32_t importLibrariesCount = config->importLibrariesCount ? config->importLibrariesCount : 1;
+	uint32_t importSymbolsCount = config->importModuleName ? config->importSymbolsCount : 0;
+	uint32_t importRelocationsCount = importSymbolsCount ? config->importRelocationsCount : 0;
+	uint32_t jumpSlotsCount = importSymbolsCount ? config->jumpSlotsCount : 0;
+	uint32_t dataSegmentsCount = config->segmentsCount > 1 ? config->segmentsCount - 1 : 1;
+	int hasTls = config->tlsRelocationsCount != 0;
+	int hasEhFrame = config->ehFrame != elfGeneratorEhFrameNone;
+
+	if (exportLibrariesCount > ELF_GENERATOR_MAX_LIBRARIES || importLibrariesCount > ELF_GENERATOR_MAX_LIBRARIES)
+	{
+		return 0;
+	}
+
+	Buffer_t strings = { 0 };
+	Buffer_t symbols = { 0 };
+	Buffer_t rela = { 0 };
+	Buffer_t jmpRel = { 0 };
+	Buffer_t dynamics = { 0 };
+	Buffer_t dynlibData = { 0 };
+	Buffer_t unwind = { 0 };
+	Buffer_t file = { 0 };
+	int isOk = 1;
+
+	/* library ids: exports 0..E-1, imports E..E+I-1; module ids: own 0, imported 1 */
+	appendString(&strings, "");
+	uint32_t moduleNameOffset = appendString(&strings, config->moduleName);
+	uint32_t importModuleNameOffset = importSymbolsCount ? appendString(&strings, config->importModuleName) : 0;
+	uint32_t exportLibraryNames[ELF_GENERATOR_MAX_LIBRARIES];
+	uint32_t importLibraryNames[ELF_GENERATOR_MAX_LIBRARIES];
+
+	for (uint32_t i = 0; i < exportLibrariesCount; ++i)
+	{
+		char name[256];
+		snprintf(name, sizeof(name), "%s_lib%u", config->moduleName, i);
+		exportLibraryNames[i] = appendString(&strings, name);
+	}
+
+	for (uint32_t i = 0; importSymbolsCount && i < importLibrariesCount; ++i)
+	{
+		char name[256];
+		snprintf(name, sizeof(name), "%s_lib%u", config->importModuleName, i);
+		importLibraryNames[i] = appendString(&strings, name);
+	}
+
+	OrbisElfSymbolHeader_t symbol;
+	memset(&symbol, 0, sizeof(symbol));
+	bufferAppend(&symbols, &symbol, sizeof(symbol));
+
+	uint64_t textSize = (EXPORTS_OFFSET + (uint64_t)config->exportSymbolsCount * 16 + PAGE_SIZE - 1) & ~(uint64_t)(PAGE_SIZE - 1);
+
+	uint32_t firstExportSymbol = 1;
+
+	for (uint32_t i = 0; i < config->exportSymbolsCount; ++i)
+	{
+		symbol.name = appendSymbolName(&strings, config->moduleName, i, i % exportLibrariesCount, 0);
+		symbol.info = (orbisElfSymbolBindGlobal << 4) | orbisElfSymbolTypeFunction;
+		symbol.shndx = 1;
+		symbol.value = EXPORTS_OFFSET + (uint64_t)i * 16;
+		symbol.size = 16;
+		bufferAppend(&symbols, &symbol, sizeof(symbol));
+	}
+
+	uint32_t tlsSymbol = 0;
+
+	if (hasTls)
+	{
+		tlsSymbol = (uint32_t)(symbols.size / sizeof(symbol));
+		symbol.name = appendString(&strings, "bench_tls");
+		symbol.info = (orbisElfSymbolBindLocal << 4) | orbisElfSymbolTypeTls;
+		symbol.shndx = 2;
+		symbol.value = 8;
+		symbol.size = 8;
+		bufferAppend(&symbols, &symbol, sizeof(symbol));
+	}
+
+	uint32_t firstImportSymbol = (uint32_t)(symbols.size / sizeof(symbol));
+
+	for (uint32_t i = 0; i < importSymbolsCount; ++i)
+	{
+		symbol.name = appendSymbolName(&strings, config->importModuleName, i, exportLibrariesCount + i % importLibrariesCount, 1);
+		symbol.info = (orbisElfSymbolBindGlobal << 4) | orbisElfSymbolTypeFunction;
+		symbol.shndx = 0;
+		symbol.value = 0;
+		symbol.size = 0;
+		bufferAppend(&symbols, &symbol, sizeof(symbol));
+	}
+
+	/* every relocation gets its own 8 byte slot, slots are spread evenly over the data segments */
+	uint64_t slotsCount = (uint64_t)config->rebaseRelocationsCount + importRelocationsCount + config->tlsRelocationsCount + jumpSlotsCount;
+	uint64_t slotsPerSegment = (slotsCount + dataSegmentsCount - 1) / dataSegmentsCount;
+	uint64_t dataSegmentSize = (slotsPerSegment * 8 + PAGE_SIZE - 1) & ~(uint64_t)(PAGE_SIZE - 1);
+
+	if (!dataSegmentSize)
+	{
+		dataSegmentSize = PAGE_SIZE;
+	}
+
+	uint64_t slot = 0;
+#define SLOT_ADDRESS(index) (textSize + ((index) / slotsPerSegment) * dataSegmentSize + ((index) % slotsPerSegment) * 8)
+
+	for (uint32_t i = 0; i < config->rebaseRelocationsCount; ++i, ++slot)
+	{
+		OrbisElfRela_t relocation;
+		relocation.offset = SLOT_ADDRESS(slot);
+
+		if ((i & 3) == 3 && config->exportSymbolsCount)
+		{
+			relocation.info = ((uint64_t)(firstExportSymbol + i % config->exportSymbolsCount) << 32) | orbisElfRelocationType64;
+			relocation.addend = 0;
+		}
+		else
+		{
+			relocation.info = orbisElfRelocationTypeRelative;
+			relocation.addend = EXPORTS_OFFSET + (i % (textSize - EXPORTS_OFFSET));
+		}
+
+		bufferAppend(&rela, &relocation, sizeof(relocation));
+	}
+
+	for (uint32_t i = 0; i < importRelocationsCount; ++i, ++slot)
+	{
+		OrbisElfRela_t relocation;
+		relocation.offset = SLOT_ADDRESS(slot);
+		relocation.info = ((uint64_t)(firstImportSymbol + i % importSymbolsCount) << 32) | ((i & 1) ? orbisElfRelocationTypeGlobDat : orbisElfRelocationType64);
+		relocation.addend = 0;
+		bufferAppend(&rela, &relocation, sizeof(relocation));
+	}
+
+	static const uint32_t tlsTypes[] = { orbisElfRelocationTypeDtpMod64, orbisElfRelocationTypeTpOff64, orbisElfRelocationTypeTpOff32 };
+
+	for (uint32_t i = 0; i < config->tlsRelocationsCount; ++i, ++slot)
+	{
+		OrbisElfRela_t relocation;
+		relocation.offset = SLOT_ADDRESS(slot);
+		relocation.info = ((uint64_t)tlsSymbol << 32) | tlsTypes[i % 3];
+		relocation.addend = 0;
+		bufferAppend(&rela, &relocation, sizeof(relocation));
+	}
+
+	for (uint32_t i = 0; i < jumpSlotsCount; ++i, ++slot)
+	{
+		OrbisElfRela_t relocation;
+		relocation.offset = SLOT_ADDRESS(slot);
+		relocation.info = ((uint64_t)(firstImportSymbol + i % importSymbolsCount) << 32) | orbisElfRelocationTypeJumpSlot;
+		relocation.addend = 0;
+		bufferAppend(&jmpRel, &relocation, sizeof(relocation));
+	}
+
+#undef SLOT_ADDRESS
+
+	uint64_t unwindAddress = textSize + dataSegmentsCount * dataSegmentSize;
+	uint64_t ehFrameHeaderSize = hasEhFrame ? appendEhFrame(&unwind, unwindAddress, config->exportSymbolsCount, config->ehFrame) : 0;
+
+	uint64_t symbolsOffset = bufferAppend(&dynlibData, symbols.data, symbols.size);
+	uint64_t stringsOffset = bufferAlign(&dynlibData, 8);
+	bufferAppend(&dynlibData, strings.data, strings.size);
+	uint64_t relaOffset = bufferAlign(&dynlibData, 8);
+	bufferAppend(&dynlibData, rela.data, rela.size);
+	uint64_t jmpRelOffset = bufferAlign(&dynlibData, 8);
+	bufferAppend(&dynlibData, jmpRel.data, jmpRel.size);
+
+	OrbisElfDynamic_t dynamic;
+#define ADD_DYNAMIC(dynamicType, dynamicValue) \
+	do \
+	{ \
+		dynamic.type = (dynamicType); \
+		dynamic.value = (dynamicValue); \
+		bufferAppend(&dynamics, &dynamic, sizeof(dynamic)); \
+	} while (0)
+
+	ADD_DYNAMIC(orbisElfDynamicTypeSceModuleInfo, packId(0, moduleNameOffset));
+
+	for (uint32_t i = 0; i < exportLibrariesCount; ++i)
+	{
+		ADD_DYNAMIC(orbisElfDynamicTypeSceExportLib, packId(i, exportLibraryNames[i]));
+		ADD_DYNAMIC(orbisElfDynamicTypeSceExportLibAttr, ((uint64_t)i << 32) | 1);
+	}
+
+	if (importSymbolsCount)
+	{
+		ADD_DYNAMIC(orbisElfDynamicTypeSceNeededModule, packId(1, importModuleNameOffset));
+
+		for (uint32_t i = 0; i < importLibrariesCount; ++i)
+		{
+			ADD_DYNAMIC(orbisElfDynamicTypeSceImportLib, packId(exportLibrariesCount + i, importLibraryNames[i]));
+			ADD_DYNAMIC(orbisElfDynamicTypeSceImportLibAttr, ((uint64_t)(exportLibrariesCount + i) << 32) | 9);
+		}
+	}
+
+	ADD_DYNAMIC(orbisElfDynamicTypeSceSymTab, symbolsOffset);
+	ADD_DYNAMIC(orbisElfDynamicTypeSceSymTabSize, symbols.size);
+	ADD_DYNAMIC(orbisElfDynamicTypeSceSymEnt, sizeof(OrbisElfSymbolHeader_t));
+	ADD_DYNAMIC(orbisElfDynamicTypeSceStrTab, stringsOffset);
+	ADD_DYNAMIC(orbisElfDynamicTypeSceStrSize, strings.size);
+	ADD_DYNAMIC(orbisElfDynamicTypeSceRela, relaOffset);
+	ADD_DYNAMIC(orbisElfDynamicTypeSceRelaSize, rela.size);
+	ADD_DYNAMIC(orbisElfDynamicTypeSceRelaEnt, sizeof(OrbisElfRela_t));
+	ADD_DYNAMIC(orbisElfDynamicTypeSceJmpRel, jmpRelOffset);
+	ADD_DYNAMIC(orbisElfDynamicTypeScePltRel, orbisElfDynamicTypeRela);
+	ADD_DYNAMIC(orbisElfDynamicTypeScePltRelSize, jmpRel.size);
+	ADD_DYNAMIC(orbisElfDynamicTypeScePltGot, textSize);
+	ADD_DYNAMIC(orbisElfDynamicTypeNull, 0);
+#undef ADD_DYNAMIC
+
+	uint16_t programsCount = (uint16_t)(1 + dataSegmentsCount + 2 + hasTls + hasEhFrame * 2);
+	OrbisElfHeader_t header;
+	memset(&header, 0, sizeof(header));
+	header.magic[0] = 0x7f;
+	header.magic[1] = 'E';
+	header.magic[2] = 'L';
+	header.magic[3] = 'F';
+	header.eclass = 2;
+	header.data = 1;
+	header.eversion = 1;
+	header.osabi = 9;
+	header.type = orbisElfTypeSceDynamic;
+	header.machine = 0x3e;
+	header.version = 1;
+	header.phoff = sizeof(header);
+	header.ehsize = sizeof(header);
+	header.phentsize = sizeof(OrbisElfProgramHeader_t);
+	header.phnum = programsCount;
+	header.shentsize = sizeof(OrbisElfSectionHeader_t);
+
+	bufferAppend(&file, &header, sizeof(header));
+	uint64_t programsOffset = bufferAppend(&file, NULL, sizeof(OrbisElfProgramHeader_t) * programsCount);
+	OrbisElfProgramHeader_t programs[6 + 256];
+	memset(programs, 0, sizeof(programs));
+
+	isOk = !strings.failed && !symbols.failed && !rela.failed && !jmpRel.failed && !dynamics.failed && !dynlibData.failed && !unwind.failed && dataSegmentsCount <= 256;
+
+	uint16_t programIndex = 0;
+
+	if (isOk)
+	{
+		uint64_t textOffset = bufferAlign(&file, PAGE_SIZE);
+		uint64_t textFileOffset = bufferAppend(&file, NULL, textSize);
+
+		for (uint64_t i = EXPORTS_OFFSET; i < textSize && !file.failed; ++i)
+		{
+			file.data[textFileOffset + i] = 0xc3;
+		}
+
+		for (uint64_t i = 0; i < TLS_INIT_SIZE && !file.failed; ++i)
+		{
+			file.data[textFileOffset + i] = (uint8_t)i;
+		}
+
+		programs[programIndex].type = orbisElfProgramTypeLoad;
+		programs[programIndex].flags = 5;
+		programs[programIndex].offset = textOffset;
+		programs[programIndex].vaddr = 0;
+		programs[programIndex].paddr = 0;
+		programs[programIndex].filesz = textSize;
+		programs[programIndex].memsz = textSize;
+		programs[programIndex].align = PAGE_SIZE;
+		programIndex++;
+
+		for (uint32_t i = 0; i < dataSegmentsCount; ++i)
+		{
+			uint64_t dataOffset = bufferAppend(&file, NULL, dataSegmentSize);
+
+			programs[programIndex].type = orbisElfProgramTypeLoad;
+			programs[programIndex].flags = 6;
+			programs[programIndex].offset = dataOffset;
+			programs[programIndex].vaddr = textSize + i * dataSegmentSize;
+			programs[programIndex].paddr = programs[programIndex].vaddr;
+			programs[programIndex].filesz = dataSegmentSize;
+			programs[programIndex].memsz = dataSegmentSize;
+			programs[programIndex].align = PAGE_SIZE;
+			programIndex++;
+		}
+
+		if (hasEhFrame)
+		{
+			uint64_t unwindSize = (unwind.size + PAGE_SIZE - 1) & ~(uint64_t)(PAGE_SIZE - 1);
+			uint64_t unwindOffset = bufferAppend(&file, NULL, unwindSize);
+
+			if (!file.failed)
+			{
+				memcpy(file.data + unwindOffset, unwind.data, unwind.size);
+			}
+
+			programs[programIndex].type = orbisElfProgramTypeLoad;
+			programs[programIndex].flags = 4;
+			programs[programIndex].offset = unwindOffset;
+			programs[programIndex].vaddr = unwindAddress;
+			programs[programIndex].paddr = unwindAddress;
+			programs[programIndex].filesz = unwindSize;
+			programs[programIndex].memsz = unwindSize;
+			programs[programIndex].align = PAGE_SIZE;
+			programIndex++;
+
+			programs[programIndex].type = orbisElfProgramTypeGnuEhFrame;
+			programs[programIndex].flags = 4;
+			programs[programIndex].offset = unwindOffset;
+			programs[programIndex].vaddr = unwindAddress;
+			programs[programIndex].paddr = unwindAddress;
+			programs[programIndex].filesz = ehFrameHeaderSize;
+			programs[programIndex].memsz = ehFrameHeaderSize;
+			programs[programIndex].align = 4;
+			programIndex++;
+		}
+
+		if (hasTls)
+		{
+			programs[programIndex].type = orbisElfProgramTypeTls;
+			programs[programIndex].flags = 4;
+			programs[programIndex].offset = textOffset;
+			programs[programIndex].vaddr = 0;
+			programs[programIndex].paddr = 0;
+			programs[programIndex].filesz = TLS_INIT_SIZE;
+			programs[programIndex].memsz = TLS_SIZE;
+			programs[programIndex].align = 16;
+			programIndex++;
+		}
+
+		uint64_t dynamicsOffset = bufferAppend(&file, dynamics.data, dynamics.size);
+		programs[programIndex].type = orbisElfProgramTypeDynamic;
+		programs[programIndex].flags = 6;
+		programs[programIndex].offset = dynamicsOffset;
+		programs[programIndex].filesz = dynamics.size;
+		programs[programIndex].memsz = dynamics.size;
+		programs[programIndex].align = 8;
+		programIndex++;
+
+		uint64_t dynlibDataOffset = bufferAlign(&file, 16);
+		bufferAppend(&file, dynlibData.data, dynlibData.size);
+		programs[programIndex].type = orbisElfProgramTypeSceDynlibData;
+		programs[programIndex].flags = 4;
+		programs[programIndex].offset = dynlibDataOffset;
+		programs[programIndex].filesz = dynlibData.size;
+		programs[programIndex].align = 16;
+		programIndex++;
+
+		isOk = !file.failed;
+	}
+
+	if (isOk)
+	{
+		memcpy(file.data + programsOffset, programs, sizeof(OrbisElfProgramHeader_t) * programsCount);
+	}
+
+	free(strings.data);
+	free(symbols.data);
+	free(rela.data);
+	free(jmpRel.data);
+	free(dynamics.data);
+	free(dynlibData.data);
+	free(unwind.data);
+
+	if (!isOk)
+	{
+		free(file.data);
+		return 0;
+	}
+
+	image->data = file.data;
+	image->size = file.size;
+	return 1;
+}
+
+#ifdef ORBIS_ELF_WITH_ZLIB
+/* one zlib stream of data, or data as is when it doesn't get smaller (only allowed for blocks with extents) */
+static uint64_t appendCompressed(Buffer_t *file, const uint8_t *data, uint64_t size, int isRawAllowed)
+{
+	uLongf compressedSize = compressBound((uLong)size);
+	uint64_t offset = file->size;
+
+	if (file->failed || !bufferReserve(file, file->size + compressedSize))
+	{
+		file->failed = 1;
+		return 0;
+	}
+
+	if (compress2(file->data + offset, &compressedSize, data, (uLong)size, Z_BEST_SPEED) != Z_OK)
+	{
+		file->failed = 1;
+		return 0;
+	}
+
+	if (isRawAllowed && compressedSize >= size)
+	{
+		bufferAppend(file, data, size);
+		return size;
+	}
+
+	file->size += compressedSize;
+	return compressedSize;
+}
+#endif
+
+/* TLS and PT_GNU_EH_FRAME data lies inside PT_LOAD segments */
+static int hasSelfSegment(const OrbisElfProgramHeader_t *program)
+{
+	return program->filesz && program->type != orbisElfProgramTypeTls && program->type != orbisElfProgramTypeGnuEhFrame;
+}
+
+int elfGeneratorWrapSelf(const ElfGeneratorImage_t *elf, ElfGeneratorSelfMode_t mode, ElfGeneratorImage_t *self)
+{
+#ifndef ORBIS_ELF_WITH_ZLIB
+	if (mode != elfGeneratorSelfModePlain)
+	{
+		return 0;
+	}
+#endif
+
+	const OrbisElfHeader_t *header = (const OrbisElfHeader_t *)elf->data;
+	const OrbisElfProgramHeader_t *programs = (const OrbisElfProgramHeader_t *)(elf->data + header->phoff);
+	uint16_t programsCount = 0;
+
+	for (uint16_t i = 0; i < header->phnum; ++i)
+	{
+		programsCount += hasSelfSegment(programs + i);
+	}
+
+	/* with extents each data segment is followed by the segment holding its extent table */
+	uint16_t segmentsCount = mode == elfGeneratorSelfModeCompressedBlocks ? programsCount * 2 : programsCount;
+	Buffer_t file = { 0 };
+	uint8_t selfHeader[SELF_HEADER_SIZE] = { 0 };
+	uint32_t magic = SELF_MAGIC;
+	uint64_t headersSize = header->phoff + header->phnum * sizeof(OrbisElfProgramHeader_t);
+
+	memcpy(selfHeader, &magic, sizeof(magic));
+	selfHeader[5] = 1; /* mode */
+	selfHeader[6] = 1; /* endian */
+	selfHeader[7] = 0x12; /* attributes */
+	memcpy(selfHeader + 24, &segmentsCount, sizeof(segmentsCount));
+	bufferAppend(&file, selfHeader, sizeof(selfHeader));
+
+	uint64_t segmentsOffset = bufferAppend(&file, NULL, segmentsCount * SELF_SEGMENT_SIZE);
+	bufferAppend(&file, elf->data, headersSize);
+
+	for (uint16_t i = 0, segmentIndex = 0; i < header->phnum && !file.failed; ++i)
+	{
+		if (!hasSelfSegment(programs + i))
+		{
+			continue;
+		}
+
+		const uint8_t *data = elf->data + programs[i].offset;
+		uint64_t segment[4] = { SELF_SEGMENT_PROPERTIES | ((uint64_t)i << 20), bufferAlign(&file, 16), programs[i].filesz, programs[i].filesz };
+		uint64_t extents[4] = { 0 };
+
+		switch (mode)
+		{
+		case elfGeneratorSelfModePlain:
+			bufferAppend(&file, data, programs[i].filesz);
+			break;
+
+#ifdef ORBIS_ELF_WITH_ZLIB
+		case elfGeneratorSelfModeCompressed:
+			segment[0] |= SELF_PROPERTY_COMPRESSED;
+			segment[2] = appendCompressed(&file, data, programs[i].filesz, 0);
+			break;
+
+		case elfGeneratorSelfModeCompressedBlocks:
+		{
+			uint64_t blocksCount = (programs[i].filesz + SELF_BLOCK_SIZE - 1) / SELF_BLOCK_SIZE;
+			uint32_t *blockExtents = malloc(sizeof(uint32_t) * 2 * blocksCount);
+
+			if (!blockExtents)
+			{
+				file.failed = 1;
+				break;
+			}
+
+			segment[0] |= SELF_PROPERTY_COMPRESSED | SELF_PROPERTY_HAS_EXTENTS;
+
+			for (uint64_t j = 0; j < blocksCount; ++j)
+			{
+				uint64_t blockSize = programs[i].filesz - j * SELF_BLOCK_SIZE < SELF_BLOCK_SIZE ? programs[i].filesz - j * SELF_BLOCK_SIZE : SELF_BLOCK_SIZE;
+				blockExtents[j * 2] = (uint32_t)(file.size - segment[1]);
+				blockExtents[j * 2 + 1] = (uint32_t)appendCompressed(&file, data + j * SELF_BLOCK_SIZE, blockSize, 1);
+			}
+
+			segment[2] = file.size - segment[1];
+			extents[0] = SELF_EXTENTS_PROPERTIES | ((uint64_t)(segmentIndex + 1) << 20);
+			extents[1] = bufferAlign(&file, 16);
+			extents[2] = extents[3] = sizeof(uint32_t) * 2 * blocksCount;
+			bufferAppend(&file, blockExtents, extents[2]);
+			free(blockExtents);
+			break;
+		}
+#endif
+
+		default:
+			file.failed = 1;
+			break;
+		}
+
+		if (file.failed)
+		{
+			break;
+		}
+
+		/* the extent table segment comes first, its id is the index of the data segment it describes */
+		if (mode == elfGeneratorSelfModeCompressedBlocks)
+		{
+			memcpy(file.data + segmentsOffset + segmentIndex++ * SELF_SEGMENT_SIZE, extents, sizeof(extents));
+		}
+
+		memcpy(file.data + segmentsOffset + segmentIndex++ * SELF_SEGMENT_SIZE, segment, sizeof(segment));
+	}
+
+	if (file.failed)
+	{
+		free(file.data);
+		return 0;
+	}
+
+	self->data = file.data;
+	self->size = file.size;
+	return 1;
+}
+
+void elfGeneratorFree(ElfGeneratorImage_t *image)
+{
+	free(image->data);
+	image->data = NULL;
+	image->size = 0;
+}
@@ -0,0 +1,61 @@
+#ifndef _ELF_GENERATOR_H_
+#define _ELF_GENERATOR_H_
+
+#include <stdint.h>
+
+typedef enum ElfGeneratorEhFrame_e
+{
+	elfGeneratorEhFrameNone,
+	elfGeneratorEhFrameSearchTable, /* .eh_frame_hdr with a sorted search table, as linkers write it */
+	elfGeneratorEhFrameUnsortedTable, /* search table in reverse order, readers must reject it */
+	elfGeneratorEhFrameNoTable, /* .eh_frame_hdr without a search table */
+} ElfGeneratorEhFrame_t;
+
+/*
+ * Generates SCE dynamic ELF images with a fully synthetic but valid layout.
+ * Symbol "<module>_sym<N>" is exported by module <module> from library "<module>_lib<N % exportLibrariesCount>".
+ * Import number N refers to "<importModule>_sym<N>" of library "<importModule>_lib<N % importLibrariesCount>",
+ * so a module generated with the same names and library count resolves every import.
+ */
+typedef struct ElfGeneratorConfig_s
+{
+	const char *moduleName;
+	uint32_t exportSymbolsCount;
+	uint32_t exportLibrariesCount;
+
+	const char *importModuleName; /* NULL for no imports */
+	uint32_t importSymbolsCount;
+	uint32_t importLibrariesCount;
+
+	uint32_t rebaseRelocationsCount;
+	uint32_t importRelocationsCount;
+	uint32_t tlsRelocationsCount;
+	uint32_t jumpSlotsCount;
+	uint32_t segmentsCount; /* PT_LOAD segments, first one is code */
+	ElfGeneratorEhFrame_t ehFrame; /* one FDE per export in a read only segment after the data, found by PT_GNU_EH_FRAME */
+} ElfGeneratorConfig_t;
+
+typedef struct ElfGeneratorImage_s
+{
+	uint8_t *data;
+	uint64_t size;
+} ElfGeneratorImage_t;
+
+#define ELF_GENERATOR_MAX_LIBRARIES 12
+
+int elfGeneratorGenerate(const ElfGeneratorConfig_t *config, ElfGeneratorImage_t *image);
+typedef enum ElfGeneratorSelfMode_e
+{
+	elfGeneratorSelfModePlain,
+	elfGeneratorSelfModeCompressed, /* each segment is one zlib stream */
+	elfGeneratorSelfModeCompressedBlocks, /* 16K blocks compressed one by one, with an extent table segment each */
+} ElfGeneratorSelfMode_t;
+
+/*
+ * Wraps a generated image into a fake signed SELF, one blocked segment per loadable or dynamic program.
+ * The compressed modes need ORBIS_ELF_WITH_ZLIB and fail without it.
+ */
+int elfGeneratorWrapSelf(const ElfGeneratorImage_t *elf, ElfGeneratorSelfMode_t mode, ElfGeneratorImage_t *self);
+void elfGeneratorFree(ElfGeneratorImage_t *image);
+
+#endif /* _ELF_GENERATOR_H_ */
@@ -0,0 +1,1116 @@
+#include "elf-generator.h"
+
+#include <orbis-elf-api.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+	#include <time.h>
+#endif
+
+#define MIN_BENCHMARK_TIME_NS 200000000ull
+#define LOOKUPS_COUNT 256
+#define STUB_PAGE_SIZE 0x1000
+
+typedef struct
+{
+	const char *name;
+	uint32_t symbolsCount;
+	uint32_t librariesCount;
+	uint32_t rebaseRelocationsCount;
+	uint32_t importRelocationsCount;
+	uint32_t tlsRelocationsCount;
+	uint32_t jumpSlotsCount;
+	uint32_t segmentsCount;
+} Preset_t;
+
+static const Preset_t presets[] = {
+	{ "small", 200, 2, 2000, 500, 30, 200, 2 },
+	{ "medium", 5000, 6, 50000, 10000, 300, 5000, 4 },
+	{ "large", 20000, 12, 500000, 100000, 3000, 20000, 8 },
+};
+
+typedef struct
+{
+	ElfGeneratorImage_t providerImage;
+	ElfGeneratorImage_t appImage;
+	ElfGeneratorImage_t prelinkedImage;
+	ElfGeneratorImage_t selfImage;
+	ElfGeneratorImage_t unsortedFdeImage; /* provider with its .eh_frame_hdr search table reversed */
+	ElfGeneratorImage_t noTableFdeImage; /* provider with no .eh_frame_hdr search table */
+	OrbisElfHandle_t provider;
+	OrbisElfHandle_t app;
+	OrbisElfHandle_t replacement;
+	OrbisElfStringTableHandle_t stringTable;
+	OrbisElfCacheHandle_t cache;
+	OrbisElfSelfHandle_t self;
+	OrbisElfStubTableHandle_t stubTable;
+	void *providerMemory;
+	void *appMemory;
+	void *replacementMemory;
+	void *fdeMemory;
+	void *parseMemory;
+	uint64_t parseMemorySize;
+	uint8_t *stubMemory;
+	uint64_t stubMemorySize;
+	const char *lookupNames[LOOKUPS_COUNT];
+	const char *lookupLibraries[LOOKUPS_COUNT];
+	uint64_t lookupsCount;
+} Fixture_t;
+
+typedef struct
+{
+	const char *name;
+	void (*setup)(Fixture_t *fixture);
+	uint64_t (*run)(Fixture_t *fixture); /* returns operations count */
+	void (*teardown)(Fixture_t *fixture);
+} Benchmark_t;
+
+static uint64_t nowNs(void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER frequency;
+	LARGE_INTEGER counter;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&counter);
+	return (uint64_t)(counter.QuadPart / frequency.QuadPart * 1000000000ull + counter.QuadPart % frequency.QuadPart * 1000000000ull / frequency.QuadPart);
+#else
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return (uint64_t)time.tv_sec * 1000000000ull + time.tv_nsec;
+#endif
+}
+
+static uint64_t memoryRead(uint64_t offset, void *destination, uint64_t size, void *readUserData)
+{
+	const ElfGeneratorImage_t *image = readUserData;
+
+	if (offset >= image->size)
+	{
+		return 0;
+	}
+
+	if (size > image->size - offset)
+	{
+		size = image->size - offset;
+	}
+
+	memcpy(destination, image->data + offset, size);
+	return size;
+}
+
+static OrbisElfHandle_t parseImageWithOptions(ElfGeneratorImage_t *image, uint32_t flags, OrbisElfStringTableHandle_t stringTable)
+{
+	OrbisElfHandle_t elf;
+	OrbisElfParseOptions_t options;
+	memset(&options, 0, sizeof(options));
+	options.flags = flags;
+	options.stringTable = stringTable;
+
+	if (orbisElfParseWithOptions(&elf, memoryRead, image->size, image, &options) != orbisElfErrorCodeOk)
+	{
+		fprintf(stderr, "Generated image parsing failed\n");
+		exit(1);
+	}
+
+	return elf;
+}
+
+static OrbisElfHandle_t parseImageWithFlags(ElfGeneratorImage_t *image, uint32_t flags)
+{
+	return parseImageWithOptions(image, flags, NULL);
+}
+
+static uint64_t memoryWrite(uint64_t offset, const void *source, uint64_t size, void *writeUserData)
+{
+	ElfGeneratorImage_t *image = writeUserData;
+
+	if (offset + size > image->size)
+	{
+		uint8_t *data = realloc(image->data, offset + size);
+
+		if (!data)
+		{
+			return 0;
+		}
+
+		memset(data + image->size, 0, offset + size - image->size);
+		image->data = data;
+		image->size = offset + size;
+	}
+
+	memcpy(image->data + offset, source, size);
+	return size;
+}
+
+static OrbisElfHandle_t parseImage(ElfGeneratorImage_t *image)
+{
+	return parseImageWithFlags(image, orbisElfParseFlagNone);
+}
+
+static void *loadImage(OrbisElfHandle_t elf, void *memory, uint64_t virtualBaseAddress)
+{
+	if (!memory)
+	{
+		memory = calloc(1, orbisElfGetLoadSize(elf));
+
+		if (!memory)
+		{
+			fprintf(stderr, "Out of memory\n");
+			exit(1);
+		}
+	}
+
+	if (orbisElfLoad(elf, memory, virtualBaseAddress) != orbisElfErrorCodeOk)
+	{
+		fprintf(stderr, "Generated image loading failed\n");
+		exit(1);
+	}
+
+	return memory;
+}
+
+static void setupParsed(Fixture_t *fixture)
+{
+	fixture->provider = parseImage(&fixture->providerImage);
+	fixture->app = parseImage(&fixture->appImage);
+}
+
+static void setupLoaded(Fixture_t *fixture)
+{
+	setupParsed(fixture);
+	fixture->providerMemory = loadImage(fixture->provider, fixture->providerMemory, 0x800000000ull);
+	fixture->appMemory = loadImage(fixture->app, fixture->appMemory, 0x400000ull);
+}
+
+static void setupValidated(Fixture_t *fixture)
+{
+	fixture->provider = parseImageWithFlags(&fixture->providerImage, orbisElfParseFlagValidate);
+	fixture->app = parseImageWithFlags(&fixture->appImage, orbisElfParseFlagValidate);
+	fixture->providerMemory = loadImage(fixture->provider, fixture->providerMemory, 0x800000000ull);
+	fixture->appMemory = loadImage(fixture->app, fixture->appMemory, 0x400000ull);
+}
+
+static void teardownParsed(Fixture_t *fixture)
+{
+	if (fixture->provider)
+	{
+		orbisElfDestroy(fixture->provider);
+		fixture->provider = NULL;
+	}
+
+	if (fixture->app)
+	{
+		orbisElfDestroy(fixture->app);
+		fixture->app = NULL;
+	}
+}
+
+static void noop(Fixture_t *fixture)
+{
+	(void)fixture;
+}
+
+static uint64_t runParse(Fixture_t *fixture)
+{
+	fixture->app = parseImage(&fixture->appImage);
+	return 1;
+}
+
+static void setupParseInPlace(Fixture_t *fixture)
+{
+	if (orbisElfQueryParseSize(memoryRead, fixture->appImage.size, &fixture->appImage, NULL, &fixture->parseMemorySize) == orbisElfErrorCodeOk)
+	{
+		fixture->parseMemory = malloc(fixture->parseMemorySize);
+	}
+}
+
+static uint64_t runParseInPlace(Fixture_t *fixture)
+{
+	if (!fixture->parseMemory || orbisElfParseInPlace(&fixture->app, fixture->parseMemory, fixture->parseMemorySize, memoryRead, fixture->appImage.size, &fixture->appImage, NULL) != orbisElfErrorCodeOk)
+	{
+		fprintf(stderr, "in place parsing failed\n");
+		exit(1);
+	}
+
+	return 1;
+}
+
+static void teardownParseInPlace(Fixture_t *fixture)
+{
+	teardownParsed(fixture);
+	free(fixture->parseMemory);
+	fixture->parseMemory = NULL;
+}
+
+static uint64_t runClone(Fixture_t *fixture)
+{
+	OrbisElfHandle_t clone;
+
+	if (orbisElfClone(fixture->app, &clone) != orbisElfErrorCodeOk)
+	{
+		fprintf(stderr, "orbisElfClone failed\n");
+		exit(1);
+	}
+
+	orbisElfDestroy(clone);
+	return 1;
+}
+
+static const OrbisElfCacheKey_t appCacheKey = { 1, 2, 3, 4 };
+
+static uint64_t runCacheOpen(Fixture_t *fixture)
+{
+	OrbisElfHandle_t elf;
+
+	if (orbisElfCacheOpen(fixture->cache, &appCacheKey, &elf, memoryRead, fixture->appImage.size, &fixture->appImage, NULL) != orbisElfErrorCodeOk)
+	{
+		fprintf(stderr, "orbisElfCacheOpen failed\n");
+		exit(1);
+	}
+
+	orbisElfDestroy(elf);
+	return 1;
+}
+
+static void setupCached(Fixture_t *fixture)
+{
+	setupParsed(fixture);
+
+	if (orbisElfCacheCreate(&fixture->cache) != orbisElfErrorCodeOk)
+	{
+		fprintf(stderr, "orbisElfCacheCreate failed\n");
+		exit(1);
+	}
+
+	/* the first open parses, the measured ones hit */
+	runCacheOpen(fixture);
+}
+
+static void teardownCached(Fixture_t *fixture)
+{
+	teardownParsed(fixture);
+	orbisElfCacheDestroy(fixture->cache);
+	fixture->cache = NULL;
+}
+
+static uint64_t runLoad(Fixture_t *fixture)
+{
+	fixture->appMemory = loadImage(fixture->app, fixture->appMemory, 0x400000ull);
+	return 1;
+}
+
+static void setupLoad(Fixture_t *fixture)
+{
+	fixture->app = parseImage(&fixture->appImage);
+}
+
+static uint64_t runImportModule(Fixture_t *fixture)
+{
+	orbisElfImportModule(fixture->app, fixture->provider);
+	return 1;
+}
+
+static void setupInterned(Fixture_t *fixture)
+{
+	if (orbisElfStringTableCreate(&fixture->stringTable) != orbisElfErrorCodeOk)
+	{
+		fprintf(stderr, "orbisElfStringTableCreate failed\n");
+		exit(1);
+	}
+
+	fixture->provider = parseImageWithOptions(&fixture->providerImage, orbisElfParseFlagNone, fixture->stringTable);
+	fixture->app = parseImageWithOptions(&fixture->appImage, orbisElfParseFlagNone, fixture->stringTable);
+	fixture->providerMemory = loadImage(fixture->provider, fixture->providerMemory, 0x800000000ull);
+	fixture->appMemory = loadImage(fixture->app, fixture->appMemory, 0x400000ull);
+}
+
+static void teardownInterned(Fixture_t *fixture)
+{
+	teardownParsed(fixture);
+	orbisElfStringTableDestroy(fixture->stringTable);
+	fixture->stringTable = NULL;
+}
+
+static uint64_t runSetImportSymbol(Fixture_t *fixture)
+{
+	const char *moduleName = orbisElfGetModuleInfo(fixture->provider)->name;
+
+	for (uint64_t i = 0; i < fixture->lookupsCount; ++i)
+	{
+		orbisElfSetImportSymbol(fixture->app, moduleName, fixture->lookupLibraries[i], fixture->lookupNames[i], 0x800000000ull, 0x1000 + i * 16, 16);
+	}
+
+	return fixture->lookupsCount;
+}
+
+static uint64_t runRebindSymbol(Fixture_t *fixture)
+{
+	uint64_t rebound = 0;
+
+	/* the first call also builds the symbol to relocations index */
+	for (uint64_t i = 0, count = orbisElfGetSymbolsCount(fixture->app); i < count; ++i)
+	{
+		if (orbisElfGetSymbol(fixture->app, i)->header.value)
+		{
+			continue;
+		}
+
+		orbisElfRebindSymbol(fixture->app, i, 0x800000000ull, 0x1000 + i * 16, 16);
+		++rebound;
+	}
+
+	return rebound;
+}
+
+static void setupReplace(Fixture_t *fixture)
+{
+	setupLoaded(fixture);
+	orbisElfImportModule(fixture->app, fixture->provider);
+	fixture->replacement = parseImage(&fixture->providerImage);
+	fixture->replacementMemory = loadImage(fixture->replacement, fixture->replacementMemory, 0x900000000ull);
+}
+
+static uint64_t runReplaceModule(Fixture_t *fixture)
+{
+	/* hot reload and back, only the app slots bound into the provider are patched */
+	if (orbisElfReplaceModule(fixture->provider, fixture->replacement) != orbisElfErrorCodeOk ||
+	    orbisElfReplaceModule(fixture->replacement, fixture->provider) != orbisElfErrorCodeOk)
+	{
+		fprintf(stderr, "orbisElfReplaceModule failed\n");
+		exit(1);
+	}
+
+	return 2;
+}
+
+static void teardownReplace(Fixture_t *fixture)
+{
+	orbisElfDestroy(fixture->replacement);
+	fixture->replacement = NULL;
+	teardownParsed(fixture);
+}
+
+static uint64_t runFindSymbolByName(Fixture_t *fixture)
+{
+	uint64_t found = 0;
+
+	for (uint64_t i = 0; i < fixture->lookupsCount; ++i)
+	{
+		found += orbisElfFindSymbolByName(fixture->provider, fixture->lookupNames[i]) != NULL;
+	}
+
+	if (found != fixture->lookupsCount)
+	{
+		fprintf(stderr, "orbisElfFindSymbolByName missed %" PRIu64 " symbols\n", fixture->lookupsCount - found);
+		exit(1);
+	}
+
+	return fixture->lookupsCount;
+}
+
+static uint64_t runFindSymbolByAddress(Fixture_t *fixture)
+{
+	uint64_t virtualBaseAddress = orbisElfGetVirtualBaseAddress(fixture->provider);
+	uint64_t found = 0;
+	uint64_t missed = 0;
+
+	/* the first call also builds the address index */
+	for (uint64_t i = 0, count = orbisElfGetSymbolsCount(fixture->provider); i < count; ++i)
+	{
+		const OrbisElfSymbol_t *symbol = orbisElfGetSymbol(fixture->provider, i);
+
+		if (!symbol->header.shndx || !symbol->header.value)
+		{
+			continue;
+		}
+
+		uint64_t offset;
+		const OrbisElfSymbol_t *result = orbisElfFindSymbolByAddress(fixture->provider, virtualBaseAddress + symbol->header.value + symbol->header.size / 2, &offset);
+		missed += !result || result->header.value != symbol->header.value;
+		++found;
+	}
+
+	if (missed)
+	{
+		fprintf(stderr, "orbisElfFindSymbolByAddress missed %" PRIu64 " symbols\n", missed);
+		exit(1);
+	}
+
+	return found;
+}
+
+static uint64_t runRelocate(Fixture_t *fixture)
+{
+	OrbisElfHandle_t elf = fixture->app;
+	char *base = orbisElfGetBaseAddress(elf);
+	uint64_t virtualBaseAddress = orbisElfGetVirtualBaseAddress(elf);
+	uint64_t rebasesCount = orbisElfGetRebaseRelocationsCount(elf);
+	uint64_t importsCount = orbisElfGetImportRelocationsCount(elf);
+	uint64_t tlsCount = orbisElfGetTlsRelocationsCount(elf);
+
+	for (uint64_t i = 0; i < rebasesCount; ++i)
+	{
+		const OrbisElfRebaseRelocation_t *rebase = orbisElfGetRebaseRelocation(elf, i);
+		uint64_t value = virtualBaseAddress + rebase->value;
+		memcpy(base + rebase->offset, &value, sizeof(value));
+	}
+
+	for (uint64_t i = 0; i < importsCount; ++i)
+	{
+		OrbisElfRelocation_t *relocation = orbisElfGetImportRelocation(elf, i);
+		orbisElfWriteRelocation(base + orbisElfGetRelocationOffset(relocation), orbisElfGetRelocationAddressSize(relocation),
+			orbisElfGetRelocationInjectType(relocation), orbisElfGetImportRelocationValue(elf, relocation));
+	}
+
+	for (uint64_t i = 0; i < tlsCount; ++i)
+	{
+		OrbisElfRelocation_t *relocation = orbisElfGetTlsRelocation(elf, i);
+		orbisElfWriteRelocation(base + orbisElfGetRelocationOffset(relocation), orbisElfGetRelocationAddressSize(relocation),
+			orbisElfGetRelocationInjectType(relocation), orbisElfGetTlsRelocationValue(elf, relocation, 1, 0x100));
+	}
+
+	return rebasesCount + importsCount + tlsCount;
+}
+
+static uint64_t runRelocateRebases(Fixture_t *fixture)
+{
+	if (orbisElfRelocateRebases(fixture->app) != orbisElfErrorCodeOk)
+	{
+		fprintf(stderr, "orbisElfRelocateRebases failed\n");
+		exit(1);
+	}
+
+	return orbisElfGetRebaseRelocationsCount(fixture->app);
+}
+
+static uint64_t runRelocatePages(Fixture_t *fixture)
+{
+	/* every page, to compare with relocation application, a lazy host only pays for the touched ones */
+	uint64_t pagesCount = (orbisElfGetLoadSize(fixture->app) + 0xfff) / 0x1000;
+
+	for (uint64_t i = 0; i < pagesCount; ++i)
+	{
+		if (orbisElfRelocatePage(fixture->app, 0x1000, i) != orbisElfErrorCodeOk)
+		{
+			fprintf(stderr, "orbisElfRelocatePage failed\n");
+			exit(1);
+		}
+	}
+
+	return orbisElfGetRebaseRelocationsCount(fixture->app) + orbisElfGetImportRelocationsCount(fixture->app);
+}
+
+static void setupPrelinked(Fixture_t *fixture)
+{
+	/* prelinked away from where it is loaded, so every site takes the delta */
+	OrbisElfHandle_t app = parseImage(&fixture->appImage);
+	OrbisElfErrorCode_t errorCode = orbisElfPrelink(app, 0x10000000ull, memoryWrite, &fixture->prelinkedImage);
+	orbisElfDestroy(app);
+
+	if (errorCode != orbisElfErrorCodeOk)
+	{
+		fprintf(stderr, "orbisElfPrelink failed\n");
+		exit(1);
+	}
+
+	fixture->app = parseImage(&fixture->prelinkedImage);
+	fixture->appMemory = loadImage(fixture->app, fixture->appMemory, 0x400000ull);
+}
+
+static void teardownPrelinked(Fixture_t *fixture)
+{
+	teardownParsed(fixture);
+	elfGeneratorFree(&fixture->prelinkedImage);
+}
+
+static void wrapSelf(Fixture_t *fixture, ElfGeneratorSelfMode_t mode)
+{
+	if (!elfGeneratorWrapSelf(&fixture->appImage, mode, &fixture->selfImage) ||
+	    orbisElfSelfOpen(&fixture->self, memoryRead, fixture->selfImage.size, &fixture->selfImage) != orbisElfErrorCodeOk)
+	{
+		fprintf(stderr, "fSELF wrapping failed\n");
+		exit(1);
+	}
+}
+
+static void setupSelf(Fixture_t *fixture)
+{
+	wrapSelf(fixture, elfGeneratorSelfModePlain);
+}
+
+static uint64_t runSelfParse(Fixture_t *fixture)
+{
+	if (orbisElfParse(&fixture->app, orbisElfSelfRead, orbisElfSelfGetImageSize(fixture->self), fixture->self) != orbisElfErrorCodeOk)
+	{
+		fprintf(stderr, "fSELF parsing failed\n");
+		exit(1);
+	}
+
+	return 1;
+}
+
+static void setupSelfLoad(Fixture_t *fixture)
+{
+	setupSelf(fixture);
+	runSelfParse(fixture);
+}
+
+#ifdef ORBIS_ELF_WITH_ZLIB
+static void setupCompressedSelf(Fixture_t *fixture)
+{
+	wrapSelf(fixture, elfGeneratorSelfModeCompressed);
+}
+
+static void setupCompressedSelfLoad(Fixture_t *fixture)
+{
+	setupCompressedSelf(fixture);
+	runSelfParse(fixture);
+}
+
+static void setupBlockedSelf(Fixture_t *fixture)
+{
+	wrapSelf(fixture, elfGeneratorSelfModeCompressedBlocks);
+}
+
+static void setupBlockedSelfLoad(Fixture_t *fixture)
+{
+	setupBlockedSelf(fixture);
+	runSelfParse(fixture);
+}
+#endif
+
+static void teardownSelf(Fixture_t *fixture)
+{
+	teardownParsed(fixture);
+	orbisElfSelfDestroy(fixture->self);
+	fixture->self = NULL;
+	elfGeneratorFree(&fixture->selfImage);
+}
+
+static uint64_t runTlsApply(Fixture_t *fixture)
+{
+	OrbisElfHandle_t elfs[2] = { fixture->app, fixture->provider };
+	OrbisElfTlsModule_t modules[2];
+	uint64_t staticSize;
+	uint64_t staticAlign;
+
+	if (orbisElfTlsPlan(elfs, 2, modules, &staticSize, &staticAlign) != orbisElfErrorCodeOk || orbisElfTlsApply(modules, 2) != orbisElfErrorCodeOk)
+	{
+		fprintf(stderr, "orbisElfTlsApply failed\n");
+		exit(1);
+	}
+
+	return orbisElfGetTlsRelocationsCount(fixture->app) + orbisElfGetTlsRelocationsCount(fixture->provider);
+}
+
+#if defined(__x86_64__) || defined(_M_X64)
+static uint8_t *allocatePages(uint64_t size)
+{
+#ifdef _WIN32
+	return VirtualAlloc(NULL, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+#else
+	void *memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	return memory == MAP_FAILED ? NULL : memory;
+#endif
+}
+
+static int protectCode(void *memory, uint64_t size)
+{
+#ifdef _WIN32
+	DWORD oldProtection;
+	return VirtualProtect(memory, size, PAGE_EXECUTE_READ, &oldProtection) != 0;
+#else
+	return mprotect(memory, size, PROT_READ | PROT_EXEC) == 0;
+#endif
+}
+
+static void freePages(void *memory, uint64_t size)
+{
+#ifdef _WIN32
+	(void)size;
+	VirtualFree(memory, 0, MEM_RELEASE);
+#else
+	munmap(memory, size);
+#endif
+}
+
+static void setupStubs(Fixture_t *fixture)
+{
+	setupLoaded(fixture);
+
+	if (orbisElfStubTableCreate(&fixture->stubTable) != orbisElfErrorCodeOk || orbisElfStubTableAddModule(fixture->stubTable, fixture->app) != orbisElfErrorCodeOk)
+	{
+		fprintf(stderr, "orbisElfStubTableAddModule failed\n");
+		exit(1);
+	}
+
+	/* the dispatcher is a lone ret in the page after the table, so a thunk call returns its stub index in eax */
+	uint64_t tableSize = orbisElfStubTableGetSize(fixture->stubTable);
+	fixture->stubMemorySize = tableSize + STUB_PAGE_SIZE;
+	fixture->stubMemory = allocatePages(fixture->stubMemorySize);
+
+	if (!fixture->stubMemory)
+	{
+		fprintf(stderr, "Stub memory allocation failed\n");
+		exit(1);
+	}
+
+	fixture->stubMemory[tableSize] = 0xc3;
+
+	if (orbisElfStubTableBuild(fixture->stubTable, fixture->stubMemory, 0, (uint64_t)(fixture->stubMemory + tableSize)) != orbisElfErrorCodeOk)
+	{
+		fprintf(stderr, "orbisElfStubTableBuild failed\n");
+		exit(1);
+	}
+
+	const OrbisElfStub_t *firstStub = orbisElfStubTableGetStub(fixture->stubTable, 0);
+	uint64_t codeSize = firstStub ? (uint64_t)((uint8_t *)firstStub->slot - fixture->stubMemory) : 0;
+
+	if ((codeSize && !protectCode(fixture->stubMemory, codeSize)) || !protectCode(fixture->stubMemory + tableSize, STUB_PAGE_SIZE))
+	{
+		fprintf(stderr, "Stub code protection failed\n");
+		exit(1);
+	}
+}
+
+static uint64_t runStubCalls(Fixture_t *fixture)
+{
+	const char *base = orbisElfGetBaseAddress(fixture->app);
+	uint64_t calls = 0;
+
+	/* every jump slot of the app was rebound to a thunk, call through the slot as the PLT would */
+	for (uint64_t i = 0, count = orbisElfGetImportRelocationsCount(fixture->app); i < count; ++i)
+	{
+		OrbisElfRelocation_t *relocation = orbisElfGetImportRelocation(fixture->app, i);
+		uint64_t target;
+
+		if (relocation->relType != orbisElfRelocationTypeJumpSlot)
+		{
+			continue;
+		}
+
+		memcpy(&target, base + orbisElfGetRelocationOffset(relocation), sizeof(target));
+		uint32_t stubIndex = ((uint32_t (*)(void))(uintptr_t)target)();
+
+		if (target < (uint64_t)fixture->stubMemory || stubIndex != (target - (uint64_t)fixture->stubMemory) / 16)
+		{
+			fprintf(stderr, "Jump slot at 0x%" PRIx64 " reached the wrong thunk\n", orbisElfGetRelocationOffset(relocation));
+			exit(1);
+		}
+
+		++calls;
+	}
+
+	return calls;
+}
+
+static void teardownStubs(Fixture_t *fixture)
+{
+	orbisElfStubTableDestroy(fixture->stubTable);
+	fixture->stubTable = NULL;
+	freePages(fixture->stubMemory, fixture->stubMemorySize);
+	fixture->stubMemory = NULL;
+	teardownParsed(fixture);
+}
+#endif
+
+static void setupFde(Fixture_t *fixture, ElfGeneratorImage_t *image)
+{
+	/* the search table size changes the load size, so these don't share the provider memory */
+	fixture->provider = parseImage(image);
+	fixture->fdeMemory = loadImage(fixture->provider, NULL, 0x800000000ull);
+}
+
+static void setupUnsortedFde(Fixture_t *fixture)
+{
+	setupFde(fixture, &fixture->unsortedFdeImage);
+}
+
+static void setupNoTableFde(Fixture_t *fixture)
+{
+	setupFde(fixture, &fixture->noTableFdeImage);
+}
+
+static uint64_t runFindFde(Fixture_t *fixture)
+{
+	uint64_t virtualBaseAddress = orbisElfGetVirtualBaseAddress(fixture->provider);
+	uint64_t found = 0;
+	uint64_t missed = 0;
+
+	/* the first call also validates the search table, or rebuilds it from .eh_frame */
+	for (uint64_t i = 0, count = orbisElfGetSymbolsCount(fixture->provider); i < count; ++i)
+	{
+		const OrbisElfSymbol_t *symbol = orbisElfGetSymbol(fixture->provider, i);
+		OrbisElfFde_t fde;
+
+		if (!symbol->header.shndx || !symbol->header.value || symbol->type != orbisElfSymbolTypeFunction)
+		{
+			continue;
+		}
+
+		uint64_t address = virtualBaseAddress + symbol->header.value;
+		missed += orbisElfFindFde(fixture->provider, address + symbol->header.size / 2, &fde) != orbisElfErrorCodeOk || fde.pcBegin != address
+			|| fde.pcEnd != address + symbol->header.size;
+		++found;
+	}
+
+	if (missed)
+	{
+		fprintf(stderr, "orbisElfFindFde missed %" PRIu64 " functions\n", missed);
+		exit(1);
+	}
+
+	return found;
+}
+
+static void teardownFde(Fixture_t *fixture)
+{
+	teardownParsed(fixture);
+	free(fixture->fdeMemory);
+	fixture->fdeMemory = NULL;
+}
+
+static uint64_t runRelocateValidated(Fixture_t *fixture)
+{
+	OrbisElfHandle_t elf = fixture->app;
+	OrbisElfTables_t tables;
+	char *base = orbisElfGetBaseAddress(elf);
+	uint64_t virtualBaseAddress = orbisElfGetVirtualBaseAddress(elf);
+
+	if (orbisElfGetTables(elf, &tables) != orbisElfErrorCodeOk)
+	{
+		fprintf(stderr, "orbisElfGetTables failed\n");
+		exit(1);
+	}
+
+	for (uint64_t i = 0; i < tables.rebaseRelocationsCount; ++i)
+	{
+		const OrbisElfRebaseRelocation_t *rebase = orbisElfTablesGetRebaseRelocation(&tables, i);
+		uint64_t value = virtualBaseAddress + rebase->value;
+		memcpy(base + rebase->offset, &value, sizeof(value));
+	}
+
+	for (uint64_t i = 0; i < tables.importRelocationsCount; ++i)
+	{
+		OrbisElfRelocation_t *relocation = (OrbisElfRelocation_t *)orbisElfTablesGetImportRelocation(&tables, i);
+		orbisElfWriteRelocation(base + relocation->offset, orbisElfGetRelocationAddressSize(relocation),
+			orbisElfGetRelocationInjectType(relocation), orbisElfGetImportRelocationValue(elf, relocation));
+	}
+
+	for (uint64_t i = 0; i < tables.tlsRelocationsCount; ++i)
+	{
+		OrbisElfRelocation_t *relocation = (OrbisElfRelocation_t *)orbisElfTablesGetTlsRelocation(&tables, i);
+		orbisElfWriteRelocation(base + relocation->offset, orbisElfGetRelocationAddressSize(relocation),
+			orbisElfGetRelocationInjectType(relocation), orbisElfGetTlsRelocationValue(elf, relocation, 1, 0x100));
+	}
+
+	return tables.rebaseRelocationsCount + tables.importRelocationsCount + tables.tlsRelocationsCount;
+}
+
+static const Benchmark_t benchmarks[] = {
+	{ "orbisElfParse", noop, runParse, teardownParsed },
+	{ "orbisElfParseInPlace", setupParseInPlace, runParseInPlace, teardownParseInPlace },
+	{ "orbisElfClone", setupParsed, runClone, teardownParsed },
+	{ "orbisElfCacheOpen hit", setupCached, runCacheOpen, teardownCached },
+	{ "orbisElfLoad", setupLoad, runLoad, teardownParsed },
+	{ "fSELF orbisElfParse", setupSelf, runSelfParse, teardownSelf },
+	{ "fSELF orbisElfLoad", setupSelfLoad, runLoad, teardownSelf },
+#ifdef ORBIS_ELF_WITH_ZLIB
+	{ "zlib fSELF parse", setupCompressedSelf, runSelfParse, teardownSelf },
+	{ "zlib fSELF load", setupCompressedSelfLoad, runLoad, teardownSelf },
+	{ "zlib blocks fSELF parse", setupBlockedSelf, runSelfParse, teardownSelf },
+	{ "zlib blocks fSELF load", setupBlockedSelfLoad, runLoad, teardownSelf },
+#endif
+	{ "orbisElfImportModule", setupLoaded, runImportModule, teardownParsed },
+	{ "orbisElfSetImportSymbol", setupLoaded, runSetImportSymbol, teardownParsed },
+	{ "interned ImportModule", setupInterned, runImportModule, teardownInterned },
+	{ "interned SetImportSymbol", setupInterned, runSetImportSymbol, teardownInterned },
+	{ "orbisElfRebindSymbol", setupLoaded, runRebindSymbol, teardownParsed },
+	{ "orbisElfReplaceModule", setupReplace, runReplaceModule, teardownReplace },
+	{ "orbisElfFindSymbolByName", setupParsed, runFindSymbolByName, teardownParsed },
+	{ "orbisElfFindSymbolByAddress", setupLoaded, runFindSymbolByAddress, teardownParsed },
+	{ "orbisElfFindFde", setupLoaded, runFindFde, teardownParsed },
+	{ "FindFde unsorted table", setupUnsortedFde, runFindFde, teardownFde },
+	{ "FindFde without table", setupNoTableFde, runFindFde, teardownFde },
+	{ "relocation application", setupLoaded, runRelocate, teardownParsed },
+	{ "validated relocation", setupValidated, runRelocateValidated, teardownParsed },
+	{ "orbisElfRelocateRebases", setupLoaded, runRelocateRebases, teardownParsed },
+	{ "prelinked rebase delta", setupPrelinked, runRelocateRebases, teardownPrelinked },
+	{ "orbisElfRelocatePage", setupLoaded, runRelocatePages, teardownParsed },
+	{ "orbisElfTlsApply", setupLoaded, runTlsApply, teardownParsed },
+#if defined(__x86_64__) || defined(_M_X64)
+	{ "stub thunk calls", setupStubs, runStubCalls, teardownStubs },
+#endif
+};
+
+static int writeImage(const char *directory, const char *presetName, const char *moduleName, const ElfGeneratorImage_t *image)
+{
+	char path[4096];
+	snprintf(path, sizeof(path), "%s/%s-%s.prx", directory, presetName, moduleName);
+
+	FILE *file = fopen(path, "wb");
+
+	if (!file)
+	{
+		fprintf(stderr, "File '%s' opening error\n", path);
+		return 0;
+	}
+
+	int isOk = fwrite(image->data, 1, image->size, file) == image->size;
+	isOk = fclose(file) == 0 && isOk;
+
+	if (!isOk)
+	{
+		fprintf(stderr, "File '%s' writing error\n", path);
+	}
+
+	return isOk;
+}
+
+static int runPreset(const Preset_t *preset, const char *outputDirectory, uint64_t minIterations)
+{
+	static const char providerName[] = "libBenchProvider";
+	static const char appName[] = "libBenchApp";
+
+	ElfGeneratorConfig_t providerConfig;
+	memset(&providerConfig, 0, sizeof(providerConfig));
+	providerConfig.moduleName = providerName;
+	providerConfig.exportSymbolsCount = preset->symbolsCount;
+	providerConfig.exportLibrariesCount = preset->librariesCount;
+	providerConfig.rebaseRelocationsCount = preset->rebaseRelocationsCount / 4;
+	providerConfig.segmentsCount = preset->segmentsCount;
+	providerConfig.ehFrame = elfGeneratorEhFrameSearchTable;
+
+	ElfGeneratorConfig_t appConfig;
+	memset(&appConfig, 0, sizeof(appConfig));
+	appConfig.moduleName = appName;
+	appConfig.exportSymbolsCount = preset->symbolsCount / 4;
+	appConfig.exportLibrariesCount = 1;
+	appConfig.importModuleName = providerName;
+	appConfig.importSymbolsCount = preset->symbolsCount;
+	appConfig.importLibrariesCount = preset->librariesCount;
+	appConfig.rebaseRelocationsCount = preset->rebaseRelocationsCount;
+	appConfig.importRelocationsCount = preset->importRelocationsCount;
+	appConfig.tlsRelocationsCount = preset->tlsRelocationsCount;
+	appConfig.jumpSlotsCount = preset->jumpSlotsCount;
+	appConfig.segmentsCount = preset->segmentsCount;
+
+	Fixture_t fixture;
+	memset(&fixture, 0, sizeof(fixture));
+
+	ElfGeneratorConfig_t unsortedFdeConfig = providerConfig;
+	unsortedFdeConfig.ehFrame = elfGeneratorEhFrameUnsortedTable;
+
+	ElfGeneratorConfig_t noTableFdeConfig = providerConfig;
+	noTableFdeConfig.ehFrame = elfGeneratorEhFrameNoTable;
+
+	if (!elfGeneratorGenerate(&providerConfig, &fixture.providerImage) || !elfGeneratorGenerate(&appConfig, &fixture.appImage)
+	    || !elfGeneratorGenerate(&unsortedFdeConfig, &fixture.unsortedFdeImage) || !elfGeneratorGenerate(&noTableFdeConfig, &fixture.noTableFdeImage))
+	{
+		fprintf(stderr, "Preset '%s' generation failed\n", preset->name);
+		elfGeneratorFree(&fixture.providerImage);
+		elfGeneratorFree(&fixture.appImage);
+		elfGeneratorFree(&fixture.unsortedFdeImage);
+		return 0;
+	}
+
+	if (outputDirectory
+	    && (!writeImage(outputDirectory, preset->name, providerName, &fixture.providerImage)
+	        || !writeImage(outputDirectory, preset->name, appName, &fixture.appImage)))
+	{
+		elfGeneratorFree(&fixture.providerImage);
+		elfGeneratorFree(&fixture.appImage);
+		elfGeneratorFree(&fixture.unsortedFdeImage);
+		elfGeneratorFree(&fixture.noTableFdeImage);
+		return 0;
+	}
+
+	/* lookup names are spread evenly over the provider exports */
+	OrbisElfHandle_t provider = parseImage(&fixture.providerImage);
+	uint64_t symbolsCount = orbisElfGetSymbolsCount(provider);
+	uint64_t exportsCount = 0;
+
+	for (uint64_t i = 0; i < symbolsCount; ++i)
+	{
+		exportsCount += orbisElfGetSymbol(provider, i)->library != NULL;
+	}
+
+	for (uint64_t i = 0, exportIndex = 0; i < symbolsCount && fixture.lookupsCount < LOOKUPS_COUNT; ++i)
+	{
+		const OrbisElfSymbol_t *symbol = orbisElfGetSymbol(provider, i);
+
+		if (!symbol->library)
+		{
+			continue;
+		}
+
+		if (exportIndex++ % ((exportsCount + LOOKUPS_COUNT - 1) / LOOKUPS_COUNT) == 0)
+		{
+			fixture.lookupNames[fixture.lookupsCount] = strdup(symbol->name);
+			fixture.lookupLibraries[fixture.lookupsCount] = strdup(symbol->library->name);
+			fixture.lookupsCount++;
+		}
+	}
+
+	orbisElfDestroy(provider);
+
+	printf("%s: %u symbols, %u libraries, %u rebases, %u imports, %u TLS, %u jump slots, %u segments, image %" PRIu64 " bytes\n",
+		preset->name, preset->symbolsCount, preset->librariesCount, preset->rebaseRelocationsCount, preset->importRelocationsCount,
+		preset->tlsRelocationsCount, preset->jumpSlotsCount, preset->segmentsCount, fixture.appImage.size);
+
+	for (size_t i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); ++i)
+	{
+		uint64_t iterations = 0;
+		uint64_t operations = 0;
+		uint64_t elapsed = 0;
+		uint64_t best = UINT64_MAX;
+		uint64_t wallBegin = nowNs();
+
+		/* the time budget includes setup and teardown, so slow fixtures don't multiply the run time */
+		while (iterations < minIterations || (nowNs() - wallBegin < MIN_BENCHMARK_TIME_NS && operations))
+		{
+			benchmarks[i].setup(&fixture);
+
+			uint64_t begin = nowNs();
+			uint64_t count = benchmarks[i].run(&fixture);
+			uint64_t time = nowNs() - begin;
+
+			benchmarks[i].teardown(&fixture);
+
+			elapsed += time;
+			operations += count;
+			iterations++;
+
+			if (count && time / count < best)
+			{
+				best = time / count;
+			}
+		}
+
+		printf("    %-28s %10" PRIu64 " iterations %14" PRIu64 " ns/op mean %14" PRIu64 " ns/op best\n",
+			benchmarks[i].name, iterations, operations ? elapsed / operations : 0, best);
+	}
+
+	printf("\n");
+
+	for (uint64_t i = 0; i < fixture.lookupsCount; ++i)
+	{
+		free((void *)fixture.lookupNames[i]);
+		free((void *)fixture.lookupLibraries[i]);
+	}
+
+	free(fixture.providerMemory);
+	free(fixture.appMemory);
+	free(fixture.replacementMemory);
+	elfGeneratorFree(&fixture.providerImage);
+	elfGeneratorFree(&fixture.appImage);
+	elfGeneratorFree(&fixture.unsortedFdeImage);
+	elfGeneratorFree(&fixture.noTableFdeImage);
+	return 1;
+}
+
+static void usage(const char *program)
+{
+	printf("usage: %s [OPTIONS]\n", program);
+	printf("    OPTIONS:\n");
+	printf("        -p <small|medium|large> - Run only one preset (default: all)\n");
+	printf("        -c <symbols>,<libraries>,<rebases>,<imports>,<tls>,<jump slots>,<segments> - Run custom counts\n");
+	printf("        -n <count> - Minimal iterations per benchmark (default: 3)\n");
+	printf("        -w <directory> - Write generated images to directory\n");
+}
+
+int main(int argc, const char *argv[])
+{
+	const Preset_t *selected = NULL;
+	Preset_t custom;
+	const char *outputDirectory = NULL;
+	uint64_t minIterations = 3;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "-h") == 0)
+		{
+			usage(argv[0]);
+			return 0;
+		}
+
+		if (i + 1 >= argc)
+		{
+			usage(argv[0]);
+			return 1;
+		}
+
+		if (strcmp(argv[i], "-p") == 0)
+		{
+			++i;
+
+			for (size_t j = 0; j < sizeof(presets) / sizeof(presets[0]); ++j)
+			{
+				if (strcmp(argv[i], presets[j].name) == 0)
+				{
+					selected = presets + j;
+				}
+			}
+
+			if (!selected)
+			{
+				usage(argv[0]);
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "-c") == 0)
+		{
+			++i;
+			memset(&custom, 0, sizeof(custom));
+			custom.name = "custom";
+
+			if (sscanf(argv[i], "%u,%u,%u,%u,%u,%u,%u", &custom.symbolsCount, &custom.librariesCount, &custom.rebaseRelocationsCount,
+				&custom.importRelocationsCount, &custom.tlsRelocationsCount, &custom.jumpSlotsCount, &custom.segmentsCount) != 7)
+			{
+				usage(argv[0]);
+				return 1;
+			}
+
+			selected = &custom;
+		}
+		else if (strcmp(argv[i], "-n") == 0)
+		{
+			minIterations = strtoull(argv[++i], NULL, 0);
+		}
+		else if (strcmp(argv[i], "-w") == 0)
+		{
+			outputDirectory = argv[++i];
+		}
+		else
+		{
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (!minIterations)
+	{
+		minIterations = 1;
+	}
+
+	if (selected)
+	{
+		return runPreset(selected, outputDirectory, minIterations) ? 0 : 1;
+	}
+
+	for (size_t i = 0; i < sizeof(presets) / sizeof(presets[0]); ++i)
+	{
+		if (!runPreset(presets + i, outputDirectory, minIterations))
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
@@ -2,12 +2,17 @@
 #include <stdio.h>
 #include <malloc.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/stat.h>
 #include <inttypes.h>
+#include <threads.h>
 
 #ifdef _WIN32
 	#define stat64 _stat64
+#else
+	#include <sys/mman.h>
 #endif
+
 const char *orbisElfErrorCodeToString(OrbisElfErrorCode_t error)
 {
 	switch (error)
@@ -104,6 +109,62 @@ const char *orbisElfProgramTypeToString(OrbisElfProgramType_t type)
 	return NULL;
 }
 
+const char *orbisElfInitializerTypeToString(OrbisElfInitializerType_t type)
+{
+	switch (type)
+	{
+	case orbisElfInitializerTypePreinitArray: return "preinit array";
+	case orbisElfInitializerTypeInit: return "init";
+	case orbisElfInitializerTypeInitArray: return "init array";
+	case orbisElfInitializerTypeFiniArray: return "fini array";
+	case orbisElfInitializerTypeFini: return "fini";
+
+	default:
+		break;
+	}
+
+	return "<unknown>";
+}
+
+const char *orbisElfPhaseToString(OrbisElfPhase_t phase)
+{
+	switch (phase)
+	{
+	case orbisElfPhaseParsePrograms: return "parse programs";
+	case orbisElfPhaseParseSections: return "parse sections";
+	case orbisElfPhaseParseDynamicProgram: return "parse dynamic";
+	case orbisElfPhaseParseSymbols: return "parse symbols";
+	case orbisElfPhaseParseRelocations: return "parse relocations";
+	case orbisElfPhaseValidate: return "validate";
+	case orbisElfPhaseParseEhFrame: return "parse eh frame";
+	case orbisElfPhaseLoad: return "load";
+	case orbisElfPhaseResolve: return "resolve";
+
+	default:
+		break;
+	}
+
+	return "<unknown>";
+}
+
+const char *orbisElfDiagnosticToString(OrbisElfDiagnostic_t diagnostic)
+{
+	switch (diagnostic)
+	{
+	case orbisElfDiagnosticUnhandledDynamicType: return "unhandled dynamic type";
+	case orbisElfDiagnosticDebugDynamic: return "DT_DEBUG with value";
+	case orbisElfDiagnosticTextRelocations: return "DT_TEXTREL with value";
+	case orbisElfDiagnosticCopyRelocation: return "R_X86_64_COPY in shared library";
+	case orbisElfDiagnosticUnsupportedImportRelocation: return "unsupported import relocation";
+	case orbisElfDiagnosticUnsupportedTlsRelocation: return "unsupported TLS relocation";
+
+	default:
+		break;
+	}
+
+	return "<unknown>";
+}
+
 enum
 {
 	configDumpHeader = 1 << 0,
@@ -146,7 +207,7 @@ static int charToConfigKey(char c)
 
 static void usage(const char *program)
 {
-	printf("usage: %s [OPTIONS] <path to elf>\n", program);
+	printf("usage: %s [OPTIONS] <path to elf or fself>\n", program);
 	printf("    OPTIONS:\n");
 	printf("        -a - Dump all (default)\n");
 	printf("        -H - Dump header\n");
@@ -160,6 +221,15 @@ static void usage(const char *program)
 	printf("        -t - Dump TLS info\n");
 	printf("        -l - Dump import libraries\n");
 	printf("        -m - Dump import modules\n");
+	printf("\n");
+	printf("       %s symdb create <path to database> <path to elf>...\n", program);
+	printf("       %s symdb find <path to database> <nid>...\n", program);
+	printf("       %s nid compute <name>...\n", program);
+	printf("       %s nid map <path to names list> <path to elf>\n", program);
+	printf("       %s trace <path to trace json> <path to elf>...\n", program);
+	printf("       %s load [-j <threads>] <modules directory> <path to elf>\n", program);
+	printf("       %s perfmap <pid> <path to elf>@<virtual base address>...\n", program);
+	printf("       %s prelink <preferred virtual base address> <path to output> <path to elf>\n", program);
 }
 
 static size_t imageRead(uint64_t offset, void *destination, uint64_t size, FILE *file)
@@ -168,82 +238,1137 @@ static size_t imageRead(uint64_t offset, void *destination, uint64_t size, FILE
 	return fread(destination, 1, size, file);
 }
 
-int main(int argc, const char *argv[])
+static size_t imageWrite(uint64_t offset, const void *source, uint64_t size, FILE *file)
 {
-	if (argc < 2)
+	fseek(file, offset, SEEK_SET);
+	return fwrite(source, 1, size, file);
+}
+
+static void printDiagnostic(OrbisElfHandle_t elf, const OrbisElfDiagnosticInfo_t *info, const char *path)
+{
+	(void)elf;
+	fprintf(stderr, "%s: %s 0x%" PRIx64 " at 0x%" PRIx64 "\n", path, orbisElfDiagnosticToString(info->diagnostic), info->value, info->offset);
+}
+
+static void destroySelf(OrbisElfHandle_t elf, OrbisElfSelfHandle_t self)
+{
+	(void)elf;
+	orbisElfSelfDestroy(self);
+}
+
+/* fake signed SELF files are read in place, the reader goes with the handle */
+static OrbisElfErrorCode_t parseFile(OrbisElfHandle_t *elf, FILE *file, uint64_t fileSize, const OrbisElfParseOptions_t *options)
+{
+	OrbisElfSelfHandle_t self;
+	OrbisElfErrorCode_t errorCode = orbisElfSelfOpen(&self, (OrbisElfReadCallback_t)imageRead, fileSize, file);
+
+	if (errorCode == orbisElfErrorCodeInvalidImageFormat)
 	{
-		usage(argv[0]);
-		return 1;
+		return orbisElfParseWithOptions(elf, (OrbisElfReadCallback_t)imageRead, fileSize, file, options);
 	}
 
-	const char *pathToElf = NULL;
-	int config = 0;
+	if (errorCode != orbisElfErrorCodeOk)
+	{
+		return errorCode;
+	}
+
+	*elf = NULL;
+	errorCode = orbisElfParseWithOptions(elf, orbisElfSelfRead, orbisElfSelfGetImageSize(self), self, options);
+
+	if (*elf)
+	{
+		orbisElfSetUnloadCallback(*elf, (OrbisElfUnloadCallback_t)destroySelf, self);
+	}
+	else
+	{
+		orbisElfSelfDestroy(self);
+	}
+
+	return errorCode;
+}
+
+static int openElf(const char *pathToElf, FILE **file, OrbisElfHandle_t *elf)
+{
+	struct stat fileStat;
+	if (stat(pathToElf, &fileStat) != 0)
+	{
+		fprintf(stderr, "File '%s' not found\n", pathToElf);
+		return 0;
+	}
+
+	*file = fopen(pathToElf, "rb");
+
+	if (!*file)
+	{
+		fprintf(stderr, "File '%s' opening error\n", pathToElf);
+		return 0;
+	}
+
+	OrbisElfParseOptions_t options;
+	memset(&options, 0, sizeof(options));
+	options.diagnosticCallback = (OrbisElfDiagnosticCallback_t)printDiagnostic;
+	options.diagnosticUserData = (void *)pathToElf;
+
+	OrbisElfErrorCode_t errorCode = parseFile(elf, *file, fileStat.st_size, &options);
+
+	if (errorCode != orbisElfErrorCodeOk)
+	{
+		fprintf(stderr, "File '%s' parsing error: %s\n", pathToElf, orbisElfErrorCodeToString(errorCode));
+		fclose(*file);
+		return 0;
+	}
+
+	return 1;
+}
+
+static void *mapFile(const char *path, size_t *size)
+{
+	struct stat fileStat;
+	if (stat(path, &fileStat) != 0)
+	{
+		fprintf(stderr, "File '%s' not found\n", path);
+		return NULL;
+	}
+
+	FILE *file = fopen(path, "rb");
+
+	if (!file)
+	{
+		fprintf(stderr, "File '%s' opening error\n", path);
+		return NULL;
+	}
+
+	*size = fileStat.st_size;
+
+#ifdef _WIN32
+	void *data = malloc(*size);
+
+	if (data && fread(data, 1, *size, file) != *size)
+	{
+		free(data);
+		data = NULL;
+	}
+#else
+	void *data = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+
+	if (data == MAP_FAILED)
+	{
+		data = NULL;
+	}
+#endif
+
+	fclose(file);
+
+	if (!data)
+	{
+		fprintf(stderr, "File '%s' mapping error\n", path);
+	}
+
+	return data;
+}
+
+static void unmapFile(void *data, size_t size)
+{
+#ifdef _WIN32
+	free(data);
+#else
+	munmap(data, size);
+#endif
+}
+
+static int symbolDbCreate(int argc, const char *argv[])
+{
+	OrbisElfSymbolDbBuilderHandle_t builder;
+	OrbisElfErrorCode_t errorCode = orbisElfSymbolDbBuilderCreate(&builder);
+
+	if (errorCode != orbisElfErrorCodeOk)
+	{
+		fprintf(stderr, "Symbol database creation error: %s\n", orbisElfErrorCodeToString(errorCode));
+		return 1;
+	}
 
 	for (int i = 1; i < argc; ++i)
 	{
-		if (argv[i][0] == '-')
+		FILE *file;
+		OrbisElfHandle_t elf;
+
+		if (!openElf(argv[i], &file, &elf))
 		{
-			for (int j = 1; argv[i][j] != '\0'; ++j)
-			{
-				if (argv[i][j] == 'h')
-				{
-					usage(argv[0]);
-					return 0;
-				}
-				int key = charToConfigKey(argv[i][j]);
+			continue;
+		}
 
-				if (key == 0)
-				{
-					usage(argv[0]);
-					return 1;
-				}
+		errorCode = orbisElfSymbolDbBuilderAddModule(builder, elf);
+		orbisElfDestroy(elf);
+		fclose(file);
 
-				config |= key;
-			}
+		if (errorCode != orbisElfErrorCodeOk)
+		{
+			fprintf(stderr, "File '%s' indexing error: %s\n", argv[i], orbisElfErrorCodeToString(errorCode));
+			orbisElfSymbolDbBuilderDestroy(builder);
+			return 1;
 		}
-		else if (pathToElf == NULL)
+	}
+
+	FILE *output = fopen(argv[0], "wb");
+
+	if (!output)
+	{
+		fprintf(stderr, "File '%s' opening error\n", argv[0]);
+		orbisElfSymbolDbBuilderDestroy(builder);
+		return 1;
+	}
+
+	errorCode = orbisElfSymbolDbBuilderWrite(builder, (OrbisElfWriteCallback_t)imageWrite, output);
+	orbisElfSymbolDbBuilderDestroy(builder);
+
+	if (fclose(output) != 0 && errorCode == orbisElfErrorCodeOk)
+	{
+		errorCode = orbisElfErrorCodeIoError;
+	}
+
+	if (errorCode != orbisElfErrorCodeOk)
+	{
+		fprintf(stderr, "File '%s' writing error: %s\n", argv[0], orbisElfErrorCodeToString(errorCode));
+		return 1;
+	}
+
+	return 0;
+}
+
+static int symbolDbFind(int argc, const char *argv[])
+{
+	size_t size;
+	void *data = mapFile(argv[0], &size);
+
+	if (!data)
+	{
+		return 1;
+	}
+
+	OrbisElfSymbolDbHandle_t db;
+	OrbisElfErrorCode_t errorCode = orbisElfSymbolDbOpen(&db, data, size);
+
+	if (errorCode != orbisElfErrorCodeOk)
+	{
+		fprintf(stderr, "File '%s' opening error: %s\n", argv[0], orbisElfErrorCodeToString(errorCode));
+		unmapFile(data, size);
+		return 1;
+	}
+
+	int result = 0;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		uint64_t nid;
+		uint64_t index;
+		uint64_t count;
+
+		if (orbisElfNidFromString(argv[i], &nid) != orbisElfErrorCodeOk)
 		{
-			pathToElf = argv[i];
+			fprintf(stderr, "'%s' is not a valid NID\n", argv[i]);
+			result = 1;
+			continue;
 		}
-		else
+
+		if (orbisElfSymbolDbFind(db, nid, &index, &count) != orbisElfErrorCodeOk)
 		{
-			usage(argv[0]);
-			return 1;
+			printf("%s not found\n", argv[i]);
+			result = 1;
+			continue;
+		}
+
+		for (uint64_t j = index; j < index + count; ++j)
+		{
+			OrbisElfSymbolDbEntry_t entry;
+			orbisElfSymbolDbGetEntry(db, j, &entry);
+
+			printf("%s %s %" PRIu16 ".%" PRIu16 " %s %" PRIu16 ".%" PRIu16 " %s %s at 0x%" PRIx64 " size 0x%" PRIx64 "\n",
+				argv[i],
+				entry.moduleName, entry.moduleVersion >> 8, entry.moduleVersion & 0xff,
+				entry.libraryName, entry.libraryVersion >> 8, entry.libraryVersion & 0xff,
+				orbisElfSymbolBindToString(entry.bind),
+				orbisElfSymbolTypeToString(entry.type),
+				entry.value, entry.size);
 		}
 	}
 
-	if (!config)
+	orbisElfSymbolDbClose(db);
+	unmapFile(data, size);
+	return result;
+}
+
+static int symbolDbMain(const char *program, int argc, const char *argv[])
+{
+	if (argc >= 3 && strcmp(argv[0], "create") == 0)
 	{
-		config = ~0;
+		return symbolDbCreate(argc - 1, argv + 1);
 	}
 
-	if (!pathToElf)
+	if (argc >= 3 && strcmp(argv[0], "find") == 0)
 	{
-		usage(argv[0]);
-		return 1;
+		return symbolDbFind(argc - 1, argv + 1);
 	}
 
-	struct stat fileStat;
-	if (stat(pathToElf, &fileStat) != 0)
+	usage(program);
+	return 1;
+}
+
+static int nidCompute(int argc, const char *argv[])
+{
+	uint64_t *nids = malloc(sizeof(uint64_t) * argc);
+
+	if (!nids)
 	{
-		fprintf(stderr, "File '%s' not found\n", pathToElf);
+		fprintf(stderr, "Out of memory\n");
 		return 1;
 	}
 
-	FILE *file = fopen(pathToElf, "rb");
+	orbisElfComputeNids(argv, argc, nids);
 
-	if (!file)
+	for (int i = 0; i < argc; ++i)
+	{
+		char nid[12];
+		orbisElfNidToString(nids[i], nid);
+		printf("%s %s\n", nid, argv[i]);
+	}
+
+	free(nids);
+	return 0;
+}
+
+typedef struct
+{
+	uint64_t nid;
+	uint64_t symbolIndex;
+} NidSymbol_t;
+
+static int compareNidSymbols(const void *lhs, const void *rhs)
+{
+	const NidSymbol_t *a = lhs;
+	const NidSymbol_t *b = rhs;
+
+	if (a->nid != b->nid)
+	{
+		return a->nid < b->nid ? -1 : 1;
+	}
+
+	return a->symbolIndex < b->symbolIndex ? -1 : a->symbolIndex > b->symbolIndex;
+}
+
+static int nidMap(const char *pathToNames, const char *pathToElf)
+{
+	size_t namesSize;
+	char *namesData = mapFile(pathToNames, &namesSize);
+
+	if (!namesData)
 	{
-		fprintf(stderr, "File '%s' opening error\n", pathToElf);
 		return 1;
 	}
 
+	FILE *file;
 	OrbisElfHandle_t elf;
-	OrbisElfErrorCode_t errorCode = orbisElfParse(&elf, (OrbisElfReadCallback_t)imageRead, fileStat.st_size, file);
 
-	if (errorCode != orbisElfErrorCodeOk)
+	if (!openElf(pathToElf, &file, &elf))
+	{
+		unmapFile(namesData, namesSize);
+		return 1;
+	}
+
+	uint64_t namesCount = 0;
+
+	for (size_t i = 0; i < namesSize; ++i)
+	{
+		namesCount += namesData[i] == '\n';
+	}
+
+	namesCount++;
+
+	uint64_t symbolsCount = orbisElfGetSymbolsCount(elf);
+	char *namesText = malloc(namesSize + 1);
+	const char **names = malloc(sizeof(char *) * namesCount);
+	uint64_t *nids = malloc(sizeof(uint64_t) * namesCount);
+	NidSymbol_t *symbols = malloc(sizeof(NidSymbol_t) * (symbolsCount + 1));
+
+	if (!namesText || !names || !nids || !symbols)
+	{
+		fprintf(stderr, "Out of memory\n");
+		free(namesText);
+		free((void *)names);
+		free(nids);
+		free(symbols);
+		orbisElfDestroy(elf);
+		fclose(file);
+		unmapFile(namesData, namesSize);
+		return 1;
+	}
+
+	memcpy(namesText, namesData, namesSize);
+	namesText[namesSize] = '\0';
+	unmapFile(namesData, namesSize);
+	namesCount = 0;
+
+	for (char *line = namesText; line; )
+	{
+		char *end = strchr(line, '\n');
+
+		if (end)
+		{
+			*end = '\0';
+
+			if (end > line && end[-1] == '\r')
+			{
+				end[-1] = '\0';
+			}
+		}
+
+		if (*line)
+		{
+			names[namesCount++] = line;
+		}
+
+		line = end ? end + 1 : NULL;
+	}
+
+	orbisElfComputeNids(names, namesCount, nids);
+
+	uint64_t nidSymbolsCount = 0;
+
+	for (uint64_t i = 0; i < symbolsCount; ++i)
+	{
+		const OrbisElfSymbol_t *symbol = orbisElfGetSymbol(elf, i);
+
+		if (symbol->module && symbol->library && orbisElfNidFromString(symbol->name, &symbols[nidSymbolsCount].nid) == orbisElfErrorCodeOk)
+		{
+			symbols[nidSymbolsCount++].symbolIndex = i;
+		}
+	}
+
+	qsort(symbols, nidSymbolsCount, sizeof(NidSymbol_t), compareNidSymbols);
+
+	for (uint64_t i = 0; i < namesCount; ++i)
+	{
+		uint64_t low = 0;
+		uint64_t high = nidSymbolsCount;
+
+		while (low < high)
+		{
+			uint64_t middle = low + (high - low) / 2;
+
+			if (symbols[middle].nid < nids[i])
+			{
+				low = middle + 1;
+			}
+			else
+			{
+				high = middle;
+			}
+		}
+
+		for (; low < nidSymbolsCount && symbols[low].nid == nids[i]; ++low)
+		{
+			const OrbisElfSymbol_t *symbol = orbisElfGetSymbol(elf, symbols[low].symbolIndex);
+
+			printf("%s %s::%s::%s\n", symbol->name, symbol->module->name, symbol->library->name, names[i]);
+		}
+	}
+
+	free(namesText);
+	free((void *)names);
+	free(nids);
+	free(symbols);
+	orbisElfDestroy(elf);
+	fclose(file);
+	return 0;
+}
+
+static int nidMain(const char *program, int argc, const char *argv[])
+{
+	if (argc >= 2 && strcmp(argv[0], "compute") == 0)
+	{
+		return nidCompute(argc - 1, argv + 1);
+	}
+
+	if (argc == 3 && strcmp(argv[0], "map") == 0)
+	{
+		return nidMap(argv[1], argv[2]);
+	}
+
+	usage(program);
+	return 1;
+}
+
+typedef struct
+{
+	FILE *output;
+	const char *path;
+	uint64_t originNs;
+	int eventsCount;
+} TraceContext_t;
+
+static void writeJsonString(FILE *output, const char *string)
+{
+	fputc('"', output);
+
+	for (; *string; ++string)
+	{
+		if (*string == '"' || *string == '\\')
+		{
+			fputc('\\', output);
+		}
+
+		fputc(*string, output);
+	}
+
+	fputc('"', output);
+}
+
+static void traceEvent(OrbisElfHandle_t elf, OrbisElfPhase_t phase, uint64_t beginNs, uint64_t endNs, TraceContext_t *context)
+{
+	(void)elf;
+
+	/* chrome://tracing complete event, timestamps are in microseconds */
+	fprintf(context->output, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"module\":",
+		context->eventsCount ? "," : "", orbisElfPhaseToString(phase),
+		(beginNs - context->originNs) / 1000.0, (endNs - beginNs) / 1000.0);
+	writeJsonString(context->output, context->path);
+	fprintf(context->output, "}}");
+	context->eventsCount++;
+}
+
+static void printStats(const char *path, OrbisElfHandle_t elf)
+{
+	OrbisElfStats_t stats;
+
+	if (orbisElfGetStats(elf, &stats) != orbisElfErrorCodeOk)
+	{
+		return;
+	}
+
+	printf("%s\n", path);
+
+	for (int phase = 0; phase < orbisElfPhaseCount; ++phase)
+	{
+		if (stats.phaseCalls[phase])
+		{
+			printf("    %-20s %10.3f ms (%" PRIu64 " calls)\n", orbisElfPhaseToString(phase), stats.phaseNs[phase] / 1000000.0, stats.phaseCalls[phase]);
+		}
+	}
+
+	printf("    reads: %" PRIu64 " calls, %" PRIu64 " bytes\n", stats.readCalls, stats.bytesRead);
+	printf("    allocations: %" PRIu64 " calls, %" PRIu64 " bytes\n", stats.allocations, stats.allocatedBytes);
+
+	for (int type = 0; type < ORBIS_ELF_RELOCATION_TYPES_COUNT; ++type)
+	{
+		if (stats.relocations[type])
+		{
+			printf("    relocations of type %d: %" PRIu64 "\n", type, stats.relocations[type]);
+		}
+	}
+
+	for (int diagnostic = 0; diagnostic < orbisElfDiagnosticCount; ++diagnostic)
+	{
+		if (orbisElfGetDiagnosticsCount(elf, diagnostic))
+		{
+			printf("    %s: %" PRIu64 "\n", orbisElfDiagnosticToString(diagnostic), orbisElfGetDiagnosticsCount(elf, diagnostic));
+		}
+	}
+}
+
+static int traceMain(const char *program, int argc, const char *argv[])
+{
+	if (argc < 2)
+	{
+		usage(program);
+		return 1;
+	}
+
+	FILE *output = fopen(argv[0], "w");
+
+	if (!output)
+	{
+		fprintf(stderr, "File '%s' opening error\n", argv[0]);
+		return 1;
+	}
+
+	int modulesCount = argc - 1;
+	FILE **files = calloc(modulesCount, sizeof(FILE *));
+	OrbisElfHandle_t *elfs = calloc(modulesCount, sizeof(OrbisElfHandle_t));
+	void **images = calloc(modulesCount, sizeof(void *));
+	TraceContext_t *contexts = calloc(modulesCount, sizeof(TraceContext_t));
+	int result = 0;
+
+	if (!files || !elfs || !images || !contexts)
+	{
+		fprintf(stderr, "Out of memory\n");
+		fclose(output);
+		free(files);
+		free(elfs);
+		free(images);
+		free(contexts);
+		return 1;
+	}
+
+	uint64_t originNs = orbisElfGetTimestampNs();
+	int eventsCount = 0;
+	uint64_t virtualBaseAddress = 0x800000000ull;
+
+	fprintf(output, "[");
+
+	for (int i = 0; i < modulesCount; ++i)
+	{
+		const char *path = argv[i + 1];
+		struct stat fileStat;
+
+		contexts[i].output = output;
+		contexts[i].path = path;
+		contexts[i].originNs = originNs;
+		contexts[i].eventsCount = eventsCount;
+
+		if (stat(path, &fileStat) != 0 || !(files[i] = fopen(path, "rb")))
+		{
+			fprintf(stderr, "File '%s' opening error\n", path);
+			result = 1;
+			break;
+		}
+
+		OrbisElfParseOptions_t options;
+		memset(&options, 0, sizeof(options));
+		options.flags = orbisElfParseFlagCollectStats | orbisElfParseFlagValidate | orbisElfParseFlagEagerIndexes;
+		options.traceCallback = (OrbisElfTraceCallback_t)traceEvent;
+		options.traceUserData = contexts + i;
+
+		OrbisElfErrorCode_t errorCode = parseFile(elfs + i, files[i], fileStat.st_size, &options);
+
+		if (errorCode != orbisElfErrorCodeOk)
+		{
+			fprintf(stderr, "File '%s' parsing error: %s\n", path, orbisElfErrorCodeToString(errorCode));
+			result = 1;
+			break;
+		}
+
+		uint64_t loadSize = orbisElfGetLoadSize(elfs[i]);
+		images[i] = calloc(1, loadSize ? loadSize : 1);
+
+		if (!images[i] || (errorCode = orbisElfLoad(elfs[i], images[i], virtualBaseAddress)) != orbisElfErrorCodeOk)
+		{
+			fprintf(stderr, "File '%s' loading error: %s\n", path, orbisElfErrorCodeToString(images[i] ? errorCode : orbisElfErrorCodeNoMemory));
+			result = 1;
+			break;
+		}
+
+		virtualBaseAddress += (loadSize + 0xffffff) & ~0xffffffull;
+		eventsCount = contexts[i].eventsCount;
+	}
+
+	for (int i = 0; result == 0 && i < modulesCount; ++i)
+	{
+		contexts[i].eventsCount = eventsCount;
+
+		for (int j = 0; j < modulesCount; ++j)
+		{
+			if (i != j)
+			{
+				orbisElfImportModule(elfs[i], elfs[j]);
+			}
+		}
+
+		eventsCount = contexts[i].eventsCount;
+	}
+
+	fprintf(output, "\n]\n");
+
+	if (fclose(output) != 0)
+	{
+		fprintf(stderr, "File '%s' writing error\n", argv[0]);
+		result = 1;
+	}
+
+	for (int i = 0; result == 0 && i < modulesCount; ++i)
+	{
+		printStats(argv[i + 1], elfs[i]);
+	}
+
+	for (int i = 0; i < modulesCount; ++i)
+	{
+		if (elfs[i])
+		{
+			orbisElfDestroy(elfs[i]);
+		}
+
+		if (files[i])
+		{
+			fclose(files[i]);
+		}
+
+		free(images[i]);
+	}
+
+	free(files);
+	free(elfs);
+	free(images);
+	free(contexts);
+	return result;
+}
+
+typedef struct
+{
+	const char *directory;
+	mtx_t mutex;
+	FILE **files;
+	OrbisElfHandle_t *elfs;
+	uint64_t count;
+	uint64_t capacity;
+} LoadContext_t;
+
+static OrbisElfErrorCode_t locateModule(const char *moduleName, OrbisElfHandle_t *elf, LoadContext_t *context)
+{
+	static const char *const extensions[] = { ".prx", ".sprx", "" };
+	char path[4096];
+	struct stat fileStat;
+
+	for (int i = 0; i < (int)(sizeof(extensions) / sizeof(extensions[0])); ++i)
+	{
+		snprintf(path, sizeof(path), "%s/%s%s", context->directory, moduleName, extensions[i]);
+
+		if (stat(path, &fileStat) == 0)
+		{
+			break;
+		}
+
+		path[0] = '\0';
+	}
+
+	if (!path[0])
+	{
+		return orbisElfErrorCodeNotFound;
+	}
+
+	FILE *file = fopen(path, "rb");
+
+	if (!file)
+	{
+		return orbisElfErrorCodeIoError;
+	}
+
+	OrbisElfErrorCode_t errorCode = parseFile(elf, file, fileStat.st_size, NULL);
+
+	if (errorCode != orbisElfErrorCodeOk)
+	{
+		fprintf(stderr, "File '%s' parsing error: %s\n", path, orbisElfErrorCodeToString(errorCode));
+		fclose(file);
+		return errorCode;
+	}
+
+	mtx_lock(&context->mutex);
+
+	if (context->count == context->capacity)
+	{
+		uint64_t capacity = context->capacity ? context->capacity * 2 : 16;
+		FILE **files = realloc(context->files, capacity * sizeof(FILE *));
+		OrbisElfHandle_t *elfs = files ? realloc(context->elfs, capacity * sizeof(OrbisElfHandle_t)) : NULL;
+
+		if (files)
+		{
+			context->files = files;
+		}
+
+		if (!elfs)
+		{
+			mtx_unlock(&context->mutex);
+			orbisElfDestroy(*elf);
+			fclose(file);
+			return orbisElfErrorCodeNoMemory;
+		}
+
+		context->elfs = elfs;
+		context->capacity = capacity;
+	}
+
+	context->files[context->count] = file;
+	context->elfs[context->count] = *elf;
+	context->count++;
+	mtx_unlock(&context->mutex);
+	return orbisElfErrorCodeOk;
+}
+
+static OrbisElfErrorCode_t mapModule(OrbisElfHandle_t elf, void **baseAddress, uint64_t *virtualBaseAddress, LoadContext_t *context)
+{
+	(void)context;
+	uint64_t loadSize = orbisElfGetLoadSize(elf);
+
+	*baseAddress = calloc(1, loadSize ? loadSize : 1);
+	*virtualBaseAddress = 0;
+	return *baseAddress ? orbisElfErrorCodeOk : orbisElfErrorCodeNoMemory;
+}
+
+static void releaseModule(OrbisElfHandle_t elf, LoadContext_t *context)
+{
+	free(orbisElfGetBaseAddress(elf));
+
+	for (uint64_t i = 0; i < context->count; ++i)
+	{
+		if (context->elfs[i] == elf)
+		{
+			fclose(context->files[i]);
+			break;
+		}
+	}
+
+	orbisElfDestroy(elf);
+}
+
+static int loadMain(const char *program, int argc, const char *argv[])
+{
+	uint32_t threadsCount = 4;
+
+	if (argc >= 2 && strcmp(argv[0], "-j") == 0)
+	{
+		threadsCount = (uint32_t)strtoul(argv[1], NULL, 0);
+		argc -= 2;
+		argv += 2;
+	}
+
+	if (argc != 2)
+	{
+		usage(program);
+		return 1;
+	}
+
+	FILE *file;
+	OrbisElfHandle_t root;
+
+	if (!openElf(argv[1], &file, &root))
+	{
+		return 1;
+	}
+
+	LoadContext_t context;
+	memset(&context, 0, sizeof(context));
+	context.directory = argv[0];
+	mtx_init(&context.mutex, mtx_plain);
+
+	OrbisElfModuleLocator_t locator;
+	locator.locate = (OrbisElfLocateModuleCallback_t)locateModule;
+	locator.map = (OrbisElfMapModuleCallback_t)mapModule;
+	locator.release = (OrbisElfReleaseModuleCallback_t)releaseModule;
+	locator.userData = &context;
+
+	OrbisElfLoaderHandle_t loader;
+	OrbisElfErrorCode_t errorCode = orbisElfLoaderCreate(&loader, &locator, threadsCount);
+
+	if (errorCode == orbisElfErrorCodeOk)
+	{
+		errorCode = orbisElfLoaderLoad(loader, root);
+
+		if (errorCode != orbisElfErrorCodeOk)
+		{
+			fprintf(stderr, "Loading error: %s\n", orbisElfErrorCodeToString(errorCode));
+		}
+		else
+		{
+			printf("Modules:\n");
+
+			for (uint64_t i = 0, count = orbisElfLoaderGetModulesCount(loader); i < count; ++i)
+			{
+				OrbisElfHandle_t elf = orbisElfLoaderGetModule(loader, i);
+				printf("    %-32s 0x%016" PRIx64 "\n", orbisElfGetModuleInfo(elf)->name, orbisElfGetVirtualBaseAddress(elf));
+			}
+
+			if (orbisElfLoaderGetMissingModulesCount(loader))
+			{
+				printf("Missing modules:\n");
+
+				for (uint64_t i = 0, count = orbisElfLoaderGetMissingModulesCount(loader); i < count; ++i)
+				{
+					printf("    %s\n", orbisElfLoaderGetMissingModule(loader, i));
+				}
+			}
+
+			printf("Initializers:\n");
+
+			for (uint64_t i = 0, count = orbisElfLoaderGetInitializersCount(loader); i < count; ++i)
+			{
+				const OrbisElfInitializer_t *initializer = orbisElfLoaderGetInitializer(loader, i);
+				printf("    %-32s %-14s 0x%016" PRIx64 " x %" PRIu64 "\n", orbisElfGetModuleInfo(initializer->elf)->name,
+					orbisElfInitializerTypeToString(initializer->type), initializer->address, initializer->count);
+			}
+		}
+
+		orbisElfLoaderDestroy(loader);
+	}
+	else
+	{
+		fprintf(stderr, "Loader creation error: %s\n", orbisElfErrorCodeToString(errorCode));
+	}
+
+	free(orbisElfGetBaseAddress(root));
+	orbisElfDestroy(root);
+	fclose(file);
+	free(context.files);
+	free(context.elfs);
+	mtx_destroy(&context.mutex);
+	return errorCode == orbisElfErrorCodeOk ? 0 : 1;
+}
+
+static int perfMapMain(const char *program, int argc, const char *argv[])
+{
+	char *end = NULL;
+	unsigned long pid = argc >= 2 ? strtoul(argv[0], &end, 10) : 0;
+
+	if (!pid || *end)
+	{
+		usage(program);
+		return 1;
+	}
+
+	char perfMapPath[64];
+	snprintf(perfMapPath, sizeof(perfMapPath), "/tmp/perf-%lu.map", pid);
+
+	int modulesCount = argc - 1;
+	FILE **files = calloc(modulesCount, sizeof(FILE *));
+	OrbisElfHandle_t *elfs = calloc(modulesCount, sizeof(OrbisElfHandle_t));
+	void **images = calloc(modulesCount, sizeof(void *));
+	FILE *output = NULL;
+	int result = 0;
+
+	if (!files || !elfs || !images)
+	{
+		fprintf(stderr, "Out of memory\n");
+		result = 1;
+	}
+
+	/* modules are loaded where the process mapped them and linked to each other, so calls between them aren't written as stubs */
+	for (int i = 0; result == 0 && i < modulesCount; ++i)
+	{
+		const char *separator = strrchr(argv[i + 1], '@');
+		uint64_t virtualBaseAddress = separator ? strtoull(separator + 1, &end, 0) : 0;
+		char path[4096];
+
+		if (!separator || separator == argv[i + 1] || end == separator + 1 || *end)
+		{
+			fprintf(stderr, "Module '%s' has no @<virtual base address>\n", argv[i + 1]);
+			result = 1;
+			break;
+		}
+
+		snprintf(path, sizeof(path), "%.*s", (int)(separator - argv[i + 1]), argv[i + 1]);
+
+		if (!openElf(path, files + i, elfs + i))
+		{
+			elfs[i] = NULL;
+			files[i] = NULL;
+			result = 1;
+			break;
+		}
+
+		uint64_t loadSize = orbisElfGetLoadSize(elfs[i]);
+		images[i] = calloc(1, loadSize ? loadSize : 1);
+		OrbisElfErrorCode_t errorCode = images[i] ? orbisElfLoad(elfs[i], images[i], virtualBaseAddress) : orbisElfErrorCodeNoMemory;
+
+		if (errorCode != orbisElfErrorCodeOk)
+		{
+			fprintf(stderr, "File '%s' loading error: %s\n", path, orbisElfErrorCodeToString(errorCode));
+			result = 1;
+			break;
+		}
+	}
+
+	for (int i = 0; result == 0 && i < modulesCount; ++i)
+	{
+		for (int j = 0; j < modulesCount; ++j)
+		{
+			if (i != j)
+			{
+				orbisElfImportModule(elfs[i], elfs[j]);
+			}
+		}
+	}
+
+	if (result == 0 && !(output = fopen(perfMapPath, "ab")))
+	{
+		fprintf(stderr, "File '%s' opening error\n", perfMapPath);
+		result = 1;
+	}
+
+	/* lines go after what the process or earlier runs already wrote */
+	uint64_t offset = 0;
+
+	if (output && fseek(output, 0, SEEK_END) == 0)
+	{
+		offset = ftell(output);
+	}
+
+	for (int i = 0; result == 0 && i < modulesCount; ++i)
+	{
+		OrbisElfErrorCode_t errorCode = orbisElfWritePerfMap(elfs[i], (OrbisElfWriteCallback_t)imageWrite, output, &offset);
+
+		if (errorCode != orbisElfErrorCodeOk)
+		{
+			fprintf(stderr, "File '%s' perf map error: %s\n", argv[i + 1], orbisElfErrorCodeToString(errorCode));
+			result = 1;
+		}
+	}
+
+	if (output && fclose(output) != 0 && result == 0)
+	{
+		fprintf(stderr, "File '%s' writing error\n", perfMapPath);
+		result = 1;
+	}
+
+	for (int i = 0; i < modulesCount && elfs; ++i)
+	{
+		if (elfs[i])
+		{
+			orbisElfDestroy(elfs[i]);
+			fclose(files[i]);
+		}
+
+		free(images ? images[i] : NULL);
+	}
+
+	free(files);
+	free(elfs);
+	free(images);
+	return result;
+}
+
+static int prelinkMain(const char *program, int argc, const char *argv[])
+{
+	if (argc != 3)
+	{
+		usage(program);
+		return 1;
+	}
+
+	uint64_t preferredBase = strtoull(argv[0], NULL, 0);
+	FILE *file;
+	OrbisElfHandle_t elf;
+
+	if (!openElf(argv[2], &file, &elf))
+	{
+		return 1;
+	}
+
+	FILE *output = fopen(argv[1], "wb");
+	int result = 0;
+
+	if (!output)
+	{
+		fprintf(stderr, "File '%s' opening error\n", argv[1]);
+		result = 1;
+	}
+	else
+	{
+		OrbisElfErrorCode_t errorCode = orbisElfPrelink(elf, preferredBase, (OrbisElfWriteCallback_t)imageWrite, output);
+
+		if (errorCode != orbisElfErrorCodeOk)
+		{
+			fprintf(stderr, "File '%s' prelink error: %s\n", argv[2], orbisElfErrorCodeToString(errorCode));
+			result = 1;
+		}
+
+		if (fclose(output) != 0 && result == 0)
+		{
+			fprintf(stderr, "File '%s' writing error\n", argv[1]);
+			result = 1;
+		}
+	}
+
+	orbisElfDestroy(elf);
+	fclose(file);
+	return result;
+}
+
+int main(int argc, const char *argv[])
+{
+	if (argc < 2)
+	{
+		usage(argv[0]);
+		return 1;
+	}
+
+	if (strcmp(argv[1], "symdb") == 0)
+	{
+		return symbolDbMain(argv[0], argc - 2, argv + 2);
+	}
+
+	if (strcmp(argv[1], "nid") == 0)
+	{
+		return nidMain(argv[0], argc - 2, argv + 2);
+	}
+
+	if (strcmp(argv[1], "trace") == 0)
+	{
+		return traceMain(argv[0], argc - 2, argv + 2);
+	}
+
+	if (strcmp(argv[1], "load") == 0)
+	{
+		return loadMain(argv[0], argc - 2, argv + 2);
+	}
+
+	if (strcmp(argv[1], "perfmap") == 0)
+	{
+		return perfMapMain(argv[0], argc - 2, argv + 2);
+	}
+
+	if (strcmp(argv[1], "prelink") == 0)
+	{
+		return prelinkMain(argv[0], argc - 2, argv + 2);
+	}
+
+	const char *pathToElf = NULL;
+	int config = 0;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (argv[i][0] == '-')
+		{
+			for (int j = 1; argv[i][j] != '\0'; ++j)
+			{
+				if (argv[i][j] == 'h')
+				{
+					usage(argv[0]);
+					return 0;
+				}
+				int key = charToConfigKey(argv[i][j]);
+
+				if (key == 0)
+				{
+					usage(argv[0]);
+					return 1;
+				}
+
+				config |= key;
+			}
+		}
+		else if (pathToElf == NULL)
+		{
+			pathToElf = argv[i];
+		}
+		else
+		{
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (!config)
+	{
+		config = ~0;
+	}
+
+	if (!pathToElf)
+	{
+		usage(argv[0]);
+		return 1;
+	}
+
+	FILE *file;
+	OrbisElfHandle_t elf;
+
+	if (!openElf(pathToElf, &file, &elf))
 	{
-		fprintf(stderr, "File '%s' parsing error: %s\n", pathToElf, orbisElfErrorCodeToString(errorCode));
 		return 0;
 	}
 
@@ -433,5 +1558,6 @@ int main(int argc, const char *argv[])
 	}
 
 	orbisElfDestroy(elf);
+	fclose(file);
 	return 0;
 }